@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "decodebenchmark.h"
+
+#include <QtCore/QElapsedTimer>
+
+DecodeBenchmark::DecodeBenchmark(QObject *parent) :
+    GenericVideoReader(parent)
+{
+    // empty
+}
+
+qreal DecodeBenchmark::decodeFramesPerSecond(const QString &videoFilename, int numberOfFrames, int skipFrames,
+                                             bool partialDecoding)
+{
+    openVideoFileInternal(videoFilename);
+
+    QElapsedTimer timer;
+    timer.start();
+    int framesDecoded = 0;
+    qint64 frameNumber = loadNextFrame();
+    while (framesDecoded < numberOfFrames && frameNumber >= 0) {
+        ++framesDecoded;
+        if (partialDecoding) {
+            frameNumber = skipToFrame(frameNumber + skipFrames + 1);
+        } else {
+            for (int i = 0; i <= skipFrames && frameNumber >= 0; ++i) {
+                frameNumber = loadNextFrame();
+            }
+        }
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    if (elapsed == 0) {
+        return 0;
+    }
+    return framesDecoded * 1e9 / elapsed;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef DECODEBENCHMARK_H
+#define DECODEBENCHMARK_H
+
+#include "video/genericvideoreader.h"
+
+/**
+ * Measures how fast frames from a video file can be decoded, without copying or showing them.
+ */
+class DecodeBenchmark : public GenericVideoReader
+{
+    Q_OBJECT
+public:
+    explicit DecodeBenchmark(QObject *parent = 0);
+
+    /**
+     * Decode \param numberOfFrames frames from the start of \param videoFilename. After every frame,
+     * \param skipFrames frames are skipped, like the video player does at high speeds. If
+     * \param partialDecoding is true, skipped frames are only decoded as far as needed.
+     * @return the number of frames decoded per second, not counting the skipped frames.
+     */
+    qreal decodeFramesPerSecond(const QString &videoFilename, int numberOfFrames, int skipFrames = 0,
+                                bool partialDecoding = false);
+};
+
+#endif // DECODEBENCHMARK_H
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QPair>
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include "config/bigringsettings.h"
+#include "decodebenchmark.h"
+#include "pipelinebenchmark.h"
+#include "video/frameblender.h"
+#include "video/yuvtorgbconverter.h"
+
+namespace
+{
+const int DEFAULT_NUMBER_OF_FRAMES = 500;
+const int DEFAULT_PIPELINE_DURATION_SECONDS = 30;
+/** distance per frame of a video recorded at 30 frames per second while riding 30 km/h */
+const qreal DEFAULT_METERS_PER_FRAME = 30 / 3.6 / 30;
+const int FULL_HD_WIDTH = 1920;
+const int FULL_HD_HEIGHT = 1080;
+/** size of a 1080p YUV420P frame */
+const std::size_t FULL_HD_FRAME_SIZE = FULL_HD_WIDTH * FULL_HD_HEIGHT * 3 / 2;
+
+/**
+ * Default thread counts to measure: 1, 2, 4, ... up to the number of cores.
+ */
+QList<int> defaultThreadCounts()
+{
+    QList<int> threadCounts;
+    const int cores = qMax(1, QThread::idealThreadCount());
+    for (int threadCount = 1; threadCount < cores; threadCount *= 2) {
+        threadCounts << threadCount;
+    }
+    threadCounts << cores;
+    return threadCounts;
+}
+
+VideoDecoderThreadType parseThreadType(const QString &threadType)
+{
+    if (threadType == "frame") {
+        return VideoDecoderThreadType::FRAME;
+    } else if (threadType == "slice") {
+        return VideoDecoderThreadType::SLICE;
+    }
+    return VideoDecoderThreadType::FRAME_AND_SLICE;
+}
+
+VideoFileAccess parseFileAccess(const QString &fileAccess)
+{
+    if (fileAccess == "read-ahead") {
+        return VideoFileAccess::READ_AHEAD;
+    } else if (fileAccess == "mmap") {
+        return VideoFileAccess::MEMORY_MAPPED;
+    }
+    return VideoFileAccess::DIRECT;
+}
+
+/**
+ * Decode the same video files with a different number of decoding threads, and print the number of frames
+ * decoded per second for each number of threads.
+ */
+void runDecodeBenchmark(const QStringList &videoFilenames, const QList<int> &threadCounts,
+                        VideoDecoderThreadType threadType, int numberOfFrames, int skipFrames)
+{
+    printf("%-40s %8s %10s %8s", "video", "threads", "fps", "speedup");
+    if (skipFrames > 0) {
+        printf(" %12s", "partial fps");
+    }
+    printf("\n");
+    for (const QString &videoFilename: videoFilenames) {
+        qreal singleThreadedFramesPerSecond = 0;
+        for (const int threadCount: threadCounts) {
+            DecodeBenchmark benchmark;
+            benchmark.setDecoderThreading(threadCount, threadType);
+            const qreal framesPerSecond = benchmark.decodeFramesPerSecond(videoFilename, numberOfFrames, skipFrames);
+            if (singleThreadedFramesPerSecond == 0) {
+                singleThreadedFramesPerSecond = framesPerSecond;
+            }
+            const qreal speedup = (singleThreadedFramesPerSecond > 0) ? framesPerSecond / singleThreadedFramesPerSecond : 0;
+            printf("%-40s %8d %10.1f %8.2f", qPrintable(QFileInfo(videoFilename).fileName()), threadCount,
+                   framesPerSecond, speedup);
+            if (skipFrames > 0) {
+                DecodeBenchmark partialBenchmark;
+                partialBenchmark.setDecoderThreading(threadCount, threadType);
+                printf(" %12.1f", partialBenchmark.decodeFramesPerSecond(videoFilename, numberOfFrames, skipFrames, true));
+            }
+            printf("\n");
+        }
+    }
+}
+
+/** Measure the time it takes to blend two 1080p frames, for every supported instruction set. */
+void runBlendBenchmark(int numberOfFrames)
+{
+    std::vector<quint8> first(FULL_HD_FRAME_SIZE);
+    std::vector<quint8> second(FULL_HD_FRAME_SIZE);
+    std::vector<quint8> destination(FULL_HD_FRAME_SIZE);
+    for (std::size_t i = 0; i < FULL_HD_FRAME_SIZE; ++i) {
+        first[i] = static_cast<quint8>(i);
+        second[i] = static_cast<quint8>(i * 7);
+    }
+
+    printf("%-12s %14s %10s\n", "blending", "ms per frame", "GB/s");
+    for (const indoorcycling::InstructionSet instructionSet: indoorcycling::allInstructionSets()) {
+        if (!indoorcycling::isSupported(instructionSet)) {
+            continue;
+        }
+        const FrameBlender blender(instructionSet);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < numberOfFrames; ++i) {
+            blender.blend(first.data(), second.data(), destination.data(), FULL_HD_FRAME_SIZE,
+                          i % FrameBlender::MAXIMUM_WEIGHT);
+        }
+        const qreal secondsPerFrame = timer.nsecsElapsed() * 1e-9 / numberOfFrames;
+        // two frames are read and one frame is written.
+        const qreal gigabytesPerSecond = 3 * FULL_HD_FRAME_SIZE / secondsPerFrame * 1e-9;
+        printf("%-12s %14.3f %10.2f\n", qPrintable(indoorcycling::instructionSetName(instructionSet)),
+               secondsPerFrame * 1e3, gigabytesPerSecond);
+    }
+}
+
+void printLatency(const char *name, const LatencyPercentiles &latency)
+{
+    printf("  %-8s latency (ms): p50 %8.2f  p90 %8.2f  p99 %8.2f  max %8.2f\n", name, latency.p50, latency.p90,
+           latency.p99, latency.maximum);
+}
+
+/** Measure the speed of copying memory, as a reference for the copy bandwidth of the pipeline. */
+qreal memcpyBandwidth()
+{
+    const std::size_t size = 64 * 1024 * 1024;
+    const int repeats = 10;
+    std::vector<char> source(size, 1);
+    std::vector<char> destination(size);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < repeats; ++i) {
+        std::memcpy(destination.data(), source.data(), size);
+    }
+    return static_cast<qreal>(size) * repeats / timer.nsecsElapsed();
+}
+
+/**
+ * Ride the video files with a speed profile in real time, using the complete video pipeline, and print the frame
+ * rates and latencies.
+ */
+void runPipelineBenchmark(const QStringList &videoFilenames, const QList<int> &threadCounts,
+                          VideoDecoderThreadType threadType, const QList<qreal> &speeds, int durationSeconds,
+                          qreal metersPerFrame, const QSize &maximumFrameSize, VideoFileAccess fileAccess,
+                          qint64 throttleBytesPerSecond, int throttleLatencyMicroseconds)
+{
+    printf("memcpy bandwidth: %.2f GB/s\n", memcpyBandwidth());
+    for (const QString &videoFilename: videoFilenames) {
+        PipelineBenchmark benchmark;
+        if (!threadCounts.isEmpty()) {
+            benchmark.setDecoderThreading(threadCounts.first(), threadType);
+        }
+        benchmark.setMaximumFrameSize(maximumFrameSize);
+        benchmark.setFileAccess(fileAccess);
+        benchmark.setFileThrottle(throttleBytesPerSecond, throttleLatencyMicroseconds);
+        const PipelineBenchmarkResult result = benchmark.run(videoFilename, speeds, durationSeconds, metersPerFrame);
+        printf("%s\n", qPrintable(QFileInfo(videoFilename).fileName()));
+        printf("  fps: requested %.1f  shown %.1f  copied %.1f  missed updates %.1f%%\n",
+               result.requestedFramesPerSecond, result.shownFramesPerSecond, result.copiedFramesPerSecond,
+               result.missedUpdatesPercentage);
+        printLatency("decode", result.decodeLatency);
+        printLatency("copy", result.copyLatency);
+        printLatency("seek", result.seekLatency);
+        printf("  copy bandwidth: %.2f GB/s\n", result.copyBandwidth);
+        printf("  frame ring: %d buffers  filled average %.1f  minimum %d  underruns %d\n", result.frameRing.size,
+               result.frameRing.averageFilled, result.frameRing.minimumFilled, result.frameRing.underruns);
+        printf("  stages:\n%s", qPrintable(result.stageTimings));
+    }
+}
+
+void printConversionResult(const QString &name, const QElapsedTimer &timer, int numberOfFrames)
+{
+    const qreal secondsPerFrame = timer.nsecsElapsed() * 1e-9 / numberOfFrames;
+    printf("%-24s %14.3f %10.1f\n", qPrintable(name), secondsPerFrame * 1e3, 1 / secondsPerFrame);
+}
+
+/**
+ * Measure the time it takes to convert a 1080p frame from YUV420P to RGB, with sws_scale as used for the thumbnails,
+ * and with the YuvToRgbConverter of the software painter for every supported instruction set.
+ */
+void runConvertBenchmark(int numberOfFrames)
+{
+    const int uAndVWidth = FULL_HD_WIDTH / 2;
+    std::vector<quint8> yuv(FULL_HD_FRAME_SIZE);
+    for (std::size_t i = 0; i < FULL_HD_FRAME_SIZE; ++i) {
+        yuv[i] = static_cast<quint8>(i * 13);
+    }
+    const quint8 * const planes[3] = {
+        yuv.data(), yuv.data() + FULL_HD_WIDTH * FULL_HD_HEIGHT,
+        yuv.data() + FULL_HD_WIDTH * FULL_HD_HEIGHT + uAndVWidth * FULL_HD_HEIGHT / 2
+    };
+    const int lineSizes[3] = { FULL_HD_WIDTH, uAndVWidth, uAndVWidth };
+    std::vector<quint8> rgb(FULL_HD_WIDTH * FULL_HD_HEIGHT * 4);
+    quint8 *rgbPlanes[1] = { rgb.data() };
+
+    printf("%-24s %14s %10s\n", "conversion", "ms per frame", "fps");
+    const QList<QPair<QString,AVPixelFormat>> swsFormats = {
+        { "sws_scale RGB24", AV_PIX_FMT_RGB24 }, { "sws_scale BGRA", AV_PIX_FMT_BGRA }
+    };
+    for (const QPair<QString,AVPixelFormat> &format: swsFormats) {
+        SwsContext *swsContext = sws_getContext(FULL_HD_WIDTH, FULL_HD_HEIGHT, AV_PIX_FMT_YUV420P,
+                                                FULL_HD_WIDTH, FULL_HD_HEIGHT, format.second, SWS_FAST_BILINEAR,
+                                                nullptr, nullptr, nullptr);
+        const int rgbLineSizes[1] = { FULL_HD_WIDTH * (format.second == AV_PIX_FMT_RGB24 ? 3 : 4) };
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < numberOfFrames; ++i) {
+            sws_scale(swsContext, planes, lineSizes, 0, FULL_HD_HEIGHT, rgbPlanes, rgbLineSizes);
+        }
+        printConversionResult(format.first, timer, numberOfFrames);
+        sws_freeContext(swsContext);
+    }
+
+    for (const indoorcycling::InstructionSet instructionSet: indoorcycling::allInstructionSets()) {
+        if (!indoorcycling::isSupported(instructionSet)) {
+            continue;
+        }
+        const YuvToRgbConverter converter(instructionSet);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < numberOfFrames; ++i) {
+            converter.convert(planes, lineSizes, FULL_HD_WIDTH, FULL_HD_HEIGHT, rgb.data(), FULL_HD_WIDTH * 4);
+        }
+        printConversionResult(QString("converter %1").arg(indoorcycling::instructionSetName(instructionSet)),
+                              timer, numberOfFrames);
+    }
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    application.setOrganizationName("big-ring");
+    application.setApplicationName("Big Ring Video Benchmark");
+    application.setApplicationVersion(APP_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the performance of the video decoding of Big Ring.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("videos", "Video files to use for the benchmark.", "videos...");
+    QCommandLineOption threadsOption("threads", "Comma separated list of decoder thread counts to measure.", "counts");
+    parser.addOption(threadsOption);
+    QCommandLineOption threadTypeOption("thread-type", "Decoder thread type: frame, slice or auto.", "type", "auto");
+    parser.addOption(threadTypeOption);
+    QCommandLineOption framesOption("frames", "Number of frames to decode for each measurement.", "frames",
+                                    QString::number(DEFAULT_NUMBER_OF_FRAMES));
+    parser.addOption(framesOption);
+    QCommandLineOption skipOption("skip", "Number of frames to skip after every decoded frame, like at high speeds. "
+                                  "Also measures partial decoding of the skipped frames.", "frames", "0");
+    parser.addOption(skipOption);
+    QCommandLineOption blendOption("blend", "Measure frame blending of 1080p frames, instead of decoding videos.");
+    parser.addOption(blendOption);
+    QCommandLineOption convertOption("convert", "Measure conversion of 1080p frames to RGB for software rendering, "
+                                     "instead of decoding videos.");
+    parser.addOption(convertOption);
+    QCommandLineOption pipelineOption("pipeline", "Ride the videos in real time with a speed profile, using the "
+                                      "complete video pipeline, instead of only decoding them.");
+    parser.addOption(pipelineOption);
+    QCommandLineOption speedsOption("speeds", "Comma separated speeds in km/h of the speed profile for --pipeline.",
+                                    "speeds", "10,20,30,45,60");
+    parser.addOption(speedsOption);
+    QCommandLineOption durationOption("duration", "Duration in seconds of the ride for --pipeline.", "seconds",
+                                      QString::number(DEFAULT_PIPELINE_DURATION_SECONDS));
+    parser.addOption(durationOption);
+    QCommandLineOption metersPerFrameOption("meters-per-frame", "Distance travelled per frame for --pipeline.",
+                                            "meters", QString::number(DEFAULT_METERS_PER_FRAME));
+    parser.addOption(metersPerFrameOption);
+    QCommandLineOption scaleToOption("scale-to", "Reduce frames to about WIDTHxHEIGHT while decoding for --pipeline, "
+                                     "like playing at screen resolution does.", "size");
+    parser.addOption(scaleToOption);
+    QCommandLineOption fileAccessOption("file-access", "The way video files are read for --pipeline: direct, "
+                                        "read-ahead or mmap. Defaults to the setting of Big Ring.", "access");
+    parser.addOption(fileAccessOption);
+    QCommandLineOption throttleOption("throttle", "Read video files for --pipeline as if they are on slow storage, "
+                                      "with a bandwidth in MB/s and a latency in ms for every read.",
+                                      "bandwidth,latency");
+    parser.addOption(throttleOption);
+    parser.process(application);
+
+    if (parser.isSet(blendOption)) {
+        runBlendBenchmark(qMax(1, parser.value(framesOption).toInt()));
+        return 0;
+    }
+    if (parser.isSet(convertOption)) {
+        runConvertBenchmark(qMax(1, parser.value(framesOption).toInt()));
+        return 0;
+    }
+
+    const QStringList videoFilenames = parser.positionalArguments();
+    if (videoFilenames.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QList<int> threadCounts;
+    if (parser.isSet(threadsOption)) {
+        for (const QString &threadCount: parser.value(threadsOption).split(",", QString::SkipEmptyParts)) {
+            threadCounts << qMax(1, threadCount.toInt());
+        }
+    } else {
+        threadCounts = defaultThreadCounts();
+    }
+
+    if (parser.isSet(pipelineOption)) {
+        QList<qreal> speeds;
+        for (const QString &speed: parser.value(speedsOption).split(",", QString::SkipEmptyParts)) {
+            speeds << qMax(qreal(0), speed.toDouble());
+        }
+        const qreal metersPerFrame = parser.value(metersPerFrameOption).toDouble();
+        QSize maximumFrameSize;
+        const QStringList scaleTo = parser.value(scaleToOption).split("x");
+        if (scaleTo.size() == 2) {
+            maximumFrameSize = QSize(scaleTo[0].toInt(), scaleTo[1].toInt());
+        }
+        const VideoFileAccess fileAccess = parser.isSet(fileAccessOption) ?
+                    parseFileAccess(parser.value(fileAccessOption)) : BigRingSettings().videoFileAccess();
+        const QStringList throttle = parser.value(throttleOption).split(",", QString::SkipEmptyParts);
+        const qint64 throttleBytesPerSecond = throttle.isEmpty() ? 0 :
+                static_cast<qint64>(qMax(qreal(0), throttle[0].toDouble()) * 1024 * 1024);
+        const int throttleLatencyMicroseconds = (throttle.size() < 2) ? 0 :
+                static_cast<int>(qMax(qreal(0), throttle[1].toDouble()) * 1000);
+        runPipelineBenchmark(videoFilenames, parser.isSet(threadsOption) ? threadCounts : QList<int>(),
+                             parseThreadType(parser.value(threadTypeOption)), speeds,
+                             qMax(1, parser.value(durationOption).toInt()),
+                             (metersPerFrame > 0) ? metersPerFrame : DEFAULT_METERS_PER_FRAME, maximumFrameSize,
+                             fileAccess, throttleBytesPerSecond, throttleLatencyMicroseconds);
+        return 0;
+    }
+
+    runDecodeBenchmark(videoFilenames, threadCounts, parseThreadType(parser.value(threadTypeOption)),
+                       parser.value(framesOption).toInt(), qMax(0, parser.value(skipOption).toInt()));
+    return 0;
+}
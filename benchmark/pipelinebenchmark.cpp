@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "pipelinebenchmark.h"
+
+#include <algorithm>
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QtDebug>
+
+#include "video/framecopyingvideoreader.h"
+#include "video/softwarepainter.h"
+
+namespace
+{
+/** The simulation, and with it the video, is updated 30 times per second during a ride. */
+const int UPDATES_PER_SECOND = 30;
+/** same as the VideoPlayer */
+const int MAX_STEP_SIZE = 5;
+/** number of seeks that are timed before riding */
+const int NUMBER_OF_SEEKS = 5;
+
+LatencyPercentiles percentiles(std::vector<qint64> nanoseconds)
+{
+    LatencyPercentiles result;
+    if (nanoseconds.empty()) {
+        return result;
+    }
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+    auto percentile = [&nanoseconds](qreal fraction) {
+        return nanoseconds[static_cast<std::size_t>(fraction * (nanoseconds.size() - 1))] * 1e-6;
+    };
+    result.p50 = percentile(0.5);
+    result.p90 = percentile(0.9);
+    result.p99 = percentile(0.99);
+    result.maximum = nanoseconds.back() * 1e-6;
+    return result;
+}
+}
+
+PipelineBenchmark::PipelineBenchmark(QObject *parent) :
+    QObject(parent), _videoReader(new FrameCopyingVideoReader), _videoReaderThread(new QThread),
+    _painter(new SoftwarePainter(this)), _displayTimer(new QTimer(this)), _readAheadController(MAX_STEP_SIZE),
+    _pipelineTimings(std::make_shared<PipelineTimings>())
+{
+    // use the same settings as the VideoPlayer, except for frame blending, as blended frames are not decoded.
+    const BigRingSettings settings;
+    _videoReader->setDecoderThreading(settings.videoDecoderThreadCount(), settings.videoDecoderThreadType());
+    _videoReader->setDirectRenderingEnabled(settings.videoDirectRendering());
+    _videoReader->setSpeedAdaptiveDecodingEnabled(settings.videoSpeedAdaptiveDecoding());
+    _videoReader->setFileAccess(settings.videoFileAccess());
+    _painter->setFrameBufferMemoryBudget(static_cast<qint64>(settings.videoFrameBufferMemory()) * 1024 * 1024);
+    _videoReader->setPipelineTimings(_pipelineTimings);
+    _painter->setPipelineTimings(_pipelineTimings);
+    _videoReader->moveToThread(_videoReaderThread);
+    _videoReaderThread->start();
+
+    _displayTimer->setInterval(1000 / UPDATES_PER_SECOND);
+    _displayTimer->setTimerType(Qt::PreciseTimer);
+    connect(_displayTimer, &QTimer::timeout, this, &PipelineBenchmark::updateDisplay);
+
+    connect(_videoReader, &FrameCopyingVideoReader::videoOpened, this, &PipelineBenchmark::setVideoOpened);
+    connect(_painter, &SoftwarePainter::frameSlotsChanged, this, &PipelineBenchmark::setFrameSlots);
+    connect(_painter, &SoftwarePainter::framesNeeded, this, &PipelineBenchmark::setFramesNeeded);
+    connect(_painter, &SoftwarePainter::frameLoaded, this, &PipelineBenchmark::setFrameLoaded);
+}
+
+PipelineBenchmark::~PipelineBenchmark()
+{
+    _videoReaderThread->quit();
+    _videoReaderThread->wait();
+    delete _videoReader;
+    delete _videoReaderThread;
+}
+
+void PipelineBenchmark::setDecoderThreading(int threadCount, VideoDecoderThreadType threadType)
+{
+    _videoReader->setDecoderThreading(threadCount, threadType);
+}
+
+void PipelineBenchmark::setMaximumFrameSize(const QSize &maximumFrameSize)
+{
+    _videoReader->setMaximumFrameSize(maximumFrameSize);
+}
+
+void PipelineBenchmark::setFileAccess(VideoFileAccess fileAccess)
+{
+    _videoReader->setFileAccess(fileAccess);
+}
+
+void PipelineBenchmark::setFileThrottle(qint64 bytesPerSecond, int latencyMicroseconds)
+{
+    _videoReader->setFileThrottle(bytesPerSecond, latencyMicroseconds);
+}
+
+PipelineBenchmarkResult PipelineBenchmark::run(const QString &videoFilename, const QList<qreal> &speeds,
+                                               int durationSeconds, qreal metersPerFrame)
+{
+    PipelineBenchmarkResult result;
+    _speeds = speeds;
+    _durationMilliseconds = durationSeconds * 1000;
+    _metersPerFrame = metersPerFrame;
+    _readAheadController.setMetersPerFrame(metersPerFrame);
+
+    {
+        QEventLoop loop;
+        connect(_videoReader, &FrameCopyingVideoReader::videoOpened, &loop, &QEventLoop::quit);
+        connect(_videoReader, &FrameCopyingVideoReader::error, &loop, &QEventLoop::quit);
+        _videoReader->openVideoFile(videoFilename);
+        loop.exec();
+    }
+    if (_numberOfFrames <= 0 || _speeds.isEmpty()) {
+        qWarning("Unable to run pipeline benchmark for %s", qPrintable(videoFilename));
+        return result;
+    }
+
+    std::vector<qint64> seekNanoseconds;
+    for (int i = NUMBER_OF_SEEKS; i >= 0; --i) {
+        // the last seek is to the start of the video, where the ride starts.
+        QElapsedTimer seekTimer;
+        seekTimer.start();
+        seekAndWait(_numberOfFrames * i / (NUMBER_OF_SEEKS + 1));
+        seekNanoseconds.push_back(seekTimer.nsecsElapsed());
+    }
+    result.seekLatency = percentiles(seekNanoseconds);
+
+    {
+        QEventLoop loop;
+        QTimer::singleShot(_durationMilliseconds, &loop, &QEventLoop::quit);
+        _painter->fillBuffers();
+        _painter->resetFrameRingStatistics();
+        _pipelineTimings->reset();
+        _rideTimer.start();
+        _displayTimer->start();
+        loop.exec();
+        _displayTimer->stop();
+    }
+    result.frameRing = _painter->frameRingStatistics();
+    result.stageTimings = _pipelineTimings->summary();
+
+    const qreal seconds = _rideTimer.nsecsElapsed() * 1e-9;
+    result.requestedFramesPerSecond = _distance / _metersPerFrame / seconds;
+    result.shownFramesPerSecond = _framesShown / seconds;
+    result.copiedFramesPerSecond = _framesCopied / seconds;
+    result.missedUpdatesPercentage = (_updates > 0) ? 100.0 * _missedUpdates / _updates : 0;
+    result.decodeLatency = percentiles(_decodeNanoseconds);
+    result.copyLatency = percentiles(_copyNanoseconds);
+
+    const qint64 frameBufferBytes = _frameFormat.bufferSize();
+    qint64 copiedBytes = 0;
+    qint64 totalCopyNanoseconds = 0;
+    for (const qint64 copyNanoseconds: _copyNanoseconds) {
+        if (copyNanoseconds > 0) {
+            copiedBytes += frameBufferBytes;
+            totalCopyNanoseconds += copyNanoseconds;
+        }
+    }
+    result.copyBandwidth = (totalCopyNanoseconds > 0) ? static_cast<qreal>(copiedBytes) / totalCopyNanoseconds : 0;
+    return result;
+}
+
+void PipelineBenchmark::seekAndWait(qint64 frameNumber)
+{
+    QEventLoop loop;
+    QMetaObject::Connection connection =
+            connect(_videoReader, &FrameCopyingVideoReader::seekReady, this, [this, &loop](qint64 readyFrameNumber) {
+        _currentFrameNumber = readyFrameNumber;
+        _distance = readyFrameNumber * _metersPerFrame;
+        loop.quit();
+    });
+    _painter->cancelFrameRequests();
+    _videoReader->seekToFrame(frameNumber);
+    loop.exec();
+    disconnect(connection);
+}
+
+void PipelineBenchmark::setVideoOpened(const QString &, const QSize &videoSize, const FrameFormat &frameFormat,
+                                       qint64 numberOfFrames)
+{
+    _numberOfFrames = numberOfFrames;
+    _frameFormat = frameFormat;
+    _painter->setVideoSize(videoSize, frameFormat);
+}
+
+void PipelineBenchmark::setFrameSlots(const std::shared_ptr<FrameSlotRing> &frameSlots)
+{
+    _videoReader->setFrameSlots(frameSlots);
+}
+
+void PipelineBenchmark::setFramesNeeded()
+{
+    _videoReader->readFrames();
+}
+
+void PipelineBenchmark::setFrameLoaded(qint64 frameNumber, int skipFrames, qint64 decodeNanoseconds,
+                                       qint64 copyNanoseconds)
+{
+    ++_framesCopied;
+    _lastFrameLoaded = frameNumber;
+    _decodeNanoseconds.push_back(decodeNanoseconds);
+    _copyNanoseconds.push_back(copyNanoseconds);
+    _readAheadController.addDecodedFrame(skipFrames, decodeNanoseconds, copyNanoseconds);
+}
+
+/**
+ * Advance the ride with the speed of the current part of the speed profile, and step to the frame for the new
+ * distance, like the VideoPlayer does.
+ */
+void PipelineBenchmark::updateDisplay()
+{
+    const qint64 elapsedNanoseconds = _rideTimer.nsecsElapsed();
+    const int part = qMin(static_cast<int>(elapsedNanoseconds / 1000000 * _speeds.size() / _durationMilliseconds),
+                          _speeds.size() - 1);
+    _distance += _speeds[part] / 3.6 * (elapsedNanoseconds - _lastUpdateNanoseconds) * 1e-9;
+    _lastUpdateNanoseconds = elapsedNanoseconds;
+    _readAheadController.setSpeed(_speeds[part] / 3.6, elapsedNanoseconds / 1000000);
+
+    const qint64 frameNumber = qMin(static_cast<qint64>(_distance / _metersPerFrame), _numberOfFrames - 1);
+    ++_updates;
+    _painter->loadFilledFrames();
+    if (frameNumber > _lastFrameLoaded) {
+        ++_missedUpdates;
+        _stepSize = MAX_STEP_SIZE;
+        _painter->setFrameRequest(_stepSize - 1, false);
+        _painter->fillBuffers();
+        return;
+    }
+    _stepSize = (frameNumber - _currentFrameNumber > MAX_STEP_SIZE) ? MAX_STEP_SIZE : _readAheadController.stepSize();
+    _painter->setFrameRequest(_stepSize - 1, false);
+    // like the VideoPlayer, let the painter size its frame ring to the frames that are shown.
+    _painter->setShownEntriesPerSecond(_readAheadController.peakFramesPerSecond() / qMax(_stepSize, 1));
+    _painter->setReadAheadFrames(_readAheadController.readAheadFrames());
+    if (_painter->showFrame(frameNumber)) {
+        ++_framesShown;
+    }
+    _currentFrameNumber = frameNumber;
+}
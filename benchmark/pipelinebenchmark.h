@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef PIPELINEBENCHMARK_H
+#define PIPELINEBENCHMARK_H
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+
+#include "config/bigringsettings.h"
+#include "video/frameformat.h"
+#include "video/framering.h"
+#include "video/frameslotring.h"
+#include "video/pipelinetimings.h"
+#include "video/readaheadcontroller.h"
+
+class FrameCopyingVideoReader;
+class SoftwarePainter;
+class QThread;
+class QTimer;
+
+/** Latency percentiles, in milliseconds. */
+struct LatencyPercentiles
+{
+    qreal p50 = 0;
+    qreal p90 = 0;
+    qreal p99 = 0;
+    qreal maximum = 0;
+};
+
+/** The results of a run of the PipelineBenchmark. */
+struct PipelineBenchmarkResult
+{
+    /** frames per second requested by the speed profile */
+    qreal requestedFramesPerSecond = 0;
+    /** frames per second actually shown */
+    qreal shownFramesPerSecond = 0;
+    /** frames per second copied into the frame buffers */
+    qreal copiedFramesPerSecond = 0;
+    /** percentage of the display updates for which the requested frame was not loaded yet */
+    qreal missedUpdatesPercentage = 0;
+    LatencyPercentiles decodeLatency;
+    LatencyPercentiles copyLatency;
+    LatencyPercentiles seekLatency;
+    /** speed of copying frames into the frame buffers, in GB/s */
+    qreal copyBandwidth = 0;
+    /** how full the ring of frame buffers was during the ride */
+    FrameRingStatistics frameRing;
+    /** latencies of the stages of the pipeline during the ride, see PipelineTimings::summary() */
+    QString stageTimings;
+};
+
+/**
+ * Measures the performance of the complete video pipeline, without showing anything. A FrameCopyingVideoReader is
+ * driven like the VideoPlayer does during a ride, following a speed profile in real time. The frames are copied into
+ * the frame buffers of a SoftwarePainter, which are in normal memory, so no display or OpenGL is needed.
+ */
+class PipelineBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PipelineBenchmark(QObject *parent = 0);
+    virtual ~PipelineBenchmark();
+
+    /** Set the number of decoder threads and the way they are used. By default, the settings of Big Ring are used. */
+    void setDecoderThreading(int threadCount, VideoDecoderThreadType threadType);
+    /** Reduce frames to \param maximumFrameSize while decoding, like the display playback quality does. */
+    void setMaximumFrameSize(const QSize &maximumFrameSize);
+    /** Set the way the video files are read, see GenericVideoReader::setFileAccess. */
+    void setFileAccess(VideoFileAccess fileAccess);
+    /** Read the video files as if they are on slow storage, see GenericVideoReader::setFileThrottle. */
+    void setFileThrottle(qint64 bytesPerSecond, int latencyMicroseconds);
+
+    /**
+     * Ride \param videoFilename with a speed profile. The profile consists of \param speeds in km/h, that each last
+     * an equal part of \param durationSeconds. Before riding, a number of seeks are timed.
+     * @param metersPerFrame the distance travelled for every frame of the video.
+     */
+    PipelineBenchmarkResult run(const QString &videoFilename, const QList<qreal> &speeds, int durationSeconds,
+                                qreal metersPerFrame);
+
+private slots:
+    void setVideoOpened(const QString &videoFilename, const QSize &videoSize, const FrameFormat &frameFormat,
+                        qint64 numberOfFrames);
+    void setFrameSlots(const std::shared_ptr<FrameSlotRing> &frameSlots);
+    void setFramesNeeded();
+    void setFrameLoaded(qint64 frameNumber, int skipFrames, qint64 decodeNanoseconds, qint64 copyNanoseconds);
+    void updateDisplay();
+
+private:
+    void seekAndWait(qint64 frameNumber);
+
+    FrameCopyingVideoReader *const _videoReader;
+    QThread *const _videoReaderThread;
+    SoftwarePainter *const _painter;
+    QTimer *const _displayTimer;
+
+    QList<qreal> _speeds;
+    int _durationMilliseconds = 0;
+    qreal _metersPerFrame = 1;
+    qint64 _numberOfFrames = 0;
+    FrameFormat _frameFormat;
+    QElapsedTimer _rideTimer;
+    qint64 _lastUpdateNanoseconds = 0;
+
+    qreal _distance = 0;
+    qint64 _currentFrameNumber = 0;
+    qint64 _lastFrameLoaded = -1;
+    int _stepSize = 1;
+    int _framesShown = 0;
+    int _framesCopied = 0;
+    int _updates = 0;
+    int _missedUpdates = 0;
+    std::vector<qint64> _decodeNanoseconds;
+    std::vector<qint64> _copyNanoseconds;
+    ReadAheadController _readAheadController;
+    const std::shared_ptr<PipelineTimings> _pipelineTimings;
+};
+
+#endif // PIPELINEBENCHMARK_H
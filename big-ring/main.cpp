@@ -18,7 +18,9 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#include "config/bigringsettings.h"
 #include "maingui/mainwindow.h"
+#include "util/threadrole.h"
 #include <QtCore/QCommandLineParser>
 #include <QtCore/QtGlobal>
 #include <QtCore/QTime>
@@ -92,6 +94,7 @@ void loadStyleSheet(QApplication& a)
 
 struct Options {
     bool showDebugOutput = false;
+    QString videoTimingsFilename;
 };
 
 /**
@@ -106,11 +109,16 @@ Options parseCommandLine(QApplication &application) {
     parser.addVersionOption();
     QCommandLineOption debugOption("d",  QCoreApplication::translate("main", "Show debug output during ride"));
     parser.addOption(debugOption);
+    QCommandLineOption videoTimingsOption("video-timings",
+                                          QCoreApplication::translate("main", "Write the latencies of the video "
+                                                                      "pipeline to <file> during a ride"), "file");
+    parser.addOption(videoTimingsOption);
 
     parser.process(application);
 
     Options options;
     options.showDebugOutput = parser.isSet(debugOption);
+    options.videoTimingsFilename = parser.value(videoTimingsOption);
 
     return options;
 }
@@ -133,7 +141,11 @@ int main(int argc, char *argv[])
 
     qDebug() << "APP VERSION" << a.applicationVersion();
 
-    MainWindow w(options.showDebugOutput);
+    // the thread roles have to be configured before any threads with a role are started.
+    const BigRingSettings settings;
+    indoorcycling::configureThreadRoles(settings.threadCpuAffinity(), settings.threadRealtimeScheduling());
+
+    MainWindow w(options.showDebugOutput, options.videoTimingsFilename);
     w.setWindowTitle(QString("%1 %2").arg(a.applicationName()).arg(a.applicationVersion()));
     w.showMaximized();
 
@@ -13,14 +13,15 @@ linux {
     CONFIG += link_pkgconfig
 }
 win32 {
-    LIBAV_PATH=C:\development\libav-i686-w64-mingw32-11.2
+    # FFmpeg 3.1 or newer is needed for the send/receive decoding API.
+    LIBAV_PATH=C:\development\ffmpeg-3.4-i686-w64-mingw32
     LIBAV_DLL_PATH = $$LIBAV_PATH\usr\bin
 
     INCLUDEPATH += $$LIBAV_PATH\usr\include
-    LIBS += $$LIBAV_PATH\usr\bin\avcodec-56.dll
-    LIBS += $$LIBAV_PATH\usr\bin\avformat-56.dll
-    LIBS += $$LIBAV_PATH\usr\bin\avutil-54.dll
-    LIBS += $$LIBAV_PATH\usr\bin\swscale-3.dll
+    LIBS += $$LIBAV_PATH\usr\bin\avcodec-57.dll
+    LIBS += $$LIBAV_PATH\usr\bin\avformat-57.dll
+    LIBS += $$LIBAV_PATH\usr\bin\avutil-55.dll
+    LIBS += $$LIBAV_PATH\usr\bin\swscale-4.dll
 
     LIBUSB_PATH = C:\development\libusb-win32-bin-1.2.6.0
 
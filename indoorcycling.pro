@@ -5,11 +5,13 @@ SUBDIRS += \
     mainlib \
     big-ring \
     anttestapp \
-    test
+    test \
+    benchmark
 
 big-ring.depends = mainlib
 anttestapp.depends = mainlib
 test.depends = mainlib
+benchmark.depends = mainlib
 
 RESOURCES += \
     mainlib/icons.qrc \
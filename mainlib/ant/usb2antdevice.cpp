@@ -24,6 +24,8 @@
 #include <QtCore/QMutexLocker>
 #include <QtCore/QThread>
 
+#include "util/threadrole.h"
+
 extern "C" {
 #ifdef Q_OS_LINUX
 #include "thirdparty/libusb-compat/usb.h"
@@ -116,7 +118,8 @@ Usb2AntDevice::Usb2AntDevice(QObject *parent) :
     connect(this, &Usb2AntDevice::doWrite, _worker, &Usb2AntDeviceWorker::write);
     connect(_workerThread, &QThread::started, _worker, &Usb2AntDeviceWorker::initialize);
 
-    _workerThread->start();
+    // the worker reads the sensor data, which should keep flowing when video decoding takes all cores.
+    indoorcycling::startThread(_workerThread, indoorcycling::ThreadRole::RIDE_CRITICAL);
 }
 
 Usb2AntDevice::~Usb2AntDevice() {
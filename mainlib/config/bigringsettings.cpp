@@ -21,6 +21,7 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
 #include <QtCore/QUuid>
 
 namespace
@@ -33,6 +34,13 @@ const qreal BIKE_WEIGHT_KILOGRAMS_DEFAULT = 10.0;
 
 const qreal DEFAULT_UP_AND_DOWNHILL_CAPS = 25.0;
 const int DEFAULT_DIFFICULTY_SETTING = 100;
+
+// libav does not scale well beyond 16 decoding threads.
+const int MAXIMUM_VIDEO_DECODER_THREADS = 16;
+
+// enough for about 80 frames of 1080p video, or all 150 frames of 720p video.
+const int DEFAULT_FRAME_BUFFER_MEMORY = 256;
+const qreal DEFAULT_PRELOAD_SECONDS = 1.0;
 }
 
 BigRingSettings::BigRingSettings()
@@ -224,6 +232,295 @@ void BigRingSettings::setDifficultySetting(const int percent)
     _settings.endGroup();
 }
 
+int BigRingSettings::videoDecoderThreadCount() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const int threadCount = settings.value("decoderThreadCount", QVariant::fromValue(0)).toInt();
+    settings.endGroup();
+    if (threadCount > 0) {
+        return qMin(threadCount, MAXIMUM_VIDEO_DECODER_THREADS);
+    }
+    // by default, use one decoding thread per core.
+    return qBound(1, QThread::idealThreadCount(), MAXIMUM_VIDEO_DECODER_THREADS);
+}
+
+void BigRingSettings::setVideoDecoderThreadCount(const int threadCount)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("decoderThreadCount", QVariant::fromValue(qMax(0, threadCount)));
+    _settings.endGroup();
+}
+
+VideoDecoderThreadType BigRingSettings::videoDecoderThreadType() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+
+    VideoDecoderThreadType threadType = VideoDecoderThreadType::FRAME_AND_SLICE;
+    const QString threadTypeString = settings.value("decoderThreadType", "FrameAndSlice").toString();
+    if (threadTypeString == "Frame") {
+        threadType = VideoDecoderThreadType::FRAME;
+    } else if (threadTypeString == "Slice") {
+        threadType = VideoDecoderThreadType::SLICE;
+    }
+    settings.endGroup();
+
+    return threadType;
+}
+
+void BigRingSettings::setVideoDecoderThreadType(const VideoDecoderThreadType threadType)
+{
+    _settings.beginGroup("video");
+    QString threadTypeString;
+    switch (threadType) {
+    case VideoDecoderThreadType::FRAME:
+        threadTypeString = "Frame";
+        break;
+    case VideoDecoderThreadType::SLICE:
+        threadTypeString = "Slice";
+        break;
+    default:
+        threadTypeString = "FrameAndSlice";
+        break;
+    }
+    _settings.setValue("decoderThreadType", QVariant::fromValue(threadTypeString));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::videoDirectRendering() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const bool directRendering = settings.value("directRendering", QVariant::fromValue(true)).toBool();
+    settings.endGroup();
+    return directRendering;
+}
+
+void BigRingSettings::setVideoDirectRendering(const bool directRendering)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("directRendering", QVariant::fromValue(directRendering));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::videoSpeedAdaptiveDecoding() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const bool speedAdaptiveDecoding = settings.value("speedAdaptiveDecoding", QVariant::fromValue(true)).toBool();
+    settings.endGroup();
+    return speedAdaptiveDecoding;
+}
+
+void BigRingSettings::setVideoSpeedAdaptiveDecoding(const bool speedAdaptiveDecoding)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("speedAdaptiveDecoding", QVariant::fromValue(speedAdaptiveDecoding));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::videoFrameBlending() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const bool frameBlending = settings.value("frameBlending", QVariant::fromValue(false)).toBool();
+    settings.endGroup();
+    return frameBlending;
+}
+
+void BigRingSettings::setVideoFrameBlending(const bool frameBlending)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("frameBlending", QVariant::fromValue(frameBlending));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::videoSoftwareRendering() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const bool softwareRendering = settings.value("softwareRendering", QVariant::fromValue(false)).toBool();
+    settings.endGroup();
+    return softwareRendering;
+}
+
+void BigRingSettings::setVideoSoftwareRendering(const bool softwareRendering)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("softwareRendering", QVariant::fromValue(softwareRendering));
+    _settings.endGroup();
+}
+
+int BigRingSettings::videoFrameBufferMemory() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const int megabytes = settings.value("frameBufferMemory", QVariant::fromValue(DEFAULT_FRAME_BUFFER_MEMORY)).toInt();
+    settings.endGroup();
+    return megabytes;
+}
+
+void BigRingSettings::setVideoFrameBufferMemory(const int megabytes)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("frameBufferMemory", QVariant::fromValue(megabytes));
+    _settings.endGroup();
+}
+
+qreal BigRingSettings::videoPreloadSeconds() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const qreal seconds = settings.value("preloadSeconds", QVariant::fromValue(DEFAULT_PRELOAD_SECONDS)).toDouble();
+    settings.endGroup();
+    return seconds;
+}
+
+void BigRingSettings::setVideoPreloadSeconds(const qreal seconds)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("preloadSeconds", QVariant::fromValue(seconds));
+    _settings.endGroup();
+}
+
+VideoPlaybackQuality BigRingSettings::videoPlaybackQuality() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const QString playbackQuality = settings.value("playbackQuality", "Full").toString();
+    settings.endGroup();
+    return (playbackQuality == "Display") ? VideoPlaybackQuality::DISPLAY : VideoPlaybackQuality::FULL;
+}
+
+void BigRingSettings::setVideoPlaybackQuality(const VideoPlaybackQuality playbackQuality)
+{
+    _settings.beginGroup("video");
+    const QString playbackQualityString = (playbackQuality == VideoPlaybackQuality::DISPLAY) ? "Display" : "Full";
+    _settings.setValue("playbackQuality", QVariant::fromValue(playbackQualityString));
+    _settings.endGroup();
+}
+
+VideoFileAccess BigRingSettings::videoFileAccess() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+
+    VideoFileAccess fileAccess = VideoFileAccess::DIRECT;
+    const QString fileAccessString = settings.value("fileAccess", "Direct").toString();
+    if (fileAccessString == "ReadAhead") {
+        fileAccess = VideoFileAccess::READ_AHEAD;
+    } else if (fileAccessString == "MemoryMapped") {
+        fileAccess = VideoFileAccess::MEMORY_MAPPED;
+    }
+    settings.endGroup();
+
+    return fileAccess;
+}
+
+void BigRingSettings::setVideoFileAccess(const VideoFileAccess fileAccess)
+{
+    _settings.beginGroup("video");
+    QString fileAccessString;
+    switch (fileAccess) {
+    case VideoFileAccess::READ_AHEAD:
+        fileAccessString = "ReadAhead";
+        break;
+    case VideoFileAccess::MEMORY_MAPPED:
+        fileAccessString = "MemoryMapped";
+        break;
+    default:
+        fileAccessString = "Direct";
+        break;
+    }
+    _settings.setValue("fileAccess", QVariant::fromValue(fileAccessString));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::videoEnergySaving() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const bool energySaving = settings.value("energySaving", QVariant::fromValue(false)).toBool();
+    settings.endGroup();
+    return energySaving;
+}
+
+void BigRingSettings::setVideoEnergySaving(const bool energySaving)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("energySaving", QVariant::fromValue(energySaving));
+    _settings.endGroup();
+}
+
+int BigRingSettings::videoProxyCpuBudget() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const int cores = settings.value("proxyCpuBudget", QVariant::fromValue(0)).toInt();
+    settings.endGroup();
+    if (cores > 0) {
+        return qMin(cores, QThread::idealThreadCount());
+    }
+    return qMax(1, QThread::idealThreadCount() / 2);
+}
+
+void BigRingSettings::setVideoProxyCpuBudget(const int cores)
+{
+    _settings.beginGroup("video");
+    _settings.setValue("proxyCpuBudget", QVariant::fromValue(qMax(0, cores)));
+    _settings.endGroup();
+}
+
+VideoPlaybackQuality BigRingSettings::videoProxyQuality() const
+{
+    QSettings settings;
+    settings.beginGroup("video");
+    const QString proxyQuality = settings.value("proxyQuality", "Display").toString();
+    settings.endGroup();
+    return (proxyQuality == "Full") ? VideoPlaybackQuality::FULL : VideoPlaybackQuality::DISPLAY;
+}
+
+void BigRingSettings::setVideoProxyQuality(const VideoPlaybackQuality proxyQuality)
+{
+    _settings.beginGroup("video");
+    const QString proxyQualityString = (proxyQuality == VideoPlaybackQuality::FULL) ? "Full" : "Display";
+    _settings.setValue("proxyQuality", QVariant::fromValue(proxyQualityString));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::threadCpuAffinity() const
+{
+    QSettings settings;
+    settings.beginGroup("threads");
+    const bool cpuAffinity = settings.value("cpuAffinity", QVariant::fromValue(false)).toBool();
+    settings.endGroup();
+    return cpuAffinity;
+}
+
+void BigRingSettings::setThreadCpuAffinity(const bool cpuAffinity)
+{
+    _settings.beginGroup("threads");
+    _settings.setValue("cpuAffinity", QVariant::fromValue(cpuAffinity));
+    _settings.endGroup();
+}
+
+bool BigRingSettings::threadRealtimeScheduling() const
+{
+    QSettings settings;
+    settings.beginGroup("threads");
+    const bool realtimeScheduling = settings.value("realtimeScheduling", QVariant::fromValue(false)).toBool();
+    settings.endGroup();
+    return realtimeScheduling;
+}
+
+void BigRingSettings::setThreadRealtimeScheduling(const bool realtimeScheduling)
+{
+    _settings.beginGroup("threads");
+    _settings.setValue("realtimeScheduling", QVariant::fromValue(realtimeScheduling));
+    _settings.endGroup();
+}
+
 qreal BigRingSettings::maximumUphillForSmartTrainer() const
 {
     QSettings settings;
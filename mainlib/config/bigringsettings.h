@@ -22,6 +22,26 @@
 
 #include <QtCore/QSettings>
 
+/** The way libav uses multiple threads for decoding video */
+enum class VideoDecoderThreadType {
+    FRAME_AND_SLICE, // let libav choose, it will prefer frame threading.
+    FRAME, // decode multiple frames in parallel
+    SLICE // decode multiple parts of a single frame in parallel
+};
+
+/** The resolution in which videos are decoded and shown */
+enum class VideoPlaybackQuality {
+    FULL, // the resolution of the video
+    DISPLAY // reduced to the resolution of the display, if the video is larger
+};
+
+/** The way video files are read from disk */
+enum class VideoFileAccess {
+    DIRECT, // in the small pieces libav asks for, with libav's own file protocol
+    READ_AHEAD, // in large blocks, which are read ahead on a separate thread
+    MEMORY_MAPPED // mapped into memory, so the operating system reads ahead
+};
+
 /**
  * Wrapper around QSettings, used for application specific settings.
  * Just create a BigRingSettings object on the stack and load and
@@ -68,6 +88,78 @@ public:
     int difficultySetting() const;
     void setDifficultySetting(const int percent);
 
+    /** Number of threads used for decoding video. If not set, this is determined from the number of cores. */
+    int videoDecoderThreadCount() const;
+    /** Set the number of threads used for decoding video. Use 0 to determine it from the number of cores. */
+    void setVideoDecoderThreadCount(const int threadCount);
+
+    VideoDecoderThreadType videoDecoderThreadType() const;
+    void setVideoDecoderThreadType(const VideoDecoderThreadType threadType);
+
+    /**
+     * Whether the decoder may write frames directly into video memory, when the video format allows it. Only
+     * intra-only codecs allow it, as other codecs keep decoded frames as references after the frames are shown.
+     */
+    bool videoDirectRendering() const;
+    void setVideoDirectRendering(const bool directRendering);
+
+    /** Whether frames that are skipped at high speeds are only decoded as far as needed. */
+    bool videoSpeedAdaptiveDecoding() const;
+    void setVideoSpeedAdaptiveDecoding(const bool speedAdaptiveDecoding);
+
+    /** Whether frames are blended at low speeds, so the video does not look choppy. */
+    bool videoFrameBlending() const;
+    void setVideoFrameBlending(const bool frameBlending);
+
+    /** Whether video is converted to RGB and scaled on the cpu, instead of with OpenGL. */
+    bool videoSoftwareRendering() const;
+    void setVideoSoftwareRendering(const bool softwareRendering);
+
+    /** Maximum amount of memory used for decoded frames that are waiting to be shown, in megabytes. */
+    int videoFrameBufferMemory() const;
+    void setVideoFrameBufferMemory(const int megabytes);
+
+    /** Number of seconds of video that is decoded before a ride can start. */
+    qreal videoPreloadSeconds() const;
+    void setVideoPreloadSeconds(const qreal seconds);
+
+    /** Whether videos that are larger than the display are reduced to the size of the display while decoding. */
+    VideoPlaybackQuality videoPlaybackQuality() const;
+    void setVideoPlaybackQuality(const VideoPlaybackQuality playbackQuality);
+
+    /** The way video files are read. Reading ahead helps when videos are on a network share or a slow disk. */
+    VideoFileAccess videoFileAccess() const;
+    void setVideoFileAccess(const VideoFileAccess fileAccess);
+
+    /**
+     * Whether video is played in the energy saving mode: frames are decoded in batches and only as far ahead as the
+     * cyclist will ride, and nothing is decoded or painted while the cyclist stands still.
+     */
+    bool videoEnergySaving() const;
+    void setVideoEnergySaving(const bool energySaving);
+
+    /**
+     * Number of cores that may be used for transcoding proxies of videos in the background. By default, this is half
+     * of the cores.
+     */
+    int videoProxyCpuBudget() const;
+    void setVideoProxyCpuBudget(const int cores);
+
+    /** Whether proxies of videos are reduced to the resolution of the display, or have the resolution of the video. */
+    VideoPlaybackQuality videoProxyQuality() const;
+    void setVideoProxyQuality(const VideoPlaybackQuality proxyQuality);
+
+    /**
+     * Whether background threads are kept to a quarter of the cores, and video and sensor threads to the other cores.
+     * Only used on Linux.
+     */
+    bool threadCpuAffinity() const;
+    void setThreadCpuAffinity(const bool cpuAffinity);
+
+    /** Whether video and sensor threads are scheduled as real-time threads. Only used on Linux. */
+    bool threadRealtimeScheduling() const;
+    void setThreadRealtimeScheduling(const bool realtimeScheduling);
+
     /** Get the unique id for this installation */
     QString clientId();
 private:
@@ -1,8 +1,8 @@
 #include "gpxfileparser.h"
 
+#include "importer/videoprober.h"
 #include "model/distancemappingentry.h"
 #include "model/videoinformation.h"
-#include "video/videoinforeader.h"
 
 #include <deque>
 #include <functional>
@@ -74,8 +74,8 @@ double runningAverageValue(const typename std::vector<T>::const_iterator &begin,
 
 namespace indoorcycling {
 
-GpxFileParser::GpxFileParser(const QList<QFileInfo> &videoFiles, QObject *parent) :
-    QObject(parent), _videoFiles(videoFiles)
+GpxFileParser::GpxFileParser(const QList<QFileInfo> &videoFiles, VideoProber &videoProber, QObject *parent) :
+    QObject(parent), _videoFiles(videoFiles), _videoProber(videoProber)
 {
 }
 
@@ -108,7 +108,8 @@ RealLifeVideo GpxFileParser::parseXml(const QFile &inputFile,
                                       QXmlStreamReader &reader) const
 {
     QString name = QFileInfo(inputFile).baseName();
-    float frameRate = VideoInfoReader().videoInfoForVideo(videoFileInfo).frameRate;
+    const VideoInformation videoInformation = _videoProber.probe(VideoInformation(videoFileInfo.filePath(), 0));
+    const float frameRate = videoInformation.frameRate();
 
     std::vector<QGeoPositionInfo> trackPoints;
     QXmlStreamReader::TokenType currentTokenType;
@@ -122,7 +123,6 @@ RealLifeVideo GpxFileParser::parseXml(const QFile &inputFile,
     const std::vector<GeoPosition> geoPositions = convertTrackPoints(trackPoints);
     const std::vector<GeoPosition> smoothedAltitudeGeoPositions = smoothAltitudes(geoPositions);
 
-    const VideoInformation videoInformation(videoFileInfo.filePath(), frameRate);
     const Profile profile(ProfileType::SLOPE, 0.0f, smoothSlopes(convertProfileEntries(smoothedAltitudeGeoPositions)));
     std::vector<Course> courses = { Course("Complete Distance", 0, profile.totalDistance()) };
     std::vector<DistanceMappingEntry> distanceMappings = convertDistanceMappings(frameRate, trackPoints);
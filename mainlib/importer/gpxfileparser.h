@@ -10,6 +10,8 @@
 #include "model/geoposition.h"
 #include "model/reallifevideo.h"
 
+class VideoProber;
+
 namespace indoorcycling {
 
 /**
@@ -65,9 +67,10 @@ public:
     /**
      * @brief create a GpxFileParser, with the list of video files that can be used.
      * @param videoFiles the video files that can be used as videos for RealLifeVideos.
+     * @param videoProber prober used to determine the frame rate and other metadata of the video file.
      * @param parent optional QObject-parent.
      */
-    explicit GpxFileParser(const QList<QFileInfo>& videoFiles, QObject *parent = 0);
+    explicit GpxFileParser(const QList<QFileInfo>& videoFiles, VideoProber &videoProber, QObject *parent = 0);
     /**
      * @brief parse a GPX rlv file.
      *
@@ -98,6 +101,7 @@ private:
                                                               const std::vector<QGeoPositionInfo> &trackPoints) const;
 
     const QList<QFileInfo> _videoFiles;
+    VideoProber &_videoProber;
 };
 }
 
@@ -30,7 +30,8 @@
 
 namespace
 {
-const quint32 CACHE_FILE_MAGIC = 0xC4C1FA51;
+// changed when the layout of the cache files changes, so older cache files are not used.
+const quint32 CACHE_FILE_MAGIC = 0xC4C1FA53;
 const int CACHE_FILE_QDATASTREAM_VERSION = QDataStream::Qt_5_14;
 }
 
@@ -76,11 +77,7 @@ std::unique_ptr<RealLifeVideo> RealLifeVideoCache::load(const QFile &rlvFile)
     in >> fileTypeAsInt;
     const RealLifeVideoFileType fileType = static_cast<RealLifeVideoFileType>(fileTypeAsInt);
 
-    qreal frameRate;
-    in >> frameRate;
-    QString videoFilename;
-    in >> videoFilename;
-    VideoInformation videoInformation(videoFilename, frameRate);
+    VideoInformation videoInformation = readVideoInformation(in);
 
     std::vector<Course> courses = readCourses(in);
     std::vector<DistanceMappingEntry> distanceMappings = readDistanceMappings(in);
@@ -107,8 +104,7 @@ void RealLifeVideoCache::save(const QFile &rlvFile, const RealLifeVideo &rlv)
 
     out << rlv.name();
     out << static_cast<quint32>(rlv.fileType());
-    out << rlv.videoFrameRate();
-    out << rlv.videoFilename();
+    saveVideoInformation(out, rlv.videoInformation());
 
     saveCourses(out, rlv.courses());
     saveDistanceMappings(out, rlv.distanceMappings());
@@ -130,6 +126,41 @@ QString RealLifeVideoCache::absoluteFilenameForRlv(const QString &name) const
     return rlvCacheDir.filePath(QString("%1.rlvdat").arg(name));
 }
 
+void RealLifeVideoCache::saveVideoInformation(QDataStream &out, const VideoInformation &videoInformation) const
+{
+    out << static_cast<qreal>(videoInformation.frameRate());
+    out << videoInformation.videoFilenames();
+    out << videoInformation.numberOfFrames();
+    out << videoInformation.frameSize();
+    out << videoInformation.pixelFormat();
+    out << videoInformation.fileSize();
+    out << videoInformation.lastModified();
+}
+
+VideoInformation RealLifeVideoCache::readVideoInformation(QDataStream &in) const
+{
+    qreal frameRate;
+    in >> frameRate;
+    QStringList videoFilenames;
+    in >> videoFilenames;
+    qint64 numberOfFrames;
+    in >> numberOfFrames;
+    QSize frameSize;
+    in >> frameSize;
+    QString pixelFormat;
+    in >> pixelFormat;
+    qint64 fileSize;
+    in >> fileSize;
+    QDateTime lastModified;
+    in >> lastModified;
+
+    VideoInformation videoInformation(videoFilenames, static_cast<float>(frameRate));
+    if (numberOfFrames > 0) {
+        videoInformation.setProbedMetadata(numberOfFrames, frameSize, pixelFormat, fileSize, lastModified);
+    }
+    return videoInformation;
+}
+
 void RealLifeVideoCache::saveCourses(QDataStream &out, const std::vector<Course> &courses) const
 {
     out << static_cast<quint32>(courses.size());
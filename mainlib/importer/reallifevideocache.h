@@ -23,6 +23,7 @@
 #include <QtCore/QObject>
 #include <memory>
 #include "model/reallifevideo.h"
+#include "model/videoinformation.h"
 
 /**
  * A File Cache for RealLifeVideos. Objects of this class are used to save and load RealLifeVideos to and from a format
@@ -50,6 +51,8 @@ public:
 
 private:
     QString absoluteFilenameForRlv(const QString &name) const;
+    void saveVideoInformation(QDataStream &out, const VideoInformation &videoInformation) const;
+    VideoInformation readVideoInformation(QDataStream &in) const;
     void saveCourses(QDataStream &out, const std::vector<Course> &courses) const;
     std::vector<Course> readCourses(QDataStream &in) const;
 
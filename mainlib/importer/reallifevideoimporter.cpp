@@ -24,6 +24,7 @@
 #include "importer/virtualtrainingfileparser.h"
 #include "reallifevideoimporter.h"
 #include "reallifevideocache.h"
+#include "util/threadrole.h"
 
 #include <functional>
 
@@ -39,7 +40,8 @@
 
 namespace
 {
-RealLifeVideo parseRealLiveVideoFile(QFile &rlvFile, const QList<QString> &videoFilePaths, const QList<QString> &pgmfFilePaths);
+RealLifeVideo parseRealLiveVideoFile(QFile &rlvFile, const QList<QString> &videoFilePaths, const QList<QString> &pgmfFilePaths,
+                                     VideoProber &videoProber);
 QSet<QString> findFiles(const QStringList &roots, const QStringList &patterns);
 QSet<QString> findRlvFiles(const QStringList &roots);
 
@@ -107,8 +109,12 @@ RealLifeVideoList RealLifeVideoImporter::importRlvFiles(const QStringList& rootF
     QCoreApplication::postEvent(this, new NrOfRlvsFoundEvent(rlvFiles.size()));
 
     std::function<RealLifeVideo(const QFileInfo&)> importFunction([this, aviFiles, pgmfFiles](const QFileInfo& fileInfo) -> RealLifeVideo {
+        // this runs on Qt's global thread pool, whose threads are shared with the rest of the application, so they are
+        // not given the background role. Importing is throttled while riding all the same.
+        indoorcycling::beginBackgroundWork();
         QFile file(fileInfo.canonicalFilePath());
-        RealLifeVideo rlv = parseRealLiveVideoFile(file, aviFiles.toList(), pgmfFiles.toList());
+        RealLifeVideo rlv = parseRealLiveVideoFile(file, aviFiles.toList(), pgmfFiles.toList(), _videoProber);
+        indoorcycling::throttleBackgroundWork();
         QCoreApplication::postEvent(this, new RlvImportedEvent);
         return rlv;
     });
@@ -145,7 +151,7 @@ QList<QFileInfo> fromPaths(const QList<QString>& filePaths) {
 }
 
 RealLifeVideo parseRealLiveVideoFile(QFile &rlvFile, const QList<QString>& videoFilePaths,
-                                     const QList<QString>& pgmfFilePaths)
+                                     const QList<QString>& pgmfFilePaths, VideoProber &videoProber)
 {
     QDateTime start = QDateTime::currentDateTime();
     QList<QFileInfo> videoFiles = fromPaths(videoFilePaths);
@@ -160,11 +166,22 @@ RealLifeVideo parseRealLiveVideoFile(QFile &rlvFile, const QList<QString>& video
     } else if (rlvFile.fileName().endsWith(".xml")) {
         rlv = indoorcycling::VirtualTrainingFileParser(videoFiles).parseVirtualTrainingFile(rlvFile);
     } else if (rlvFile.fileName().endsWith(".gpx")) {
-        rlv = indoorcycling::GpxFileParser(videoFiles).parseGpxFile(rlvFile);
+        rlv = indoorcycling::GpxFileParser(videoFiles, videoProber).parseGpxFile(rlvFile);
     }
     if (rlv.isValid()) {
-        // if there was no cache file, create it now.
-        if (!fromCache) {
+        // probe the video if it was not probed before, or if it changed since. Do this before adding the custom
+        // courses, as those should not end up in the cache.
+        const QFileInfo videoFileInfo(rlv.videoFilename());
+        bool probed = false;
+        if (!rlv.videoInformation().isProbedFor(videoFileInfo)) {
+            const VideoInformation videoInformation = videoProber.probe(rlv.videoInformation());
+            if (videoInformation.isProbedFor(videoFileInfo)) {
+                rlv.setVideoInformation(videoInformation);
+                probed = true;
+            }
+        }
+        // if there was no cache file, or the video was probed again, (re)create it now.
+        if (!fromCache || probed) {
             RealLifeVideoCache().save(rlvFile, rlv);
         }
 
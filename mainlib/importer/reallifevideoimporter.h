@@ -26,6 +26,7 @@
 #include <QObject>
 #include <QSharedPointer>
 
+#include "importer/videoprober.h"
 #include "model/reallifevideo.h"
 
 /**
@@ -37,6 +38,9 @@
  * This importer will search for files with the extension .rlv and, for each of those files, find the corresponding
  * .pgmf and .avi file. The result will be a list of RealLifeVideo objects. Only slope-based files will be found,
  * power-based rlv files will be ommitted for now.
+ *
+ * The metadata of the video files, like the number of frames, is probed during the import and stored in the cache
+ * of the RealLifeVideo, so starting a ride does not have to wait for it.
  */
 class RealLifeVideoImporter: public QObject
 {
@@ -72,6 +76,8 @@ protected:
 private:
     RealLifeVideoList importRlvFiles(const QStringList &rootFolders);
     void importReady(const RealLifeVideoList &rlvs);
+
+    VideoProber _videoProber;
 };
 
 #endif // REALLIVEVIDEOPARSER_H
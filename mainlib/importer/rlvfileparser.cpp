@@ -345,7 +345,8 @@ RealLifeVideo RlvFileParser::parseRlvFile(QFile &rlvFile)
 
     std::vector<Course> courses;
     QString name = QFileInfo(rlvFile).baseName();
-    VideoInformation videoInformation(QString("Unknown"), 0.0);
+    QStringList videoFilenames;
+    float frameRate = 0.0;
     std::vector<DistanceMappingEntry> distanceMapping;
     std::vector<tacxfile::informationBox> informationBoxes;
 
@@ -355,9 +356,10 @@ RealLifeVideo RlvFileParser::parseRlvFile(QFile &rlvFile)
         if (infoBlock.fingerprint < 0 || infoBlock.fingerprint > 10000)
             break;
         if (infoBlock.fingerprint == 2010) {
+            // a course that is delivered as several video files has a general block for every file.
             tacxfile::generalRlvBlock generalRlv = readGeneralRlvBlock(rlvFile);
-            QString videoFilename = findVideoFilename(_videoFiles, generalRlv.filename());
-            videoInformation = VideoInformation(videoFilename, generalRlv.frameRate);
+            videoFilenames.append(findVideoFilename(_videoFiles, generalRlv.filename()));
+            frameRate = generalRlv.frameRate;
         }
         else if (infoBlock.fingerprint == 2020) {
             distanceMapping = readFrameDistanceMapping(rlvFile, infoBlock.numberOfRecords);
@@ -373,6 +375,8 @@ RealLifeVideo RlvFileParser::parseRlvFile(QFile &rlvFile)
         }
     }
 
+    const VideoInformation videoInformation = videoFilenames.isEmpty() ? VideoInformation(QString("Unknown"), 0.0) :
+                                                                         VideoInformation(videoFilenames, frameRate);
     QDir infoBoxRootDir = QFileInfo(videoInformation.videoFilename()).dir();
     std::vector<InformationBox> rlvInformationBoxes =
             readInformationBoxesContent(informationBoxes, infoBoxRootDir, name);
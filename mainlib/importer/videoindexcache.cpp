@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videoindexcache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QtDebug>
+
+namespace
+{
+const quint32 INDEX_FILE_MAGIC = 0xC4C1F1D8;
+const quint32 INDEX_FILE_VERSION = 1;
+const int INDEX_FILE_QDATASTREAM_VERSION = QDataStream::Qt_5_14;
+}
+
+std::unique_ptr<VideoIndex> VideoIndexCache::load(const QFileInfo &videoFileInfo)
+{
+    QFile cacheFile(absoluteFilenameForVideo(videoFileInfo));
+    if (!cacheFile.exists()) {
+        qDebug() << "No index file for" << videoFileInfo.fileName();
+        return nullptr;
+    }
+    QFileInfo cacheFileInfo(cacheFile);
+    if (videoFileInfo.lastModified() > cacheFileInfo.lastModified()) {
+        qDebug() << "Index file is stale for" << videoFileInfo.fileName();
+        return nullptr;
+    }
+
+    if (!cacheFile.open(QIODevice::ReadOnly)) {
+        qWarning("Unable to open index file %s: %s", qPrintable(cacheFileInfo.filePath()),
+                 qPrintable(cacheFile.errorString()));
+        return nullptr;
+    }
+    QDataStream in(&cacheFile);
+    in.setVersion(INDEX_FILE_QDATASTREAM_VERSION);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != INDEX_FILE_MAGIC || version != INDEX_FILE_VERSION) {
+        qDebug() << cacheFileInfo.filePath() << "is not a valid Big-Ring index file";
+        return nullptr;
+    }
+
+    qint64 videoFileSize;
+    in >> videoFileSize;
+    if (videoFileSize != videoFileInfo.size()) {
+        qDebug() << "Index file is for a different version of" << videoFileInfo.fileName();
+        return nullptr;
+    }
+
+    quint32 numberOfEntries;
+    in >> numberOfEntries;
+    std::vector<VideoIndexEntry> entries;
+    entries.reserve(numberOfEntries);
+    for (auto i = 0u; i < numberOfEntries; ++i) {
+        qint64 pts, dts, position;
+        bool keyFrame;
+        in >> pts >> dts >> position >> keyFrame;
+        entries.push_back(VideoIndexEntry(pts, dts, position, keyFrame));
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << cacheFileInfo.filePath() << "is truncated";
+        return nullptr;
+    }
+    return std::unique_ptr<VideoIndex>(new VideoIndex(std::move(entries)));
+}
+
+void VideoIndexCache::save(const QFileInfo &videoFileInfo, const VideoIndex &index)
+{
+    save(videoFileInfo, videoFileInfo.size(), index);
+}
+
+void VideoIndexCache::save(const QFileInfo &videoFileInfo, qint64 videoFileSize, const VideoIndex &index)
+{
+    QFile file(absoluteFilenameForVideo(videoFileInfo));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Unable to write index file %s: %s", qPrintable(file.fileName()), qPrintable(file.errorString()));
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(INDEX_FILE_QDATASTREAM_VERSION);
+
+    out << INDEX_FILE_MAGIC << INDEX_FILE_VERSION;
+    out << videoFileSize;
+
+    out << static_cast<quint32>(index.entries().size());
+    for (const VideoIndexEntry &entry: index.entries()) {
+        out << entry.pts() << entry.dts() << entry.position() << entry.isKeyFrame();
+    }
+}
+
+QString VideoIndexCache::absoluteFilenameForVideo(const QFileInfo &videoFileInfo) const
+{
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    }
+    QDir rlvCacheDir = QDir(QString("%1/rlv").arg(path));
+    if (!rlvCacheDir.exists()) {
+        rlvCacheDir.mkpath(".");
+    }
+    // videos in different folders often have the same name, so the name of the cache file includes a hash of the
+    // path of the video.
+    const QString videoPath = videoFileInfo.canonicalFilePath().isEmpty() ?
+                videoFileInfo.absoluteFilePath() : videoFileInfo.canonicalFilePath();
+    const QByteArray pathHash = QCryptographicHash::hash(videoPath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return rlvCacheDir.filePath(QString("%1-%2.vidx").arg(videoFileInfo.fileName())
+                                .arg(QString::fromLatin1(pathHash.left(16))));
+}
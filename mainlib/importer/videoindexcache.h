@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOINDEXCACHE_H
+#define VIDEOINDEXCACHE_H
+
+#include <memory>
+#include <QtCore/QFileInfo>
+
+#include "video/videoindex.h"
+
+/**
+ * A File Cache for VideoIndex objects. Building the index of a video file means reading all packets in the file,
+ * which can take a long time for big files. The index is only built once and stored in the cache, next to the
+ * cached RealLifeVideos.
+ *
+ * A cache file is only used when it's younger than the video file and the size of the video file did not change.
+ * Cache files are named after the video file and a hash of its path, so videos with the same name in different
+ * folders each have their own index.
+ */
+class VideoIndexCache
+{
+public:
+    /** Load the index for \param videoFileInfo from the cache. If there is no valid cache file, an empty
+     * unique_ptr is returned. */
+    std::unique_ptr<VideoIndex> load(const QFileInfo &videoFileInfo);
+    /** Save \param index for \param videoFileInfo to the cache. */
+    void save(const QFileInfo &videoFileInfo, const VideoIndex &index);
+    /**
+     * Save \param index for \param videoFileInfo, for a video file of \param videoFileSize bytes. This is used to
+     * save the index of a file before it is renamed to \param videoFileInfo.
+     */
+    void save(const QFileInfo &videoFileInfo, qint64 videoFileSize, const VideoIndex &index);
+
+private:
+    QString absoluteFilenameForVideo(const QFileInfo &videoFileInfo) const;
+};
+
+#endif // VIDEOINDEXCACHE_H
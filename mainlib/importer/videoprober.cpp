@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videoprober.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtDebug>
+
+#include "util/threadrole.h"
+#include "video/videoinforeader.h"
+
+VideoProber::VideoProber(int maximumThreadCount)
+{
+    _threadPool.setMaxThreadCount(maximumThreadCount);
+}
+
+VideoInformation VideoProber::probe(const VideoInformation &videoInformation)
+{
+    return QtConcurrent::run(&_threadPool, [videoInformation]() {
+        // the pool is our own, so the role stays with its threads.
+        indoorcycling::applyThreadRole(indoorcycling::ThreadRole::BACKGROUND);
+        indoorcycling::beginBackgroundWork();
+        QElapsedTimer timer;
+        timer.start();
+        const VideoInformation probed = VideoInfoReader().probe(videoInformation);
+        qDebug() << "probing" << videoInformation.videoFilename() << "took" << timer.elapsed() << "ms";
+        indoorcycling::throttleBackgroundWork();
+        return probed;
+    }).result();
+}
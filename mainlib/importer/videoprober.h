@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOPROBER_H
+#define VIDEOPROBER_H
+
+#include <QtCore/QThreadPool>
+
+#include "model/videoinformation.h"
+
+/**
+ * Probes video files for their metadata, like the number of frames and the frame rate, on a small pool of threads.
+ * Probing opens the container of a video file, which is mostly waiting for the disk. The videos of a library are
+ * often on the same disk or network share, so only a few videos are probed at the same time.
+ */
+class VideoProber
+{
+public:
+    static const int DEFAULT_MAXIMUM_THREAD_COUNT = 2;
+
+    explicit VideoProber(int maximumThreadCount = DEFAULT_MAXIMUM_THREAD_COUNT);
+
+    /**
+     * Probe the video file of \param videoInformation on the pool, and wait for the result. This can be called from
+     * multiple threads at the same time. See VideoInfoReader::probe().
+     */
+    VideoInformation probe(const VideoInformation &videoInformation);
+
+private:
+    QThreadPool _threadPool;
+};
+
+#endif // VIDEOPROBER_H
@@ -52,7 +52,7 @@ RealLifeVideo VirtualTrainingFileParser::parseVirtualTrainingFile(QFile &inputFi
 RealLifeVideo VirtualTrainingFileParser::parseXml(QXmlStreamReader &reader) const
 {
     QString name;
-    QString videoFilePath;
+    QStringList videoFilePaths;
     float frameRate = 0;
     Profile profile;
     std::vector<Course> courses;
@@ -66,8 +66,9 @@ RealLifeVideo VirtualTrainingFileParser::parseXml(QXmlStreamReader &reader) cons
         if (isElement(currentTokenType, reader, "name")) {
             name = reader.readElementText();
         } else if (isElement(currentTokenType, reader, "video-file-path")) {
+            // a course that is delivered as several video files has an element for every file, in playing order.
             QString videoFileName = reader.readElementText();
-            videoFilePath = findVideoFile(videoFileName);
+            videoFilePaths.append(findVideoFile(videoFileName));
         } else if (isElement(currentTokenType, reader, "framerate")) {
             frameRate = reader.readElementText().toFloat();
         } else if (isElement(currentTokenType, reader, "altitudes")) {
@@ -91,7 +92,7 @@ RealLifeVideo VirtualTrainingFileParser::parseXml(QXmlStreamReader &reader) cons
         // Error handling..?
         return RealLifeVideo();
     }
-    VideoInformation videoInformation(videoFilePath, frameRate);
+    VideoInformation videoInformation(videoFilePaths.isEmpty() ? QStringList(QString()) : videoFilePaths, frameRate);
 
     return RealLifeVideo(name, RealLifeVideoFileType::VIRTUAL_TRAINING, videoInformation,
                          std::move(courses), std::move(distanceMappings), profile,
@@ -22,12 +22,11 @@
 
 #include <QtWidgets/QPushButton>
 
-#include "video/thumbnailer.h"
 #include "generalgui/quantityprinter.h"
 
 CreateNewCourseDialog::CreateNewCourseDialog(RealLifeVideo &rlv, QWidget *parent) :
     QDialog(parent), ui(new Ui::CreateNewCourseDIalog),
-    _thumbnailer(new Thumbnailer(this)), _quantityPrinter(new QuantityPrinter(this)),
+    _quantityPrinter(new QuantityPrinter(this)),
     _rlv(rlv)
 {
     ui->setupUi(this);
@@ -25,7 +25,6 @@
 #include "model/reallifevideo.h"
 
 class QuantityPrinter;
-class Thumbnailer;
 
 namespace Ui {
 class CreateNewCourseDIalog;
@@ -58,7 +57,6 @@ private:
     int distanceInMeters() const;
     void updateUi();
     Ui::CreateNewCourseDIalog *ui;
-    Thumbnailer* _thumbnailer;
     QuantityPrinter* _quantityPrinter;
     RealLifeVideo _rlv;
     int _startDistanceInMeters = 0;
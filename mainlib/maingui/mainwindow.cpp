@@ -26,6 +26,8 @@
 #include <QtCore/QTimer>
 #include <QtCore/QUrl>
 #include <QtWidgets/QAction>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QDesktopWidget>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QProgressDialog>
@@ -40,15 +42,21 @@
 #include "network/versionchecker.h"
 #include "ridegui/run.h"
 #include "ridegui/newvideowidget.h"
+#include "video/proxytranscodingqueue.h"
+#include "video/videoindexer.h"
+#include "video/videopreparer.h"
 
 
-MainWindow::MainWindow(bool showDebugOutput, QWidget *parent) :
+MainWindow::MainWindow(bool showDebugOutput, const QString &videoTimingsFilename, QWidget *parent) :
     QWidget(parent, Qt::Window),
     _antCentralDispatch(new indoorcycling::AntCentralDispatch(this)),
     _menuBar(new QMenuBar),
     _stackedWidget(new QStackedWidget),
     _showDebugOutput(showDebugOutput),
-    _listView(new VideoListView(this))
+    _videoTimingsFilename(videoTimingsFilename),
+    _listView(new VideoListView(this)),
+    _proxyTranscodingQueue(new ProxyTranscodingQueue(this)),
+    _videoPreparer(new VideoPreparer(this))
 {
     Q_INIT_RESOURCE(icons);
     _antCentralDispatch->initialize();
@@ -65,11 +73,17 @@ MainWindow::MainWindow(bool showDebugOutput, QWidget *parent) :
     connect(_listView, &VideoListView::videoSelected, _listView, [=](RealLifeVideo& rlv, int courseNr) {
         startRun(rlv, courseNr);
     });
+    connect(_listView, &VideoListView::proxyRequested, this, &MainWindow::createProxy);
+    connect(_listView, &VideoListView::courseSelected, this, &MainWindow::prepareCourse);
+    connect(_proxyTranscodingQueue, &ProxyTranscodingQueue::proxyFinished, this,
+            [](const RealLifeVideo &rlv, bool success) {
+        qDebug() << "transcoding" << rlv.name() << (success ? "finished" : "failed");
+    });
 }
 
 MainWindow::~MainWindow()
 {
-    // empty
+    VideoIndexer::stopAll();
 }
 
 void MainWindow::keyPressEvent(QKeyEvent *event)
@@ -116,6 +130,10 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
 void MainWindow::importFinished(RealLifeVideoList rlvs)
 {
     _listView->setVideos(rlvs);
+    // thumbnails are made from the previews, so the videos themselves are only decoded for rides.
+    for (const RealLifeVideo &rlv: rlvs) {
+        _proxyTranscodingQueue->enqueuePreview(rlv);
+    }
 }
 
 void MainWindow::removeDisplayMessage()
@@ -223,7 +241,8 @@ void MainWindow::startRun(RealLifeVideo rlv, int courseNr)
 {
     Course course = rlv.courses()[courseNr];
     _run = make_qobject_unique(new Run(_antCentralDispatch, rlv, course));
-    _videoWidget.reset(new NewVideoWidget(_showDebugOutput));
+    _videoWidget.reset(new NewVideoWidget(_showDebugOutput, _videoTimingsFilename));
+    _videoWidget->setVideoPreparer(_videoPreparer);
     _videoWidget->setRealLifeVideo(rlv);
     _videoWidget->setCourseIndex(courseNr);
     _stackedWidget->addWidget(_videoWidget.data());
@@ -273,6 +292,37 @@ void MainWindow::startRun(RealLifeVideo rlv, int courseNr)
     });
 }
 
+/**
+ * Queue creating a proxy of the video of \param rlv. Depending on the settings, the proxy is reduced to the size of
+ * the screen, like videos are when playing them at display resolution.
+ */
+void MainWindow::createProxy(const RealLifeVideo &rlv)
+{
+    QSize maximumFrameSize;
+    if (BigRingSettings().videoProxyQuality() == VideoPlaybackQuality::DISPLAY) {
+        maximumFrameSize = QApplication::desktop()->screenGeometry(this).size() * devicePixelRatio();
+    }
+    _proxyTranscodingQueue->enqueue(rlv, maximumFrameSize);
+}
+
+/**
+ * Let the video preparer open the video of \param rlv and decode the start of course \param courseNr, while the
+ * course is highlighted, so a ride of the course starts without seeking.
+ */
+void MainWindow::prepareCourse(const RealLifeVideo &rlv, int courseNr)
+{
+    if (_run || !rlv.isValid() || courseNr < 0 || static_cast<std::size_t>(courseNr) >= rlv.courses().size()) {
+        return;
+    }
+    // the same size the video player reduces frames to, so it can take over the prepared frames.
+    QSize maximumFrameSize;
+    if (BigRingSettings().videoPlaybackQuality() == VideoPlaybackQuality::DISPLAY) {
+        maximumFrameSize = QApplication::desktop()->screenGeometry(this).size() * devicePixelRatio();
+    }
+    const quint32 startFrame = rlv.frameForDistance(rlv.courses()[courseNr].start());
+    _videoPreparer->prepare(rlv.playbackVideoFilenames(), startFrame, maximumFrameSize);
+}
+
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     // if the user chooses not stop the run, just ignore the event.
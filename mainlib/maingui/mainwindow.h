@@ -33,6 +33,8 @@
 class Cyclist;
 class VideoListView;
 class NewVideoWidget;
+class ProxyTranscodingQueue;
+class VideoPreparer;
 class Run;
 class Simulation;
 
@@ -50,8 +52,9 @@ class MainWindow : public QWidget
 public:
     /** Create a new MainWindow.
      * @param showDebugOutput if true, debug output will be shown in during a ride
+     * @param videoTimingsFilename file to write the latencies of the video pipeline to during a ride, or empty.
      */
-    explicit MainWindow(bool showDebugOutput, QWidget *parent = 0);
+    explicit MainWindow(bool showDebugOutput, const QString &videoTimingsFilename, QWidget *parent = 0);
     ~MainWindow();
 
 protected:
@@ -68,6 +71,8 @@ private slots:
 private:
     void setupMenuBar();
     void startRun(RealLifeVideo rlv, int courseNr);
+    void createProxy(const RealLifeVideo &rlv);
+    void prepareCourse(const RealLifeVideo &rlv, int courseNr);
 
     indoorcycling::AntCentralDispatch* const _antCentralDispatch;
 
@@ -78,8 +83,11 @@ private:
     QAction* _showPreferencesAction;
 
     const bool _showDebugOutput;
+    const QString _videoTimingsFilename;
 
     VideoListView* const _listView;
+    ProxyTranscodingQueue* const _proxyTranscodingQueue;
+    VideoPreparer* const _videoPreparer;
     QScopedPointer<NewVideoWidget> _videoWidget;
     bool _guiFullScreen;
     QRect _savedGeometry;
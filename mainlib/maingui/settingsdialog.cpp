@@ -182,6 +182,9 @@ void SettingsDialog::fillVideoDisplayOptions()
     } else {
         _ui->videoFillScreenOption->setChecked(true);
     }
+    _ui->videoSoftwareRenderingCheckBox->setChecked(_settings.videoSoftwareRendering());
+    _ui->videoDisplayResolutionCheckBox->setChecked(
+                _settings.videoPlaybackQuality() == VideoPlaybackQuality::DISPLAY);
 }
 
 void SettingsDialog::fillWeights()
@@ -354,6 +357,16 @@ void SettingsDialog::on_videoShowWholeVideoOption_toggled(bool checked)
     }
 }
 
+void SettingsDialog::on_videoSoftwareRenderingCheckBox_toggled(bool checked)
+{
+    _settings.setVideoSoftwareRendering(checked);
+}
+
+void SettingsDialog::on_videoDisplayResolutionCheckBox_toggled(bool checked)
+{
+    _settings.setVideoPlaybackQuality(checked ? VideoPlaybackQuality::DISPLAY : VideoPlaybackQuality::FULL);
+}
+
 void SettingsDialog::on_powerForElevationCorrectionSpinBox_valueChanged(int powerForElevationCorrection)
 {
     _settings.setPowerForElevationCorrection(powerForElevationCorrection);
@@ -72,6 +72,10 @@ private slots:
 
     void on_videoShowWholeVideoOption_toggled(bool checked);
 
+    void on_videoSoftwareRenderingCheckBox_toggled(bool checked);
+
+    void on_videoDisplayResolutionCheckBox_toggled(bool checked);
+
     void on_powerForElevationCorrectionSpinBox_valueChanged(int powerForElevationCorrection);
 
     void on_difficultySettingSlider_valueChanged(int value);
@@ -22,6 +22,7 @@
 #include <QtCore/QtDebug>
 #include "createnewcoursedialog.h"
 #include "generalgui/quantityprinter.h"
+#include "model/videoinformation.h"
 
 VideoDetails::VideoDetails(QWidget *parent) :
     QWidget(parent),
@@ -50,6 +51,7 @@ void VideoDetails::setVideo(RealLifeVideo &rlv)
         new QListWidgetItem(course.name(), ui->courseListWidget);
     }
     ui->courseListWidget->setCurrentRow(0);
+    ui->createProxyButton->setEnabled(rlv.isValid() && !rlv.videoInformation().hasProxy());
 }
 
 void VideoDetails::on_startButton_clicked()
@@ -64,6 +66,7 @@ void VideoDetails::on_courseListWidget_currentRowChanged(int currentRow)
     if (currentRow >= 0) {
         ui->videoScreenshotWidget->setDistance(_currentRlv.courses()[currentRow].start());
         qDebug() << "course selected:" << _currentRlv.courses()[currentRow].name();
+        emit courseSelected(_currentRlv, currentRow);
     }
 }
 
@@ -90,3 +93,9 @@ void VideoDetails::on_newCourseButton_clicked()
         ui->courseListWidget->setCurrentRow(0);
     }
 }
+
+void VideoDetails::on_createProxyButton_clicked()
+{
+    ui->createProxyButton->setEnabled(false);
+    emit createProxyClicked(_currentRlv);
+}
@@ -42,6 +42,10 @@ public slots:
     void setVideo(RealLifeVideo& rlv);
 signals:
     void playClicked(RealLifeVideo& rlv, int courseNr);
+    /** Emitted when course \param courseNr of \param rlv is highlighted, so its start can be prepared. */
+    void courseSelected(RealLifeVideo& rlv, int courseNr);
+    /** Emitted when the user wants a proxy of the video of \param rlv, see ProxyTranscoder. */
+    void createProxyClicked(RealLifeVideo& rlv);
 private slots:
     void on_startButton_clicked();
 
@@ -49,6 +53,8 @@ private slots:
 
     void on_newCourseButton_clicked();
 
+    void on_createProxyButton_clicked();
+
 private:
     RealLifeVideo _currentRlv;
     int _courseIndex;
@@ -61,6 +61,8 @@ VideoListView::VideoListView(QWidget *parent) :
     layout->addWidget(_detailsWidget, 3);
 
     connect(_detailsWidget, &VideoDetails::playClicked, this, &VideoListView::videoSelected);
+    connect(_detailsWidget, &VideoDetails::courseSelected, this, &VideoListView::courseSelected);
+    connect(_detailsWidget, &VideoDetails::createProxyClicked, this, &VideoListView::proxyRequested);
     connect(_filterLineEdit, &QLineEdit::textChanged, _filterLineEdit, [=](const QString& text) {
         _filterProxyModel->setFilterRegExp(QRegExp(text, Qt::CaseInsensitive, QRegExp::FixedString));
     });
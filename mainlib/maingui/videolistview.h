@@ -43,6 +43,8 @@ public:
 
 signals:
     void videoSelected(RealLifeVideo& rlv, int courseNr);
+    void courseSelected(RealLifeVideo& rlv, int courseNr);
+    void proxyRequested(RealLifeVideo& rlv);
 
 public slots:
     void setVideos(RealLifeVideoList& rlvs);
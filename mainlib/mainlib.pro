@@ -69,14 +69,18 @@ IMPORTER_HEADERS += \
     importer/virtualtrainingfileparser.h \
     importer/reallifevideocache.h \
     importer/reallifevideoimporter.h \
-    importer/rlvfileparser.h
+    importer/rlvfileparser.h \
+    importer/videoindexcache.h \
+    importer/videoprober.h
 
 IMPORTER_SOURCES += \
     importer/gpxfileparser.cpp \
     importer/virtualtrainingfileparser.cpp \
     importer/reallifevideocache.cpp \
     importer/reallifevideoimporter.cpp \
-    importer/rlvfileparser.cpp
+    importer/rlvfileparser.cpp \
+    importer/videoindexcache.cpp \
+    importer/videoprober.cpp
 
 MAINGUI_HEADERS +=\
     maingui/addsensorconfigurationdialog.h \
@@ -180,30 +184,71 @@ RIDEGUI_SOURCES += \
     ridegui/sensoritem.cpp
 
 UTIL_HEADERS += \
+    util/cputime.h \
+    util/instructionset.h \
     util/screensaverblocker.h \
+    util/threadrole.h \
     util/util.h
 
 UTIL_SOURCES += \
-    util/screensaverblocker.cpp
+    util/cputime.cpp \
+    util/instructionset.cpp \
+    util/screensaverblocker.cpp \
+    util/threadrole.cpp
 
 VIDEO_HEADERS += \
-    video/framebuffer.h \
+    video/demuxer.h \
+    video/frameblender.h \
+    video/frameformat.h \
+    video/framering.h \
+    video/frameslotring.h \
     video/genericvideoreader.h \
     video/openglpainter2.h \
+    video/pipelinetimings.h \
+    video/proxytranscoder.h \
+    video/proxytranscodingqueue.h \
+    video/readaheadcontroller.h \
+    video/softwarepainter.h \
     video/thumbnailcreatingvideoreader.h \
+    video/throttledfile.h \
     video/framecopyingvideoreader.h \
     video/thumbnailer.h \
+    video/videofilesource.h \
+    video/videoindex.h \
+    video/videoindexer.h \
     video/videoinforeader.h \
-    video/videoplayer.h
+    video/videopainter.h \
+    video/videoplayer.h \
+    video/videopreparer.h \
+    video/videosegment.h \
+    video/yuvtorgbconverter.h
 
 VIDEO_SOURCES += \
+    video/demuxer.cpp \
+    video/frameblender.cpp \
+    video/frameformat.cpp \
+    video/framering.cpp \
+    video/frameslotring.cpp \
     video/genericvideoreader.cpp \
     video/openglpainter2.cpp \
+    video/pipelinetimings.cpp \
+    video/proxytranscoder.cpp \
+    video/proxytranscodingqueue.cpp \
+    video/readaheadcontroller.cpp \
+    video/softwarepainter.cpp \
     video/thumbnailcreatingvideoreader.cpp \
+    video/throttledfile.cpp \
     video/framecopyingvideoreader.cpp \
     video/thumbnailer.cpp \
+    video/videofilesource.cpp \
+    video/videoindex.cpp \
+    video/videoindexer.cpp \
     video/videoinforeader.cpp \
-    video/videoplayer.cpp
+    video/videopainter.cpp \
+    video/videoplayer.cpp \
+    video/videopreparer.cpp \
+    video/videosegment.cpp \
+    video/yuvtorgbconverter.cpp
 
 
 HEADERS += \
@@ -99,6 +99,9 @@ RealLifeVideo::RealLifeVideo(const QString &name, RealLifeVideoFileType fileType
                                                  [](const GeoPosition &position) {
         return position.distance();
     });
+    if (videoInformation.numberOfFrames() > 0) {
+        setNumberOfFrames(static_cast<quint64>(videoInformation.numberOfFrames()));
+    }
 }
 
 RealLifeVideo::RealLifeVideo(const RealLifeVideo &other):
@@ -115,7 +118,9 @@ RealLifeVideo::RealLifeVideo():
 
 bool RealLifeVideo::isValid() const
 {
-    return (!_d->_name.isEmpty() && !_d->_videoInformation.videoFilename().isEmpty());
+    // all video files of a video that consists of several video files have to be present.
+    return (!_d->_name.isEmpty() && !_d->_videoInformation.videoFilename().isEmpty() &&
+            !_d->_videoInformation.videoFilenames().contains(QString()));
 }
 
 RealLifeVideoFileType RealLifeVideo::fileType() const
@@ -143,11 +148,37 @@ const QString &RealLifeVideo::videoFilename() const
     return _d->_videoInformation.videoFilename();
 }
 
+const QStringList &RealLifeVideo::videoFilenames() const
+{
+    return _d->_videoInformation.videoFilenames();
+}
+
+QStringList RealLifeVideo::playbackVideoFilenames() const
+{
+    if (_d->_videoInformation.hasProxy()) {
+        return QStringList(_d->_videoInformation.proxyVideoFilename());
+    }
+    return _d->_videoInformation.videoFilenames();
+}
+
 float RealLifeVideo::videoFrameRate() const
 {
     return _d->_videoInformation.frameRate();
 }
 
+const VideoInformation &RealLifeVideo::videoInformation() const
+{
+    return _d->_videoInformation;
+}
+
+void RealLifeVideo::setVideoInformation(const VideoInformation &videoInformation)
+{
+    _d->_videoInformation = videoInformation;
+    if (videoInformation.numberOfFrames() > 0) {
+        setNumberOfFrames(static_cast<quint64>(videoInformation.numberOfFrames()));
+    }
+}
+
 const std::vector<Course> &RealLifeVideo::courses() const
 {
     return _d->_courses;
@@ -197,7 +228,13 @@ float RealLifeVideo::metersPerFrame(const float distance) const
 
 quint32 RealLifeVideo::frameForDistance(const float distance) const
 {
-    float correctedDistance = distance * _d->_videoCorrectionFactor;
+    // the same calculation as the frame position, so the frame is never one off from it because of float rounding.
+    return static_cast<quint32>(framePositionForDistance(distance));
+}
+
+qreal RealLifeVideo::framePositionForDistance(const float distance) const
+{
+    const qreal correctedDistance = distance * _d->_videoCorrectionFactor;
     const DistanceMappingEntry& entry = findDistanceMappingEntryFor(correctedDistance);
     return entry.frameNumber() + (correctedDistance - entry.distance()) / entry.metersPerFrame();
 }
@@ -114,7 +114,20 @@ public:
     const Profile &profile() const;
     const QString name() const;
     const QString &videoFilename() const;
+    /** the video files of the video, in the order they are played. Most videos consist of a single file. */
+    const QStringList &videoFilenames() const;
+    /**
+     * the video files that are used for playback and thumbnails. This is the proxy of the video if there is an
+     * up-to-date one, as it seeks faster, and the video files of the video otherwise.
+     */
+    QStringList playbackVideoFilenames() const;
     float videoFrameRate() const;
+    const VideoInformation &videoInformation() const;
+    /**
+     * Replace the information about the video, for instance after probing the video file. If the number of frames is
+     * known, the distances are corrected for it, see setNumberOfFrames().
+     */
+    void setVideoInformation(const VideoInformation &videoInformation);
     const std::vector<Course>& courses() const;
     const std::vector<DistanceMappingEntry> &distanceMappings() const;
     const std::vector<InformationBox> &informationBoxes() const;
@@ -131,6 +144,8 @@ public:
     float metersPerFrame(const float distance) const;
     /** Get the exact frame for a distance. */
     quint32 frameForDistance(const float distance) const;
+    /** Get the position in the video for a distance, in frames, including the fraction of the next frame. */
+    qreal framePositionForDistance(const float distance) const;
     /** Get the slope for a distance */
     float slopeForDistance(const float distance) const;
     //! Get the altitude for a distance */
@@ -20,9 +20,16 @@
 
 #include <QtDebug>
 #include "simulation.h"
+#include "util/cputime.h"
 #include <math.h>
 namespace {
 
+const int UPDATE_INTERVAL_MILLISECONDS = 1000 / 30;
+/** interval of the steps while the cyclist stands still, with energy saving. */
+const int IDLE_UPDATE_INTERVAL_MILLISECONDS = 250;
+/** below this time of riding, the cpu time per minute says more about loading the video than about riding. */
+const qint64 MINIMUM_RIDDEN_MILLISECONDS_FOR_CPU_TIME = 10000;
+
 /** Frontal area of a cyclist is around .5 m*m */
 const float FRONTAL_AREA = 0.58f;
 const float DRAG_COEFFICIENT = 0.63f;
@@ -61,7 +68,7 @@ Simulation::Simulation(SimulationSetting simulationSetting, Cyclist &cyclist, do
     QObject(parent), _simulationSetting(simulationSetting),
     _lastElapsed(0), _simulationTime(0,0,0), _idleTime(),_cyclist(cyclist), _powerForElevationCorrection(powerForElevationCorrection)
 {
-    _simulationUpdateTimer.setInterval(1000 / 30);
+    _simulationUpdateTimer.setInterval(UPDATE_INTERVAL_MILLISECONDS);
     connect(&_simulationUpdateTimer, SIGNAL(timeout()), SLOT(simulationStep()));
 }
 
@@ -85,14 +92,43 @@ QTime Simulation::runTime() const
     return _runTime;
 }
 
+void Simulation::setEnergySaving(bool energySaving)
+{
+    _energySaving = energySaving;
+    if (!_energySaving) {
+        _simulationUpdateTimer.setInterval(UPDATE_INTERVAL_MILLISECONDS);
+    }
+}
+
+qreal Simulation::cpuSecondsPerRiddenMinute() const
+{
+    const qint64 riddenMilliseconds = QTime(0, 0, 0).msecsTo(_runTime);
+    const qint64 cpuMilliseconds = indoorcycling::processCpuTimeMilliseconds();
+    if (cpuMilliseconds < 0 || riddenMilliseconds < MINIMUM_RIDDEN_MILLISECONDS_FOR_CPU_TIME) {
+        return -1;
+    }
+    qint64 playedCpuMilliseconds = _playedCpuMilliseconds;
+    if (_cpuMillisecondsAtPlay >= 0) {
+        playedCpuMilliseconds += cpuMilliseconds - _cpuMillisecondsAtPlay;
+    }
+    return playedCpuMilliseconds * 0.001 / (riddenMilliseconds / 60000.0);
+}
+
 void Simulation::play(bool play)
 {
     if (play) {
+        if (_cpuMillisecondsAtPlay < 0) {
+            _cpuMillisecondsAtPlay = indoorcycling::processCpuTimeMilliseconds();
+        }
         _simulationUpdateTimer.start();
         _simulationTime.restart();
         _lastElapsed = 0;
     } else {
         _simulationUpdateTimer.stop();
+        if (_cpuMillisecondsAtPlay >= 0) {
+            _playedCpuMilliseconds += indoorcycling::processCpuTimeMilliseconds() - _cpuMillisecondsAtPlay;
+            _cpuMillisecondsAtPlay = -1;
+        }
     }
     emit playing(play);
 }
@@ -119,6 +155,12 @@ void Simulation::simulationStep()
     _cyclist.setAltitude(_currentRlv.altitudeForDistance(_cyclist.distance()));
     _cyclist.setGeoPosition(_currentRlv.positionForDistance(_cyclist.distance()));
 
+    if (_energySaving) {
+        const int interval = (speed > 0) ? UPDATE_INTERVAL_MILLISECONDS : IDLE_UPDATE_INTERVAL_MILLISECONDS;
+        if (_simulationUpdateTimer.interval() != interval) {
+            _simulationUpdateTimer.setInterval(interval);
+        }
+    }
 
     emit slopeChanged(_currentRlv.slopeForDistance(_cyclist.distance()));
 }
@@ -214,6 +256,7 @@ void Simulation::reset()
 {
     play(false);
     _runTime = QTime(0, 0, 0);
+    _playedCpuMilliseconds = 0;
     emit runTimeChanged(_runTime);
     _cyclist.setSpeed(0);
     _cyclist.setDistance(0);
@@ -47,6 +47,19 @@ public:
     Cyclist& cyclist() const;
     bool isPlaying() const;
     QTime runTime() const;
+    /**
+     * Set whether the simulation saves energy, by stepping only a few times per second while the cyclist stands
+     * still. Steps are only needed to notice that the cyclist starts riding then.
+     */
+    void setEnergySaving(bool energySaving);
+    /**
+     * The cpu time the program used while the ride was playing, in seconds per minute of riding. This is the cpu time
+     * of the whole process, so it includes work on other threads, like transcoding proxies or indexing videos. Cpu
+     * time while paused is not counted. Time the cyclist stood still is not counted as riding, but the cpu time used
+     * in it is.
+     * @return the cpu time per minute, or -1 if the cpu time is not known or the cyclist rode too short to tell.
+     */
+    qreal cpuSecondsPerRiddenMinute() const;
 signals:
     void slopeChanged(float slope);
     void runTimeChanged(QTime& runTime);
@@ -81,6 +94,11 @@ private:
     const double _powerForElevationCorrection;
     RealLifeVideo _currentRlv;
     QTimer _simulationUpdateTimer;
+    bool _energySaving = false;
+    /** cpu time of the program when the ride started playing, or -1 while it is not playing. */
+    qint64 _cpuMillisecondsAtPlay = -1;
+    /** cpu time of the program in the stretches that the ride played, before the current one. */
+    qint64 _playedCpuMilliseconds = 0;
 };
 
 #endif // SIMULATION_H
@@ -1,7 +1,15 @@
 #include "videoinformation.h"
 
+#include <QtCore/QDir>
+
 VideoInformation::VideoInformation(const QString &videoFilename, float frameRate):
-    _videoFilename(videoFilename), _frameRate(frameRate)
+    VideoInformation(QStringList(videoFilename), frameRate)
+{
+    // empty
+}
+
+VideoInformation::VideoInformation(const QStringList &videoFilenames, float frameRate):
+    _videoFilename(videoFilenames.value(0)), _videoFilenames(videoFilenames), _frameRate(frameRate)
 {
     // empty
 }
@@ -12,3 +20,46 @@ VideoInformation::VideoInformation():
     // empty
 }
 
+void VideoInformation::setProbedMetadata(qint64 numberOfFrames, const QSize &frameSize, const QString &pixelFormat,
+                                         qint64 fileSize, const QDateTime &lastModified)
+{
+    _numberOfFrames = numberOfFrames;
+    _frameSize = frameSize;
+    _pixelFormat = pixelFormat;
+    _fileSize = fileSize;
+    _lastModified = lastModified;
+}
+
+bool VideoInformation::isProbedFor(const QFileInfo &videoFileInfo) const
+{
+    return _numberOfFrames > 0 && videoFileInfo.exists() && _fileSize == videoFileInfo.size() &&
+            _lastModified == videoFileInfo.lastModified();
+}
+
+QString VideoInformation::proxyVideoFilename() const
+{
+    if (_videoFilename.isEmpty()) {
+        return QString();
+    }
+    const QFileInfo videoFileInfo(_videoFilename);
+    return videoFileInfo.dir().absoluteFilePath(QString("%1.proxy.mkv").arg(videoFileInfo.completeBaseName()));
+}
+
+bool VideoInformation::hasProxy() const
+{
+    return isUpToDate(proxyVideoFilename());
+}
+
+bool VideoInformation::isUpToDate(const QString &derivedFilename) const
+{
+    const QFileInfo derivedFileInfo(derivedFilename);
+    if (_videoFilename.isEmpty() || derivedFilename.isEmpty() || !derivedFileInfo.exists()) {
+        return false;
+    }
+    for (const QString &videoFilename: _videoFilenames) {
+        if (QFileInfo(videoFilename).lastModified() > derivedFileInfo.lastModified()) {
+            return false;
+        }
+    }
+    return true;
+}
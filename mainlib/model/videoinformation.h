@@ -1,19 +1,74 @@
 #ifndef VIDEOINFORMATION_H
 #define VIDEOINFORMATION_H
 
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSize>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
+/**
+ * Information about the video of a RealLifeVideo. The metadata of the video file, like the number of frames, is
+ * probed when importing and kept in the RealLifeVideoCache, together with the size and modification time of the video
+ * file, so it is known whether the metadata is still valid.
+ */
 class VideoInformation
 {
 public:
     explicit VideoInformation(const QString &videoFilename, float frameRate);
+    /** Information about a video that consists of several consecutive video files, in the order they are played. */
+    explicit VideoInformation(const QStringList &videoFilenames, float frameRate);
     explicit VideoInformation();
 
+    /** the (first) video file of the video */
     const QString &videoFilename() const { return _videoFilename; }
+    /** all video files of the video. Long courses are sometimes delivered as several consecutive video files. */
+    const QStringList &videoFilenames() const { return _videoFilenames; }
     float frameRate() const { return _frameRate; }
+    /** the number of frames of the video, or 0 if the video was not probed */
+    qint64 numberOfFrames() const { return _numberOfFrames; }
+    const QSize &frameSize() const { return _frameSize; }
+    /** name of the pixel format of the frames, as libav names it */
+    const QString &pixelFormat() const { return _pixelFormat; }
+    /** size of the video file when it was probed, or -1 if it was not probed */
+    qint64 fileSize() const { return _fileSize; }
+    /** modification time of the video file when it was probed */
+    const QDateTime &lastModified() const { return _lastModified; }
+
+    /**
+     * Set the metadata that was probed from the video file.
+     * @param fileSize the size of the video file when it was probed.
+     * @param lastModified the modification time of the video file when it was probed.
+     */
+    void setProbedMetadata(qint64 numberOfFrames, const QSize &frameSize, const QString &pixelFormat,
+                           qint64 fileSize, const QDateTime &lastModified);
+    /**
+     * true if the metadata was probed from \param videoFileInfo, the first video file, and the file did not change
+     * since.
+     */
+    bool isProbedFor(const QFileInfo &videoFileInfo) const;
+
+    /**
+     * the file name of the proxy of the video, a copy that is re-encoded so it can be seeked quickly. The proxy is
+     * written beside the (first) video file. See ProxyTranscoder.
+     */
+    QString proxyVideoFilename() const;
+    /** true if there is a proxy of the video that is up to date, see isUpToDate(). */
+    bool hasProxy() const;
+    /**
+     * true if \param derivedFilename, a file that was made from the video, like a proxy, exists and was written after
+     * all video files were last changed.
+     */
+    bool isUpToDate(const QString &derivedFilename) const;
 
 private:
     QString _videoFilename;
+    QStringList _videoFilenames;
     float _frameRate;
+    qint64 _numberOfFrames = 0;
+    QSize _frameSize;
+    QString _pixelFormat;
+    qint64 _fileSize = -1;
+    QDateTime _lastModified;
 };
 #endif // VIDEOINFORMATION_H
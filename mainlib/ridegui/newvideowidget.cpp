@@ -28,7 +28,9 @@
 #include <QtCore/QUrl>
 #include <QtOpenGL/QGLWidget>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QGraphicsTextItem>
 #include <QtWidgets/QGraphicsDropShadowEffect>
+#include <QtGui/QFont>
 #include <QtGui/QResizeEvent>
 
 
@@ -44,15 +46,17 @@
 #include "video/videoplayer.h"
 
 
-NewVideoWidget::NewVideoWidget(bool showDebugOutput, QWidget *parent) :
+NewVideoWidget::NewVideoWidget(bool showDebugOutput, const QString &videoTimingsFilename, QWidget *parent) :
     QGraphicsView(parent),
     _screenSaverBlocker(new indoorcycling::ScreenSaverBlocker(this)),
     _mouseIdleTimer(new QTimer(this))
 {
     setMinimumSize(800, 600);
     setFocusPolicy(Qt::StrongFocus);
-    QGLWidget* viewPortWidget = new QGLWidget(QGLFormat(QGL::SampleBuffers));
-    setViewport(viewPortWidget);
+    // with software rendering, the default viewport is used, so OpenGL is not used at all.
+    if (!BigRingSettings().videoSoftwareRendering()) {
+        setViewport(new QGLWidget(QGLFormat(QGL::SampleBuffers)));
+    }
     setFrameShape(QFrame::NoFrame);
 
     setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
@@ -77,7 +81,14 @@ NewVideoWidget::NewVideoWidget(bool showDebugOutput, QWidget *parent) :
     _frameRateItem->setVisible(showDebugOutput);
     scene->addItem(_frameRateItem);
 
-    setupVideoPlayer(viewPortWidget);
+    _pipelineTimingsItem = new QGraphicsTextItem;
+    _pipelineTimingsItem->setFont(QFont("Liberation Mono", 10));
+    _pipelineTimingsItem->setDefaultTextColor(Qt::white);
+    _pipelineTimingsItem->setVisible(showDebugOutput);
+    scene->addItem(_pipelineTimingsItem);
+
+    setupVideoPlayer(viewport());
+    _videoPlayer->setTimingsFilename(videoTimingsFilename);
 
     _mouseIdleTimer->setInterval(500);
     _mouseIdleTimer->setSingleShot(true);
@@ -87,17 +98,23 @@ NewVideoWidget::NewVideoWidget(bool showDebugOutput, QWidget *parent) :
     _aspectRatioMode = BigRingSettings().videoAspectRatio();
 }
 
-void NewVideoWidget::setupVideoPlayer(QGLWidget* paintWidget)
+void NewVideoWidget::setupVideoPlayer(QWidget* paintWidget)
 {
     _videoPlayer = new VideoPlayer(paintWidget, this);
 
     connect(_videoPlayer, &VideoPlayer::videoLoaded, this, [this](qint64 numberOfFrames) {
         qDebug() << "total number of frames" << numberOfFrames;
         this->_rlv.setNumberOfFrames(numberOfFrames);
-        if (this->_course.isValid()) {
+        // the start frame was determined with the number of frames probed during the import. Only seek again if
+        // the frame count of the opened video moved it.
+        if (this->_course.isValid() && this->_rlv.frameForDistance(_course.start()) != _startFrame) {
             this->seekToStart(_course);
         }
     });
+    connect(_videoPlayer, &VideoPlayer::preloadProgress, this, [this](int percentage) {
+        this->setMessagePanelText(tr("Loading video %1%").arg(percentage));
+        this->_messagePanelItem->setOpacity(1.0);
+    });
     connect(_videoPlayer, &VideoPlayer::seekDone, this, [this]() {
         emit readyToPlay(true);
     });
@@ -107,6 +124,15 @@ void NewVideoWidget::setupVideoPlayer(QGLWidget* paintWidget)
     connect(_videoPlayer, &VideoPlayer::frameRateChanged, this, [this](const int frameRate) {
         this->_frameRateItem->setValue(frameRate);
     });
+    connect(_videoPlayer, &VideoPlayer::pipelineTimingsChanged, this, [this](const QString &summary) {
+        const qreal cpuSecondsPerMinute = (_simulation) ? _simulation->cpuSecondsPerRiddenMinute() : -1;
+        if (cpuSecondsPerMinute >= 0) {
+            this->_pipelineTimingsItem->setPlainText(summary + QString("cpu %1 s per ridden minute\n")
+                                                     .arg(cpuSecondsPerMinute, 0, 'f', 1));
+        } else {
+            this->_pipelineTimingsItem->setPlainText(summary);
+        }
+    });
 }
 
 void NewVideoWidget::addClock(QGraphicsScene* scene)
@@ -137,18 +163,25 @@ bool NewVideoWidget::handleKeyPress(QKeyEvent *event)
     switch(event->key()) {
     case Qt::Key_D:
         _frameRateItem->setVisible(!_frameRateItem->isVisible());
+        _pipelineTimingsItem->setVisible(_frameRateItem->isVisible());
         return true;
     }
     return false;
 }
 
+void NewVideoWidget::setVideoPreparer(VideoPreparer *videoPreparer)
+{
+    _videoPlayer->setVideoPreparer(videoPreparer);
+}
+
 void NewVideoWidget::setRealLifeVideo(RealLifeVideo rlv)
 {
     Q_EMIT(readyToPlay(false));
     _rlv = rlv;
     _profileItem->setRlv(rlv);
     _videoPlayer->stop();
-    _videoPlayer->loadVideo(rlv.videoFilename());
+    _startFrame = -1;
+    _videoPlayer->loadVideo(rlv.playbackVideoFilenames());
 }
 
 void NewVideoWidget::setCourse(Course &course)
@@ -169,7 +202,8 @@ void NewVideoWidget::setCourseIndex(int index)
 
 void NewVideoWidget::setDistance(float distance)
 {
-    _videoPlayer->stepToFrame(_rlv.frameForDistance(distance));
+    _videoPlayer->setMetersPerFrame(_rlv.metersPerFrame(distance));
+    _videoPlayer->stepToFramePosition(_rlv.framePositionForDistance(distance));
 }
 
 void NewVideoWidget::displayMessage(const QString &message)
@@ -181,19 +215,24 @@ void NewVideoWidget::displayMessage(const QString &message)
         animation->setEndValue(0.0);
         animation->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        _messagePanelItem->setMessage(message);
-        QRectF rect = _messagePanelItem->boundingRect();
-        rect.moveCenter(QPointF(sceneRect().width() / 2, sceneRect().height() / 2));
-        _messagePanelItem->setPos(rect.topLeft());
+        setMessagePanelText(message);
         QPropertyAnimation *animation = new QPropertyAnimation(_messagePanelItem, "opacity", this);
         animation->setDuration(1000);
         animation->setStartValue(0.0);
         animation->setEndValue(1.0);
         animation->start(QAbstractAnimation::DeleteWhenStopped);
-        _messagePanelItem->show();
     }
 }
 
+void NewVideoWidget::setMessagePanelText(const QString &message)
+{
+    _messagePanelItem->setMessage(message);
+    QRectF rect = _messagePanelItem->boundingRect();
+    rect.moveCenter(QPointF(sceneRect().width() / 2, sceneRect().height() / 2));
+    _messagePanelItem->setPos(rect.topLeft());
+    _messagePanelItem->show();
+}
+
 void NewVideoWidget::displayInformationBox(const InformationBox &informationBox)
 {
     InformationBoxGraphicsItem *informationBoxItem = new InformationBoxGraphicsItem(this);
@@ -222,6 +261,7 @@ void NewVideoWidget::displayInformationBox(const InformationBox &informationBox)
 
 void NewVideoWidget::setSimulation(const Simulation& simulation)
 {
+    _simulation = &simulation;
     connect(&simulation, &Simulation::runTimeChanged, _clockItem, &ClockGraphicsItem::setTime);
 
     const Cyclist& cyclist = simulation.cyclist();
@@ -235,6 +275,7 @@ void NewVideoWidget::setSimulation(const Simulation& simulation)
     connect(&cyclist, &Cyclist::speedChanged, this, [this](float speed) {
         _speedItem->setValue(QVariant::fromValue(speed));
     });
+    connect(&cyclist, &Cyclist::speedChanged, _videoPlayer, &VideoPlayer::setSpeed);
     connect(&simulation, &Simulation::slopeChanged, this, [this](float grade) {
         _gradeItem->setValue(QVariant::fromValue(grade));
     });
@@ -279,6 +320,8 @@ void NewVideoWidget::resizeEvent(QResizeEvent *resizeEvent)
     _profileItem->setGeometry(QRectF(profileItemLeft, profileItemTop, profileItemWidth, bottom - profileItemTop));
 
     _frameRateItem->setPos(mapToScene(0, 0));
+    _pipelineTimingsItem->setPos(_frameRateItem->scenePos().x(),
+                                 _frameRateItem->scenePos().y() + _frameRateItem->boundingRect().height());
 
     resizeEvent->accept();
 }
@@ -324,7 +367,9 @@ void NewVideoWidget::drawBackground(QPainter *painter, const QRectF &)
 void NewVideoWidget::seekToStart(Course &course)
 {
     quint32 frame = _rlv.frameForDistance(course.start());
-    _videoPlayer->seekToFrame(frame);
+    if (_videoPlayer->seekToFrame(frame)) {
+        _startFrame = frame;
+    }
 }
 
 void NewVideoWidget::addSensorItems(QGraphicsScene *scene)
@@ -31,6 +31,7 @@
 
 class Simulation;
 class VideoPlayer;
+class VideoPreparer;
 
 namespace indoorcycling {
 class ScreenSaverBlocker;
@@ -49,9 +50,10 @@ public:
     /**
      * Create a new NewVideoWidget.
      * @param showDebugOutput if true, debug output is shown during the ride.
+     * @param videoTimingsFilename file to write the latencies of the video pipeline to, or empty.
      * @param parent parent widget.
      */
-    explicit NewVideoWidget(bool showDebugOutput, QWidget *parent = 0);
+    explicit NewVideoWidget(bool showDebugOutput, const QString &videoTimingsFilename, QWidget *parent = 0);
     ~NewVideoWidget();
 
     bool isReadyToPlay();
@@ -60,6 +62,12 @@ public:
 signals:
     void readyToPlay(bool ready);
 
+    /**
+     * Let the video player take over the video \param videoPreparer prepared, see VideoPlayer::setVideoPreparer. Call
+     * this before setRealLifeVideo.
+     */
+    void setVideoPreparer(VideoPreparer *videoPreparer);
+
 public slots:
     void setRealLifeVideo(RealLifeVideo rlv);
     void setCourse(Course& course);
@@ -79,7 +87,7 @@ protected:
     virtual void drawBackground(QPainter *painter, const QRectF &rect) override;
 
 private:
-    void setupVideoPlayer(QGLWidget* paintWidget);
+    void setupVideoPlayer(QWidget* paintWidget);
 
     void seekToStart(Course& course);
     void step(int stepSize);
@@ -88,10 +96,16 @@ private:
 
     void addClock(QGraphicsScene* scene);
     void addMessagePanel(QGraphicsScene *scene);
+    /** Show \param message in the center of the message panel, without fading it in. */
+    void setMessagePanelText(const QString &message);
 
     RealLifeVideo _rlv;
     Course _course;
+    /** frame seekToStart last sent the video player to, or -1 if it did not seek since the video was set. */
+    qint64 _startFrame = -1;
     VideoPlayer* _videoPlayer;
+    /** the simulation of the ride, or nullptr before the ride is set. */
+    const Simulation *_simulation = nullptr;
 
     ClockGraphicsItem* _clockItem;
     MessagePanelItem *_messagePanelItem;
@@ -105,6 +119,8 @@ private:
     SensorItem* _gradeItem;
     ProfileItem* _profileItem;
     SensorItem *_frameRateItem;
+    /** shows the latencies of the video pipeline, together with the frame rate */
+    QGraphicsTextItem *_pipelineTimingsItem;
     indoorcycling::ScreenSaverBlocker* _screenSaverBlocker;
     QTimer* _mouseIdleTimer;
     Qt::AspectRatioMode _aspectRatioMode;
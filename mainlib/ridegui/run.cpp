@@ -27,6 +27,7 @@
 #include "ride/actuators.h"
 #include "ride/ridefilewriter.h"
 #include "ride/sensors.h"
+#include "util/threadrole.h"
 
 #include <QtCore/QTimer>
 #include <QtCore/QtDebug>
@@ -41,6 +42,8 @@ using indoorcycling::Sensors;
 Run::Run(indoorcycling::AntCentralDispatch *antCentralDispatch, RealLifeVideo& rlv, Course& course, QObject* parent) :
     QObject(parent), _antCentralDispatch(antCentralDispatch), _rlv(rlv), _course(course), _state(State::BEFORE_START)
 {
+    // background work like making thumbnails and importing is throttled while riding.
+    indoorcycling::beginRide();
     BigRingSettings settings;
    _cyclist = new Cyclist(settings.userWeight(), settings.bikeWeight(), this);
 
@@ -52,6 +55,7 @@ Run::Run(indoorcycling::AntCentralDispatch *antCentralDispatch, RealLifeVideo& r
 
     const int powerForElevationCorrectionPercentage = settings.powerForElevationCorrection();
    _simulation = new Simulation(sensorConfigurationGroup.simulationSetting(), *_cyclist, powerForElevationCorrectionPercentage * 0.01, this);
+    _simulation->setEnergySaving(settings.videoEnergySaving());
 
     _simulation->rlvSelected(rlv);
     _simulation->courseSelected(course);
@@ -86,6 +90,7 @@ Run::Run(indoorcycling::AntCentralDispatch *antCentralDispatch, RealLifeVideo& r
 
 Run::~Run()
 {
+    indoorcycling::endRide();
     _antCentralDispatch->closeAllChannels();
 }
 
@@ -115,6 +120,10 @@ void Run::play()
 void Run::stop()
 {
     _simulation->play(false);
+    const qreal cpuSecondsPerMinute = _simulation->cpuSecondsPerRiddenMinute();
+    if (cpuSecondsPerMinute >= 0) {
+        qDebug() << "ride used" << cpuSecondsPerMinute << "seconds of cpu time per ridden minute";
+    }
     _actuators->setSlope(0.0);
     emit stopped();
 }
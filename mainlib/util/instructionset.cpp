@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "instructionset.h"
+
+namespace indoorcycling
+{
+
+bool isSupported(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+#ifdef BIGRING_X86_SIMD
+    case InstructionSet::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case InstructionSet::SSE2:
+        return __builtin_cpu_supports("sse2");
+#endif
+    case InstructionSet::SCALAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+InstructionSet bestSupportedInstructionSet()
+{
+    if (isSupported(InstructionSet::AVX2)) {
+        return InstructionSet::AVX2;
+    }
+    if (isSupported(InstructionSet::SSE2)) {
+        return InstructionSet::SSE2;
+    }
+    return InstructionSet::SCALAR;
+}
+
+QString instructionSetName(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case InstructionSet::AVX2:
+        return "AVX2";
+    case InstructionSet::SSE2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+QList<InstructionSet> allInstructionSets()
+{
+    return { InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2 };
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INSTRUCTIONSET_H
+#define INSTRUCTIONSET_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+// SIMD kernels are compiled with function specific target attributes, so the rest of the program does not need to
+// be built for a newer cpu. The instruction set to use is chosen at runtime.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BIGRING_X86_SIMD
+#endif
+
+namespace indoorcycling
+{
+
+/** The SIMD instruction sets that are used by the video code. */
+enum class InstructionSet {
+    SCALAR, SSE2, AVX2
+};
+
+/** Check if \param instructionSet is supported by the cpu, and by this build. */
+bool isSupported(InstructionSet instructionSet);
+/** The best instruction set supported by the cpu, and by this build. */
+InstructionSet bestSupportedInstructionSet();
+QString instructionSetName(InstructionSet instructionSet);
+/** All instruction sets, from the simplest to the most advanced. */
+QList<InstructionSet> allInstructionSets();
+
+}
+
+#endif // INSTRUCTIONSET_H
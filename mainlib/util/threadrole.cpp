@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "threadrole.h"
+
+#include <atomic>
+#include <chrono>
+
+#include <QtCore/QtDebug>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::atomic<bool> cpuAffinityEnabled(false);
+std::atomic<bool> realtimeSchedulingEnabled(false);
+std::atomic<int> activeRides(0);
+
+thread_local indoorcycling::ThreadRole currentRole = indoorcycling::ThreadRole::INTERACTIVE;
+thread_local bool roleApplied = false;
+thread_local std::chrono::steady_clock::time_point lastBackgroundWork;
+
+// background work sleeps four times as long as it worked, so it uses at most a fifth of a core while riding.
+const int BACKGROUND_SLEEP_PER_WORK_WHILE_RIDING = 4;
+// work after a long idle period should not make a thread sleep for long.
+const qint64 MAXIMUM_BACKGROUND_SLEEP_MILLISECONDS = 1000;
+
+#ifdef Q_OS_LINUX
+const int RIDE_CRITICAL_NICE = -5;
+const int BACKGROUND_NICE = 10;
+// low enough to stay below the kernel's own real-time threads.
+const int RIDE_CRITICAL_FIFO_PRIORITY = 10;
+
+void setNiceValue(indoorcycling::ThreadRole role)
+{
+    int nice;
+    switch (role) {
+    case indoorcycling::ThreadRole::RIDE_CRITICAL:
+        nice = RIDE_CRITICAL_NICE;
+        break;
+    case indoorcycling::ThreadRole::BACKGROUND:
+        nice = BACKGROUND_NICE;
+        break;
+    default:
+        return;
+    }
+    // on Linux, the nice value is a property of the thread, not of the whole process.
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) != 0) {
+        qDebug() << "unable to set nice value" << nice << "for" << indoorcycling::threadRoleName(role) << "thread";
+    }
+}
+
+void setCpuAffinity(indoorcycling::ThreadRole role)
+{
+    const int cores = QThread::idealThreadCount();
+    if (cores < 2) {
+        return;
+    }
+    const int backgroundCores = qMax(1, cores / 4);
+    // with few cores, the other threads can not do without the core of the background threads.
+    const int firstCore = (role == indoorcycling::ThreadRole::BACKGROUND || cores < 4) ? 0 : backgroundCores;
+    const int endCore = (role == indoorcycling::ThreadRole::BACKGROUND) ? backgroundCores : cores;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int core = firstCore; core < endCore; ++core) {
+        CPU_SET(core, &cpuSet);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+        qDebug() << "unable to set cpu affinity for" << indoorcycling::threadRoleName(role) << "thread";
+    }
+}
+
+void setRealtimeScheduling()
+{
+    sched_param parameters;
+    parameters.sched_priority = RIDE_CRITICAL_FIFO_PRIORITY;
+    int policy = SCHED_FIFO;
+#ifdef SCHED_RESET_ON_FORK
+    // the decoding threads that libav starts should not inherit the real-time policy, or they could starve the
+    // rest of the system when decoding takes all cores.
+    policy |= SCHED_RESET_ON_FORK;
+#endif
+    // with a pid of 0, this applies to the calling thread only.
+    if (sched_setscheduler(0, policy, &parameters) != 0) {
+        qWarning("Unable to use real-time scheduling for ride critical thread, check the rtprio limit.");
+    }
+}
+#endif
+}
+
+namespace indoorcycling
+{
+
+QString threadRoleName(ThreadRole role)
+{
+    switch (role) {
+    case ThreadRole::RIDE_CRITICAL:
+        return "ride critical";
+    case ThreadRole::BACKGROUND:
+        return "background";
+    default:
+        return "interactive";
+    }
+}
+
+QThread::Priority threadPriority(ThreadRole role)
+{
+    switch (role) {
+    case ThreadRole::RIDE_CRITICAL:
+        return QThread::HighestPriority;
+    case ThreadRole::BACKGROUND:
+        return QThread::LowestPriority;
+    default:
+        return QThread::NormalPriority;
+    }
+}
+
+void configureThreadRoles(bool cpuAffinity, bool realtimeScheduling)
+{
+    cpuAffinityEnabled = cpuAffinity;
+    realtimeSchedulingEnabled = realtimeScheduling;
+}
+
+void applyThreadRole(ThreadRole role)
+{
+    if (roleApplied && currentRole == role) {
+        return;
+    }
+    currentRole = role;
+    roleApplied = true;
+    QThread::currentThread()->setPriority(threadPriority(role));
+#ifdef Q_OS_LINUX
+    setNiceValue(role);
+    if (cpuAffinityEnabled) {
+        setCpuAffinity(role);
+    }
+    if (realtimeSchedulingEnabled && role == ThreadRole::RIDE_CRITICAL) {
+        setRealtimeScheduling();
+    }
+#endif
+}
+
+ThreadRole currentThreadRole()
+{
+    return currentRole;
+}
+
+void startThread(QThread *thread, ThreadRole role)
+{
+    // started is emitted from the new thread, before it runs its event loop or run().
+    QObject::connect(thread, &QThread::started, [role]() {
+        applyThreadRole(role);
+    });
+    thread->start();
+}
+
+void beginRide()
+{
+    ++activeRides;
+}
+
+void endRide()
+{
+    --activeRides;
+}
+
+bool isRideActive()
+{
+    return activeRides > 0;
+}
+
+void throttleBackgroundWork()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (isRideActive() && lastBackgroundWork != std::chrono::steady_clock::time_point()) {
+        const qint64 workMilliseconds =
+                std::chrono::duration_cast<std::chrono::milliseconds>(now - lastBackgroundWork).count();
+        const qint64 sleepMilliseconds = qMin(workMilliseconds * BACKGROUND_SLEEP_PER_WORK_WHILE_RIDING,
+                                              MAXIMUM_BACKGROUND_SLEEP_MILLISECONDS);
+        if (sleepMilliseconds > 0) {
+            QThread::msleep(static_cast<unsigned long>(sleepMilliseconds));
+        }
+    }
+    lastBackgroundWork = std::chrono::steady_clock::now();
+}
+
+void beginBackgroundWork()
+{
+    lastBackgroundWork = std::chrono::steady_clock::now();
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADROLE_H
+#define THREADROLE_H
+
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+namespace indoorcycling
+{
+
+/**
+ * The roles of the threads of the program. The role of a thread determines its priority, and, when configured, the
+ * cores it may run on and whether it is scheduled as a real-time thread on Linux.
+ */
+enum class ThreadRole {
+    RIDE_CRITICAL, // keeps video and sensor data flowing during a ride: video readers, demuxers, the ANT+ worker.
+    INTERACTIVE, // the user interface, and threads without a role of their own.
+    BACKGROUND // work nobody is waiting for: thumbnails, probing and transcoding videos.
+};
+
+QString threadRoleName(ThreadRole role);
+/** The Qt priority of threads with \param role. */
+QThread::Priority threadPriority(ThreadRole role);
+
+/**
+ * Configure how roles are applied to threads. This should be called once, before threads with a role are started.
+ * @param cpuAffinity if true, background threads are kept to the first quarter of the cores, and the other threads
+ * to the rest of the cores, on Linux.
+ * @param realtimeScheduling if true, ride critical threads are scheduled with SCHED_FIFO on Linux. This needs the
+ * rtprio limit or CAP_SYS_NICE, and is ignored when that is missing.
+ */
+void configureThreadRoles(bool cpuAffinity, bool realtimeScheduling);
+
+/**
+ * Give the calling thread \param role. On Linux, the nice value of the thread is set as well, as Qt priorities have no
+ * effect with the normal scheduling policy. A lower priority cannot be undone without privileges there, so only give
+ * roles to threads that keep them: threads of their own, or threads of a pool of their own.
+ */
+void applyThreadRole(ThreadRole role);
+/** The role of the calling thread. Threads that were not given a role are INTERACTIVE. */
+ThreadRole currentThreadRole();
+/** Start \param thread, which gives itself \param role before it runs. */
+void startThread(QThread *thread, ThreadRole role);
+
+/**
+ * Count a ride that starts or ends. While a ride is active, background work is throttled, see
+ * throttleBackgroundWork(). Rides are counted, so the next ride can start before the previous one has ended.
+ */
+void beginRide();
+void endRide();
+bool isRideActive();
+/**
+ * Called by background work between small pieces of work, like decoding a frame. While a ride is active, this sleeps
+ * four times as long as the work since the previous call on this thread took, so background work uses at most a
+ * fifth of a core and the ride does not stutter.
+ */
+void throttleBackgroundWork();
+/**
+ * Start measuring background work on this thread, without throttling. Call this before work that starts after the
+ * thread was idle, so the idle time does not count as work in the next throttleBackgroundWork().
+ */
+void beginBackgroundWork();
+
+}
+
+#endif // THREADROLE_H
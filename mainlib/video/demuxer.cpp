@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "demuxer.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtDebug>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+namespace
+{
+// The queue is bounded both in number of packets and in size, so a series of big I-frames does not
+// use too much memory, while there are still enough packets to decode when the disk is slow for a moment.
+const std::size_t MAX_QUEUED_PACKETS = 64;
+const int MAX_QUEUED_BYTES = 32 * 1024 * 1024;
+}
+
+Demuxer::Demuxer(AVFormatContext *formatContext, int streamIndex,
+                 const std::shared_ptr<PipelineTimings> &pipelineTimings, QObject *parent):
+    QThread(parent), _formatContext(formatContext), _streamIndex(streamIndex), _pipelineTimings(pipelineTimings)
+{
+    // empty
+}
+
+Demuxer::~Demuxer()
+{
+    stop();
+    wait();
+    QMutexLocker locker(&_queueMutex);
+    clearQueue();
+}
+
+AVPacket *Demuxer::takePacket()
+{
+    QMutexLocker locker(&_queueMutex);
+    while (_queue.empty() && !_endOfFile && !_stopped) {
+        _packetAvailable.wait(&_queueMutex);
+    }
+    if (_queue.empty()) {
+        return nullptr;
+    }
+    AVPacket *packet = _queue.front();
+    _queue.pop_front();
+    _queuedBytes -= packet->size;
+    _spaceAvailable.wakeOne();
+    return packet;
+}
+
+int Demuxer::seek(qint64 timestamp, int flags)
+{
+    // wait until the demuxing thread is done reading the current packet.
+    QMutexLocker formatContextLocker(&_formatContextMutex);
+    QMutexLocker locker(&_queueMutex);
+
+    clearQueue();
+    ++_serial;
+    _endOfFile = false;
+    const int result = av_seek_frame(_formatContext, _streamIndex, timestamp, flags);
+    _spaceAvailable.wakeOne();
+    return result;
+}
+
+void Demuxer::run()
+{
+    forever {
+        {
+            QMutexLocker locker(&_queueMutex);
+            while (!_stopped && (_endOfFile || isQueueFull())) {
+                _spaceAvailable.wait(&_queueMutex);
+            }
+            if (_stopped) {
+                return;
+            }
+        }
+
+        AVPacket *packet = av_packet_alloc();
+        quint32 serial;
+        int result;
+        {
+            QMutexLocker formatContextLocker(&_formatContextMutex);
+            {
+                // a seek can only change the serial while holding the format context mutex, so the serial
+                // cannot change while we read.
+                QMutexLocker locker(&_queueMutex);
+                serial = _serial;
+            }
+            QElapsedTimer readTimer;
+            readTimer.start();
+            result = av_read_frame(_formatContext, packet);
+            if (result >= 0 && packet->stream_index == _streamIndex) {
+                _pipelineTimings->record(PipelineStage::DEMUX, readTimer.nsecsElapsed());
+            }
+        }
+
+        QMutexLocker locker(&_queueMutex);
+        if (result < 0) {
+            av_packet_free(&packet);
+            if (serial == _serial) {
+                if (result != AVERROR_EOF) {
+                    qWarning("Error reading packet, treating it as end of file.");
+                }
+                _endOfFile = true;
+                _packetAvailable.wakeAll();
+            }
+        } else if (serial != _serial || packet->stream_index != _streamIndex) {
+            // either a seek was done after reading this packet, or the packet is not from the video stream.
+            av_packet_free(&packet);
+        } else {
+            _queue.push_back(packet);
+            _queuedBytes += packet->size;
+            _packetAvailable.wakeOne();
+        }
+    }
+}
+
+bool Demuxer::isQueueFull() const
+{
+    return _queue.size() >= MAX_QUEUED_PACKETS || _queuedBytes >= MAX_QUEUED_BYTES;
+}
+
+void Demuxer::clearQueue()
+{
+    for (AVPacket *packet: _queue) {
+        av_packet_free(&packet);
+    }
+    _queue.clear();
+    _queuedBytes = 0;
+}
+
+void Demuxer::stop()
+{
+    QMutexLocker locker(&_queueMutex);
+    _stopped = true;
+    _spaceAvailable.wakeAll();
+    _packetAvailable.wakeAll();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef DEMUXER_H
+#define DEMUXER_H
+
+#include <deque>
+#include <memory>
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "pipelinetimings.h"
+
+struct AVFormatContext;
+struct AVPacket;
+
+/**
+ * Reads the packets of a video stream on a separate thread and keeps them in a bounded queue, so
+ * disk I/O is overlapped with decoding. The decoding thread takes packets from the queue with takePacket().
+ *
+ * While the demuxer is running, the AVFormatContext should only be accessed through the demuxer.
+ */
+class Demuxer : public QThread
+{
+    Q_OBJECT
+public:
+    /** @param pipelineTimings the histograms in which the time it takes to read a packet is recorded. */
+    explicit Demuxer(AVFormatContext *formatContext, int streamIndex,
+                     const std::shared_ptr<PipelineTimings> &pipelineTimings, QObject *parent = 0);
+    /** Stop the demuxing thread and free all packets that are still queued. */
+    virtual ~Demuxer();
+
+    /**
+     * Take the next packet of the video stream from the queue. This blocks until a packet is available.
+     * The caller is responsible for freeing the packet with av_packet_free.
+     * @return the packet, or nullptr if the end of the file has been reached.
+     */
+    AVPacket *takePacket();
+
+    /**
+     * Seek in the video file. All packets that were queued before the seek are discarded.
+     * @param timestamp timestamp in time base units of the video stream.
+     * @param flags AVSEEK_FLAG_* flags, passed to av_seek_frame.
+     * @return the result of av_seek_frame.
+     */
+    int seek(qint64 timestamp, int flags);
+
+protected:
+    virtual void run() override;
+
+private:
+    bool isQueueFull() const;
+    void clearQueue();
+    void stop();
+
+    AVFormatContext* const _formatContext;
+    const int _streamIndex;
+    const std::shared_ptr<PipelineTimings> _pipelineTimings;
+
+    /** held while reading from or seeking in _formatContext */
+    QMutex _formatContextMutex;
+    /** protects all fields below */
+    QMutex _queueMutex;
+    QWaitCondition _packetAvailable;
+    QWaitCondition _spaceAvailable;
+    std::deque<AVPacket*> _queue;
+    int _queuedBytes = 0;
+    /** incremented on every seek, so packets read before a seek can be recognized. */
+    quint32 _serial = 0;
+    bool _endOfFile = false;
+    bool _stopped = false;
+};
+
+#endif // DEMUXER_H
@@ -20,11 +20,29 @@
  * <http://www.gnu.org/licenses/>.
  *
  * This code was inspired by the YUV-to-RGB shader in http://slouken.blogspot.nl/2011/02/mpeg-acceleration-with-glsl.html
+ *
+ * The painter compiles a variant of this shader for every pixel format, by defining these macros:
+ * INTERLEAVED_CHROMA: the U and V samples are the luminance and alpha of uTex, as in NV12.
+ * FULL_HEIGHT_CHROMA: the U and V planes have the full height of the Y plane, as in YUV422P.
+ * TEN_BIT_SAMPLES: the textures contain 10 bit samples in 16 bit values.
  */
 
 uniform sampler2DRect yTex;
 uniform sampler2DRect uTex, vTex;
 
+#ifdef FULL_HEIGHT_CHROMA
+const vec2 chromaScale = vec2(0.5, 1.0);
+#else
+const vec2 chromaScale = vec2(0.5, 0.5);
+#endif
+
+// 10 bit samples only use the lower part of the range of a 16 bit texture.
+#ifdef TEN_BIT_SAMPLES
+const float sampleScale = 65535.0 / 1023.0;
+#else
+const float sampleScale = 1.0;
+#endif
+
 // YUV offset
 const vec3 offset = vec3(-0.0625, -0.5, -0.5);
 
@@ -45,12 +63,16 @@ void main(void)
     yuv.x = texture2DRect(yTex, tcoord).r;
 
     // Get the U and V values
-    tcoord *= 0.5;
+    tcoord *= chromaScale;
+#ifdef INTERLEAVED_CHROMA
+    yuv.yz = texture2DRect(uTex, tcoord).ra;
+#else
     yuv.y = texture2DRect(uTex, tcoord).r;
     yuv.z = texture2DRect(vTex, tcoord).r;
+#endif
 
     // Do the color transform
-    yuv += offset;
+    yuv = yuv * sampleScale + offset;
     rgb.r = dot(yuv, Rcoeff);
     rgb.g = dot(yuv, Gcoeff);
     rgb.b = dot(yuv, Bcoeff);
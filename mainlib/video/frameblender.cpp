@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "frameblender.h"
+
+#ifdef BIGRING_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using indoorcycling::InstructionSet;
+
+namespace
+{
+void blendScalar(const quint8 *first, const quint8 *second, quint8 *destination, std::size_t size, int weight)
+{
+    const int firstWeight = FrameBlender::MAXIMUM_WEIGHT - weight;
+    for (std::size_t i = 0; i < size; ++i) {
+        destination[i] = static_cast<quint8>((first[i] * firstWeight + second[i] * weight + 128) >> 8);
+    }
+}
+
+#ifdef BIGRING_X86_SIMD
+/*
+ * The SIMD kernels widen the bytes to 16 bits. Because both weights add up to 256, the weighted sum of two bytes
+ * is at most 255 * 256 + 128, which fits in an unsigned 16 bit integer, so the results are the same as those of
+ * the scalar version.
+ */
+__attribute__((target("sse2")))
+void blendSse2(const quint8 *first, const quint8 *second, quint8 *destination, std::size_t size, int weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i firstWeight = _mm_set1_epi16(static_cast<short>(FrameBlender::MAXIMUM_WEIGHT - weight));
+    const __m128i secondWeight = _mm_set1_epi16(static_cast<short>(weight));
+    const __m128i rounding = _mm_set1_epi16(128);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), firstWeight),
+                                    _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), secondWeight));
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), firstWeight),
+                                     _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), secondWeight));
+        low = _mm_srli_epi16(_mm_add_epi16(low, rounding), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, rounding), 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+    }
+    blendScalar(first + i, second + i, destination + i, size - i, weight);
+}
+
+__attribute__((target("avx2")))
+void blendAvx2(const quint8 *first, const quint8 *second, quint8 *destination, std::size_t size, int weight)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i firstWeight = _mm256_set1_epi16(static_cast<short>(FrameBlender::MAXIMUM_WEIGHT - weight));
+    const __m256i secondWeight = _mm256_set1_epi16(static_cast<short>(weight));
+    const __m256i rounding = _mm256_set1_epi16(128);
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i));
+
+        // unpacking and packing both work per 128 bit lane, so the bytes end up in their original order.
+        __m256i low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), firstWeight),
+                                       _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), secondWeight));
+        __m256i high = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), firstWeight),
+                                        _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), secondWeight));
+        low = _mm256_srli_epi16(_mm256_add_epi16(low, rounding), 8);
+        high = _mm256_srli_epi16(_mm256_add_epi16(high, rounding), 8);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_packus_epi16(low, high));
+    }
+    blendSse2(first + i, second + i, destination + i, size - i, weight);
+}
+#endif
+}
+
+FrameBlender::FrameBlender():
+    FrameBlender(indoorcycling::bestSupportedInstructionSet())
+{
+    // empty
+}
+
+FrameBlender::FrameBlender(InstructionSet instructionSet):
+    _instructionSet(indoorcycling::isSupported(instructionSet) ? instructionSet :
+                                                                 indoorcycling::bestSupportedInstructionSet())
+{
+    // empty
+}
+
+InstructionSet FrameBlender::instructionSet() const
+{
+    return _instructionSet;
+}
+
+void FrameBlender::blend(const quint8 *first, const quint8 *second, quint8 *destination, std::size_t size,
+                         int weight) const
+{
+    weight = qBound(0, weight, MAXIMUM_WEIGHT);
+    switch (_instructionSet) {
+#ifdef BIGRING_X86_SIMD
+    case InstructionSet::AVX2:
+        blendAvx2(first, second, destination, size, weight);
+        break;
+    case InstructionSet::SSE2:
+        blendSse2(first, second, destination, size, weight);
+        break;
+#endif
+    default:
+        blendScalar(first, second, destination, size, weight);
+        break;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAMEBLENDER_H
+#define FRAMEBLENDER_H
+
+#include <cstddef>
+#include <QtCore/QtGlobal>
+
+#include "util/instructionset.h"
+
+/**
+ * Blends two planes of a YUV frame, to synthesize a frame between two frames of a video. This is used to make
+ * the video look smooth when the rider is so slow that every frame of the video is shown multiple times.
+ *
+ * Every pixel of the blended plane is (first * (256 - weight) + second * weight + 128) / 256. All instruction sets
+ * give exactly the same result.
+ */
+class FrameBlender
+{
+public:
+    /** The maximum weight, which gives a plane equal to the second plane. */
+    static const int MAXIMUM_WEIGHT = 256;
+
+    /** Create a FrameBlender that uses the best instruction set the cpu supports. */
+    FrameBlender();
+    /** Create a FrameBlender that uses \param instructionSet, or the best supported one if that is not supported. */
+    explicit FrameBlender(indoorcycling::InstructionSet instructionSet);
+
+    indoorcycling::InstructionSet instructionSet() const;
+
+    /**
+     * Blend \param size bytes from \param first and \param second into \param destination.
+     * @param weight the weight of the second plane, between 0 and MAXIMUM_WEIGHT.
+     */
+    void blend(const quint8 *first, const quint8 *second, quint8 *destination, std::size_t size, int weight) const;
+
+private:
+    indoorcycling::InstructionSet _instructionSet;
+};
+
+#endif // FRAMEBLENDER_H
@@ -3,6 +3,7 @@
 #include <cstring>
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QSize>
 #include <QtCore/QtDebug>
 #include <QtCore/QTime>
@@ -11,38 +12,46 @@
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
 }
 
 #include "model/reallifevideo.h"
+#include "videoindexer.h"
 
 namespace {
+/** alignment needed by the decoders for the start of every line, when decoding directly into a pixel buffer */
+const int DIRECT_RENDERING_ALIGNMENT = 64;
+/** swscale's fast bilinear scaler has SIMD implementations, and its quality is fine for reducing frames. */
+const int CONVERSION_FLAGS = SWS_FAST_BILINEAR;
+
 QEvent::Type OpenVideoFileEventType = static_cast<QEvent::Type>(QEvent::User + 103);
-QEvent::Type CopyNextFrameEventType = static_cast<QEvent::Type>(QEvent::User + 104);
+QEvent::Type ReadFramesEventType = static_cast<QEvent::Type>(QEvent::User + 104);
 QEvent::Type SeekEventType = static_cast<QEvent::Type>(QEvent::User + 105);
+QEvent::Type FrameSlotsEventType = static_cast<QEvent::Type>(QEvent::User + 106);
 
 class OpenVideoFileEvent: public QEvent
 {
 public:
-    OpenVideoFileEvent(const QString& videoFilename):
-        QEvent(OpenVideoFileEventType), _videoFilename(videoFilename)
+    OpenVideoFileEvent(const QStringList& videoFilenames):
+        QEvent(OpenVideoFileEventType), _videoFilenames(videoFilenames)
     {
         // empty
     }
 
-    QString _videoFilename;
+    QStringList _videoFilenames;
 };
 
-class CopyNextFrameEvent: public QEvent
+class FrameSlotsEvent: public QEvent
 {
 public:
-    CopyNextFrameEvent(const std::weak_ptr<FrameBuffer> &frameBuffer, int skipFrames):
-        QEvent(CopyNextFrameEventType), _frameBuffer(frameBuffer), _skipFrames(skipFrames)
+    FrameSlotsEvent(const std::shared_ptr<FrameSlotRing> &frameSlots):
+        QEvent(FrameSlotsEventType), _frameSlots(frameSlots)
     {
         // empty
     }
 
-    std::weak_ptr<FrameBuffer> _frameBuffer;
-    int _skipFrames;
+    std::shared_ptr<FrameSlotRing> _frameSlots;
 };
 
 class SeekEvent: public QEvent
@@ -56,22 +65,77 @@ public:
 
     qint64 _frameNumber;
 };
+
+/**
+ * Get the pixel format of the frame buffers for frames with the libav pixel format \param format.
+ * @return false if the painters do not support the format, so frames have to be converted.
+ */
+bool nativePixelFormat(int format, PixelFormat &pixelFormat)
+{
+    switch (format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        pixelFormat = PixelFormat::YUV420P;
+        return true;
+    case AV_PIX_FMT_YUV422P:
+    case AV_PIX_FMT_YUVJ422P:
+        pixelFormat = PixelFormat::YUV422P;
+        return true;
+    case AV_PIX_FMT_NV12:
+        pixelFormat = PixelFormat::NV12;
+        return true;
+    case AV_PIX_FMT_YUV420P10LE:
+        pixelFormat = PixelFormat::YUV420P10;
+        return true;
+    case AV_PIX_FMT_YUV422P10LE:
+        pixelFormat = PixelFormat::YUV422P10;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Determine how many times the decoder can halve the width and height of frames of \param size, without making them
+ * smaller than \param maximumSize.
+ */
+int lowResolution(const QSize &size, const QSize &maximumSize, int maximumLowResolution)
+{
+    int lowResolution = 0;
+    while (lowResolution < maximumLowResolution && (size.width() >> (lowResolution + 1)) >= maximumSize.width() &&
+           (size.height() >> (lowResolution + 1)) >= maximumSize.height()) {
+        ++lowResolution;
+    }
+    return lowResolution;
+}
+
+/** The memory of a direct rendered frame belongs to the pixel buffer, so it should not be freed. */
+void doNotFree(void *, uint8_t *)
+{
+    // empty
+}
 }
 
 FrameCopyingVideoReader::FrameCopyingVideoReader(QObject *parent) :
     GenericVideoReader(parent), _currentFrameNumber(0)
 {
-    // empty
+    qRegisterMetaType<FrameFormat>("FrameFormat");
 }
 
 FrameCopyingVideoReader::~FrameCopyingVideoReader()
 {
     qDebug() << "closing VideoReader2";
+    sws_freeContext(_conversionContext);
+}
+
+void FrameCopyingVideoReader::setFrameSlots(const std::shared_ptr<FrameSlotRing> &frameSlots)
+{
+    QCoreApplication::postEvent(this, new FrameSlotsEvent(frameSlots));
 }
 
-void FrameCopyingVideoReader::copyNextFrame(const std::weak_ptr<FrameBuffer> &buffer, int skipFrames)
+void FrameCopyingVideoReader::readFrames()
 {
-    QCoreApplication::postEvent(this, new CopyNextFrameEvent(buffer, skipFrames));
+    QCoreApplication::postEvent(this, new QEvent(ReadFramesEventType));
 }
 
 void FrameCopyingVideoReader::seekToFrame(qint64 frameNumber)
@@ -79,84 +143,485 @@ void FrameCopyingVideoReader::seekToFrame(qint64 frameNumber)
     QCoreApplication::postEvent(this, new SeekEvent(frameNumber));
 }
 
+void FrameCopyingVideoReader::setDirectRenderingEnabled(bool enabled)
+{
+    _directRenderingEnabled = enabled;
+}
+
+void FrameCopyingVideoReader::setSpeedAdaptiveDecodingEnabled(bool enabled)
+{
+    _speedAdaptiveDecodingEnabled = enabled;
+}
+
+void FrameCopyingVideoReader::setFrameBlending(int subFramesPerFrame)
+{
+    _subFramesPerFrame = qMax(1, subFramesPerFrame);
+}
+
+void FrameCopyingVideoReader::setMaximumFrameSize(const QSize &maximumFrameSize)
+{
+    _maximumFrameSize = maximumFrameSize;
+}
+
 void FrameCopyingVideoReader::openVideoFile(const QString &videoFilename)
 {
-    QCoreApplication::postEvent(this, new OpenVideoFileEvent(videoFilename));
+    openVideoFile(QStringList(videoFilename));
+}
+
+void FrameCopyingVideoReader::openVideoFile(const QStringList &videoFilenames)
+{
+    QCoreApplication::postEvent(this, new OpenVideoFileEvent(videoFilenames));
 }
 
-void FrameCopyingVideoReader::openVideoFileInternal(const QString &videoFilename)
+void FrameCopyingVideoReader::openVideoFileInternal(const QStringList &videoFilenames)
 {
-    GenericVideoReader::openVideoFileInternal(videoFilename);
+    GenericVideoReader::openVideoFileInternal(videoFilenames);
+    if (!codecContext()) {
+        return;
+    }
+    // building a missing index reads the whole file, which would keep the first frame waiting. Until the index is
+    // built in the background, frame numbers are estimated.
+    loadVideoIndex(false);
+    if (!hasVideoIndex()) {
+        VideoIndexer::enqueue(videoFilenames.value(0));
+    }
 
     _currentFrameNumber = 0;
-    QSize frameSize = totalFrameSize();
-    emit videoOpened(videoFilename, QSize(codecContext()->width, codecContext()->height),
-                     frameSize, totalNumberOfFrames());
+    _currentFrameCopied = false;
+    _pendingSkipFrames = 0;
+    resetFrameBlending();
+    QSize pictureSize;
+    const FrameFormat format = frameFormat(pictureSize);
+    emit videoOpened(videoFilenames.value(0), pictureSize, format, totalNumberOfFrames(),
+                     av_q2d(videoStream()->avg_frame_rate));
 }
 
-void FrameCopyingVideoReader::copyNextFrameInternal(std::weak_ptr<FrameBuffer> &buffer, int skipFrames)
+/**
+ * Fill the requested frame slots, until there are no requests left. To keep seeks from waiting behind a continuous
+ * stream of requests, at most one round of the ring is filled before the other events are handled.
+ */
+void FrameCopyingVideoReader::fillFrameSlots()
 {
-    AVFrame* frame = frameYuv().frame;
-    int frameBufferIndex = -1;
-    QSize requestFrameSize;
-    if (auto locked = buffer.lock()) {
-        locked->withMutex([this, frame, &frameBufferIndex, &requestFrameSize] (void *ptr, const QSize& frameSize, int index) {
-            Q_ASSERT_X(ptr, "copyNextFrameInternal", "ptr should always be non-null here");
-            if (ptr) {
-                frameBufferIndex = index;
-                requestFrameSize = frameSize;
-                quint8* bufferPointer = reinterpret_cast<quint8*>(ptr);
-                quint32 offset = 0;
-                quint32 ysize = frame->linesize[0] * frame->height;
-                std::memcpy(bufferPointer, frame->data[0], ysize);
-                offset += ysize;
-                quint32 usize = frame->linesize[1] * frame->height / 2;
-                std::memcpy(bufferPointer + offset, frame->data[1], usize);
-                offset += usize;
-                quint32 vsize = usize;
-                std::memcpy(bufferPointer + offset, frame->data[2], vsize);
-            }
-        });
+    if (!_frameSlots) {
+        return;
+    }
+    for (int i = 0; i < _frameSlots->size(); ++i) {
+        FrameSlot *slot = _frameSlots->slotToFill();
+        if (!slot) {
+            break;
+        }
+        slot->frameNumber = -1;
+        slot->decodeNanoseconds = 0;
+        slot->copyNanoseconds = 0;
+        copyNextFrameInternal(*slot);
+        _frameSlots->setSlotFilled();
+        // decoding can take long, so it is done after the slot is handed over. The painter then never waits for it
+        // when it closes the ring.
+        decodeNextFrame();
+    }
+    if (!_frameSlots->waitForRequests()) {
+        readFrames();
+    }
+}
+
+void FrameCopyingVideoReader::copyNextFrameInternal(FrameSlot &slot)
+{
+    const int skipFrames = slot.skipFrames;
+    if (_directRenderingActive && _currentFrameCopied) {
+        decodeNextFrameDirectly(slot);
+        return;
+    }
+    if (_subFrame > 0) {
+        copyBlendedFrame(slot);
+        return;
+    }
+
+    QElapsedTimer copyTimer;
+    copyTimer.start();
+    if (copyFrame(frameYuv().frame, slot.data, slot.frameFormat)) {
+        slot.frameNumber = _currentFrameNumber * _subFramesPerFrame;
+        slot.decodeNanoseconds = _decodeNanoseconds;
+        slot.copyNanoseconds = copyTimer.nsecsElapsed();
+        pipelineTimings().record(PipelineStage::COPY, slot.copyNanoseconds);
+    }
+    // the frame blender works on 8 bit samples, in the layout of the decoded frames.
+    const bool blendingPossible = !_conversionContext && slot.frameFormat.bytesPerSample() == 1;
+    if (slot.blendFrames && skipFrames == 0 && _subFramesPerFrame > 1 && _currentFrameNumber >= 0 &&
+            blendingPossible) {
+        // keep a reference to the current frame, so we can blend the frames between it and the next frame.
+        if (!_blendFrame) {
+            _blendFrame.reset(new AVFrameWrapper);
+        }
+        av_frame_unref(_blendFrame->frame);
+        if (av_frame_ref(_blendFrame->frame, frameYuv().frame) == 0) {
+            _blendFrameNumber = _currentFrameNumber;
+            _nextFrameDecode = NextFrameDecode::FOR_BLENDING;
+            _nextFrameSkipFrames = 0;
+            return;
+        }
+    }
+    if (_directRenderingActive) {
+        // the next frame will be decoded directly into the buffer of the next request.
+        _currentFrameCopied = true;
+        _pendingSkipFrames = skipFrames;
+        return;
+    }
+    _nextFrameDecode = NextFrameDecode::NEXT;
+    _nextFrameSkipFrames = skipFrames;
+}
+
+/**
+ * Decode the frame after the frame that copyNextFrameInternal() copied, if it asked for that. For frame blending, the
+ * sub frames between the copied frame and the new frame are blended from the next requests.
+ */
+void FrameCopyingVideoReader::decodeNextFrame()
+{
+    const NextFrameDecode nextFrameDecode = _nextFrameDecode;
+    _nextFrameDecode = NextFrameDecode::NONE;
+    if (nextFrameDecode == NextFrameDecode::NONE) {
+        return;
+    }
+    _currentFrameNumber = loadFrameAfterSkipping(_nextFrameSkipFrames);
+    if (nextFrameDecode == NextFrameDecode::FOR_BLENDING) {
+        const AVFrame *nextFrame = frameYuv().frame;
+        if (_currentFrameNumber >= 0 && nextFrame->width == _blendFrame->frame->width &&
+                nextFrame->height == _blendFrame->frame->height &&
+                nextFrame->linesize[0] == _blendFrame->frame->linesize[0]) {
+            _subFrame = 1;
+        } else {
+            av_frame_unref(_blendFrame->frame);
+        }
+    }
+}
+
+/**
+ * Blend the next sub frame between the frame in _blendFrame and the current frame into \param slot.
+ */
+void FrameCopyingVideoReader::copyBlendedFrame(FrameSlot &slot)
+{
+    const int weight = _subFrame * FrameBlender::MAXIMUM_WEIGHT / _subFramesPerFrame;
+    QElapsedTimer blendTimer;
+    blendTimer.start();
+    if (slot.data && blendFrame(_blendFrame->frame, frameYuv().frame, slot.data, slot.frameFormat, weight)) {
+        slot.frameNumber = _blendFrameNumber * _subFramesPerFrame + _subFrame;
+        slot.copyNanoseconds = blendTimer.nsecsElapsed();
+        pipelineTimings().record(PipelineStage::COPY, slot.copyNanoseconds);
+    }
+    _subFrame = (_subFrame + 1) % _subFramesPerFrame;
+    if (_subFrame == 0) {
+        // all sub frames done, the current frame will be copied with the next request.
+        av_frame_unref(_blendFrame->frame);
+    }
+}
+
+/**
+ * Blend the planes of \param first and \param second into the mapped pixel buffer \param ptr.
+ * @return false if the planes of the frames do not have the line sizes of the frame buffer.
+ */
+bool FrameCopyingVideoReader::blendFrame(const AVFrame *first, const AVFrame *second, void *ptr,
+                                         const FrameFormat &frameFormat, int weight)
+{
+    quint8* bufferPointer = reinterpret_cast<quint8*>(ptr);
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        if (first->linesize[i] != frameFormat.lineSize(i)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        const int lines = (i == 0) ? first->height : first->height * frameFormat.lines(i) / frameFormat.lines(0);
+        _frameBlender.blend(first->data[i], second->data[i], bufferPointer + frameFormat.planeOffset(i),
+                            first->linesize[i] * lines, weight);
+    }
+    return true;
+}
+
+void FrameCopyingVideoReader::resetFrameBlending()
+{
+    _subFrame = 0;
+    if (_blendFrame) {
+        av_frame_unref(_blendFrame->frame);
+    }
+}
+
+/**
+ * Load the next frame, after skipping \param skipFrames frames. This is used when the frame rate requested is higher
+ * than the normal frame rate of the video.
+ * @return the number of the loaded frame.
+ */
+qint64 FrameCopyingVideoReader::loadFrameAfterSkipping(int skipFrames)
+{
+    QElapsedTimer timer;
+    timer.start();
+    qint64 frameNumber = _currentFrameNumber;
+    if (skipFrames > 0 && _speedAdaptiveDecodingEnabled) {
+        frameNumber = skipToFrame(_currentFrameNumber + skipFrames + 1);
     } else {
-        qDebug() << "unable to lock weak_ptr, skipFrames =" << skipFrames;
+        // We still have to decode the skipped frames completely, but they won't be copied to video memory.
+        for (int i = 0; i <= skipFrames; ++i) {
+            frameNumber = loadNextFrame();
+        }
+    }
+    _decodeNanoseconds = timer.nsecsElapsed();
+    pipelineTimings().record(PipelineStage::DECODE, _decodeNanoseconds);
+    return frameNumber;
+}
+
+/**
+ * Decode the next frame directly into the frame buffer of \param slot. If the decoder does not use the buffer for the
+ * frame, the frame is copied into it, as usual. The frames skipped in the previous request are skipped first, so the
+ * frames shown are the same as without direct rendering.
+ */
+void FrameCopyingVideoReader::decodeNextFrameDirectly(FrameSlot &slot)
+{
+    const int framesToSkip = _pendingSkipFrames;
+    _pendingSkipFrames = slot.skipFrames;
+
+    AVFrame* frame = frameYuv().frame;
+    // the frame slot is not retired while we're filling it, so the pixel buffer cannot be unmapped while the
+    // decoder writes to it.
+    _directRenderingTarget = slot.data;
+    _directRenderingTargetFormat = slot.frameFormat;
+    _directRenderingFrameNumber = _currentFrameNumber + framesToSkip + 1;
+    _directRenderedFrame = nullptr;
+    _currentFrameNumber = loadFrameAfterSkipping(framesToSkip);
+    _directRenderingTarget = nullptr;
+
+    const bool decodedIntoBuffer = _directRenderedFrame && frame->data[0] == _directRenderedFrame;
+    QElapsedTimer copyTimer;
+    copyTimer.start();
+    if (_currentFrameNumber >= 0 && (decodedIntoBuffer || copyFrame(frame, slot.data, slot.frameFormat))) {
+        slot.frameNumber = _currentFrameNumber;
+        slot.decodeNanoseconds = _decodeNanoseconds;
+        slot.copyNanoseconds = decodedIntoBuffer ? 0 : copyTimer.nsecsElapsed();
+        if (!decodedIntoBuffer) {
+            pipelineTimings().record(PipelineStage::COPY, slot.copyNanoseconds);
+        }
+    }
+}
+
+/**
+ * Copy the planes of \param frame into the mapped pixel buffer \param ptr. Planes with the line size of the frame
+ * buffer are copied at once, others line by line.
+ * @return false if there was no frame to copy.
+ */
+bool FrameCopyingVideoReader::copyFrame(const AVFrame *frame, void *ptr, const FrameFormat &frameFormat)
+{
+    if (!frame->data[0] || !ptr) {
+        return false;
     }
-    if (frameBufferIndex >= 0) {
-        emit frameCopied(frameBufferIndex, _currentFrameNumber, requestFrameSize);
+    quint8* bufferPointer = reinterpret_cast<quint8*>(ptr);
+    if (_conversionContext) {
+        return convertFrame(frame, bufferPointer, frameFormat);
     }
-    // skip frames. We still have to decode these frames, but they won't be saved in _frame for
-    // copying to video memory. This is used when the frame rate requested is higher than
-    // the normal frame rate of the video.
-    for (int i = 0; i < skipFrames; ++i) {
-        _currentFrameNumber = loadNextFrame();
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        const int lineSize = frameFormat.lineSize(i);
+        const int lines = qMin(frameFormat.lines(i), (i == 0) ? frame->height :
+                                   frame->height * frameFormat.lines(i) / frameFormat.lines(0));
+        if (frame->linesize[i] == lineSize) {
+            std::memcpy(bufferPointer + frameFormat.planeOffset(i), frame->data[i], lineSize * lines);
+        } else {
+            av_image_copy_plane(bufferPointer + frameFormat.planeOffset(i), lineSize, frame->data[i],
+                                frame->linesize[i], qMin(lineSize, frame->linesize[i]), lines);
+        }
     }
-    _currentFrameNumber = loadNextFrame();
+    return true;
+}
+
+/**
+ * Convert \param frame, in a pixel format the painters do not support or larger than the maximum frame size, to
+ * YUV420P in \param bufferPointer.
+ */
+bool FrameCopyingVideoReader::convertFrame(const AVFrame *frame, quint8 *bufferPointer, const FrameFormat &frameFormat)
+{
+    _conversionContext = sws_getCachedContext(_conversionContext, frame->width, frame->height,
+                                              static_cast<AVPixelFormat>(frame->format), _convertedSize.width(),
+                                              _convertedSize.height(), AV_PIX_FMT_YUV420P, CONVERSION_FLAGS,
+                                              nullptr, nullptr, nullptr);
+    if (!_conversionContext) {
+        return false;
+    }
+    uint8_t *planes[4] = { nullptr, nullptr, nullptr, nullptr };
+    int lineSizes[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        planes[i] = bufferPointer + frameFormat.planeOffset(i);
+        lineSizes[i] = frameFormat.lineSize(i);
+    }
+    sws_scale(_conversionContext, frame->data, frame->linesize, 0, frame->height, planes, lineSizes);
+    return true;
+}
+
+void FrameCopyingVideoReader::configureCodecContext(AVCodecContext *codecContext, const AVCodec *codec)
+{
+    if (_maximumFrameSize.isValid()) {
+        codecContext->lowres = lowResolution(QSize(codecContext->width, codecContext->height), _maximumFrameSize,
+                                             codec->max_lowres);
+        if (codecContext->lowres > 0) {
+            qDebug() << "decoding at 1 /" << (1 << codecContext->lowres) << "of the resolution of the video";
+        }
+    }
+
+    _directRenderingActive = false;
+    if (!_directRenderingEnabled || _subFramesPerFrame > 1) {
+        return;
+    }
+    // Frames of intra-only codecs are not used as a reference for other frames, so the decoder is done with a
+    // frame as soon as it is returned, and the pixel buffer can be unmapped for uploading. Other codecs keep
+    // decoded frames around, so they always decode into memory of their own.
+    const AVCodecDescriptor *descriptor = avcodec_descriptor_get(codecContext->codec_id);
+    if (!descriptor || !(descriptor->props & AV_CODEC_PROP_INTRA_ONLY) || !(codec->capabilities & AV_CODEC_CAP_DR1)) {
+        qDebug() << "not using direct rendering for codec" << codec->name;
+        return;
+    }
+    // with frame threading, the decoder asks for buffers for frames that will only be returned later, so we'd
+    // not know in which pixel buffer a frame ends up.
+    if (codecContext->thread_type & FF_THREAD_FRAME) {
+        codecContext->thread_type = FF_THREAD_SLICE;
+    }
+    codecContext->opaque = this;
+    codecContext->get_buffer2 = &FrameCopyingVideoReader::getBuffer;
+    _directRenderingActive = true;
+    qDebug() << "using direct rendering for codec" << codec->name;
+}
+
+int FrameCopyingVideoReader::getBuffer(AVCodecContext *codecContext, AVFrame *frame, int flags)
+{
+    FrameCopyingVideoReader *reader = static_cast<FrameCopyingVideoReader*>(codecContext->opaque);
+    if (reader->_directRenderingTarget && !(flags & AV_GET_BUFFER_FLAG_REF) &&
+            !reader->isSkippedFrame(frame) && reader->setupDirectRenderingFrame(codecContext, frame)) {
+        return 0;
+    }
+    return avcodec_default_get_buffer2(codecContext, frame, flags);
+}
+
+/**
+ * The decoder sets the timestamps of a frame before asking for a buffer, so we can check whether a frame will be
+ * skipped, and should not use the direct rendering target.
+ */
+bool FrameCopyingVideoReader::isSkippedFrame(const AVFrame *frame) const
+{
+    const qint64 timestamp = (frame->pts == static_cast<qint64>(AV_NOPTS_VALUE)) ? frame->pkt_dts : frame->pts;
+    if (timestamp == static_cast<qint64>(AV_NOPTS_VALUE)) {
+        return false;
+    }
+    return timestampToFrameNumber(timestamp) < _directRenderingFrameNumber;
+}
+
+/**
+ * Let the planes of \param frame point to the current direct rendering target, if the layout the decoder
+ * needs fits in the pixel buffer.
+ */
+bool FrameCopyingVideoReader::setupDirectRenderingFrame(AVCodecContext *codecContext, AVFrame *frame)
+{
+    const FrameFormat &frameFormat = _directRenderingTargetFormat;
+    PixelFormat pixelFormat;
+    if (!nativePixelFormat(frame->format, pixelFormat) || pixelFormat != frameFormat.pixelFormat()) {
+        return false;
+    }
+
+    // the decoder may write outside of the visible picture, up to the aligned dimensions.
+    int width = frame->width;
+    int height = frame->height;
+    int lineSizeAlignment[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecContext, &width, &height, lineSizeAlignment);
+    if (width * frameFormat.bytesPerSample() > frameFormat.lineSize(0) || height > frameFormat.lines(0)) {
+        return false;
+    }
+
+    quint8 *bufferPointer = reinterpret_cast<quint8*>(_directRenderingTarget);
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        const int lineSize = frameFormat.lineSize(i);
+        const quintptr planeAddress = reinterpret_cast<quintptr>(bufferPointer + frameFormat.planeOffset(i));
+        if ((lineSizeAlignment[i] > 0 && lineSize % lineSizeAlignment[i] != 0) ||
+                lineSize % DIRECT_RENDERING_ALIGNMENT != 0 || planeAddress % DIRECT_RENDERING_ALIGNMENT != 0) {
+            return false;
+        }
+    }
+
+    frame->buf[0] = av_buffer_create(bufferPointer, frameFormat.bufferSize(), &doNotFree, nullptr, 0);
+    if (!frame->buf[0]) {
+        return false;
+    }
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        frame->data[i] = bufferPointer + frameFormat.planeOffset(i);
+        frame->linesize[i] = frameFormat.lineSize(i);
+    }
+    frame->extended_data = frame->data;
+
+    // a pixel buffer can only be used for a single frame.
+    _directRenderingTarget = nullptr;
+    _directRenderedFrame = bufferPointer;
+    return true;
 }
 
 void FrameCopyingVideoReader::seekToFrameInternal(const qint64 frameNumber)
 {
+    _currentFrameCopied = false;
+    _pendingSkipFrames = 0;
+    resetFrameBlending();
     performSeek(frameNumber);
     loadFramesUntilTargetFrame(frameNumber);
+    _decodeNanoseconds = 0;
 }
 
-QSize FrameCopyingVideoReader::totalFrameSize()
+/**
+ * Determine the layout of the frame buffers, and the size of the pictures in them as \param pictureSize, from the
+ * first frame. Frames in pixel formats the painters do not support, and frames that are larger than the maximum frame
+ * size, are converted to YUV420P.
+ */
+FrameFormat FrameCopyingVideoReader::frameFormat(QSize &pictureSize)
 {
     _currentFrameNumber = loadNextFrame();
     AVFrame *frame = frameYuv().frame;
-    Q_ASSERT_X(frame->linesize[1] = frame->linesize[0] / 2, __FUNCTION__,
-            "linesize of U plane should be half of Y plane.");
-    return QSize(frame->linesize[0], frame->height);
+    pictureSize = QSize(frame->width, frame->height);
+
+    sws_freeContext(_conversionContext);
+    _conversionContext = nullptr;
+    if (_maximumFrameSize.isValid()) {
+        const QSize coveringSize = pictureSize.scaled(_maximumFrameSize, Qt::KeepAspectRatioByExpanding);
+        if (coveringSize.width() < pictureSize.width()) {
+            // the U and V planes of YUV420P have half the width and height, so keep the dimensions even.
+            pictureSize = QSize(coveringSize.width() & ~1, coveringSize.height() & ~1);
+        }
+    }
+
+    PixelFormat pixelFormat;
+    if (nativePixelFormat(frame->format, pixelFormat) && pictureSize == QSize(frame->width, frame->height)) {
+        int height = frame->height;
+        if (_directRenderingActive) {
+            // the decoder may write beyond the last visible line, so the pixel buffers should have room for that.
+            int width = frame->width;
+            int lineSizeAlignment[AV_NUM_DATA_POINTERS];
+            avcodec_align_dimensions2(codecContext(), &width, &height, lineSizeAlignment);
+            height = qMax(height, frame->height);
+        }
+        return FrameFormat(pixelFormat, QSize(frame->linesize[0], height));
+    }
+
+    qDebug() << "converting" << av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format)) << "frames of"
+             << QSize(frame->width, frame->height) << "to YUV420P frames of" << pictureSize;
+    // the decoder cannot write into the pixel buffers, as they have another layout.
+    _directRenderingActive = false;
+    _convertedSize = pictureSize;
+    _conversionContext = sws_getContext(frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                        _convertedSize.width(), _convertedSize.height(), AV_PIX_FMT_YUV420P,
+                                        CONVERSION_FLAGS, nullptr, nullptr, nullptr);
+    return FrameFormat(PixelFormat::YUV420P, QSize(FFALIGN(_convertedSize.width(), DIRECT_RENDERING_ALIGNMENT),
+                                                   _convertedSize.height()));
 }
 
 bool FrameCopyingVideoReader::event(QEvent *event)
 {
     if (event->type() == OpenVideoFileEventType) {
         OpenVideoFileEvent* openVideoFileEvent = dynamic_cast<OpenVideoFileEvent*>(event);
-        openVideoFileInternal(openVideoFileEvent->_videoFilename);
+        openVideoFileInternal(openVideoFileEvent->_videoFilenames);
         _currentFrameNumber = loadNextFrame();
         return true;
-    } else if (event->type() == CopyNextFrameEventType) {
-        CopyNextFrameEvent* copyNextFrameEvent = dynamic_cast<CopyNextFrameEvent*>(event);
-        copyNextFrameInternal(copyNextFrameEvent->_frameBuffer, copyNextFrameEvent->_skipFrames);
+    } else if (event->type() == ReadFramesEventType) {
+        fillFrameSlots();
+        return true;
+    } else if (event->type() == FrameSlotsEventType) {
+        _frameSlots = dynamic_cast<FrameSlotsEvent*>(event)->_frameSlots;
+        fillFrameSlots();
         return true;
     } else if (event->type() == SeekEventType) {
         seekToFrameInternal(dynamic_cast<SeekEvent*>(event)->_frameNumber);
@@ -6,13 +6,16 @@
 #include <QtCore/QEvent>
 #include <QtCore/QObject>
 #include "genericvideoreader.h"
-#include "framebuffer.h"
+#include "frameblender.h"
+#include "frameformat.h"
+#include "frameslotring.h"
 
 class RealLifeVideo;
 struct AVCodec;
 struct AVCodecContext;
 struct AVFormatContext;
 struct AVFrame;
+struct SwsContext;
 
 class FrameCopyingVideoReader : public GenericVideoReader
 {
@@ -22,24 +25,124 @@ public:
     virtual ~FrameCopyingVideoReader();
 
     void openVideoFile(const QString &videoFilename);
-    void copyNextFrame(const std::weak_ptr<FrameBuffer> &buffer, int skipFrames = 0);
+    /** Open a video that consists of several consecutive video files. See GenericVideoReader. */
+    void openVideoFile(const QStringList &videoFilenames);
+    /**
+     * Set the ring of \param frameSlots the frames are copied into. Frames are copied in the order they are requested,
+     * after skipping the number of frames of the request. If a request allows blending and frame blending is
+     * enabled, the frames between the current frame and the next are blended from the two frames.
+     */
+    void setFrameSlots(const std::shared_ptr<FrameSlotRing> &frameSlots);
+    /** Wake the reader up to fill the requested frame slots. Call this when FrameSlotRing::requestFrame says so. */
+    void readFrames();
     void seekToFrame(qint64 frameNumber);
+    /**
+     * Let the decoder write frames directly into the mapped pixel buffers, instead of copying every frame after
+     * decoding. This is only done for videos with an intra-only codec, as the painter unmaps a pixel buffer as soon as
+     * its frame is loaded, while other codecs keep using frames as references. Other videos still use copying. This
+     * has to be called before a video file is opened.
+     */
+    void setDirectRenderingEnabled(bool enabled);
+    /**
+     * When frames are skipped, because the video is played faster than its normal frame rate, only decode the
+     * skipped frames as far as is needed for decoding the frames that are shown.
+     */
+    void setSpeedAdaptiveDecodingEnabled(bool enabled);
+    /**
+     * Enable frame blending, by setting the number of sub frames that are synthesized for every frame of the video
+     * to more than 1. With frame blending, the frame numbers in the frame slots are sub frame numbers: the frame number
+     * multiplied by \param subFramesPerFrame, plus the index of the sub frame. This has to be called before a video
+     * file is opened. Direct rendering is not used with frame blending, as blending needs the previous frame.
+     */
+    void setFrameBlending(int subFramesPerFrame);
+    /**
+     * Reduce frames that are larger than \param maximumFrameSize while decoding, so they are copied, uploaded and
+     * painted in about that size. Frames keep their aspect ratio, and still cover maximumFrameSize completely. The
+     * decoder reduces the frames itself if the codec supports that, otherwise they are scaled after decoding. This has
+     * to be called before a video file is opened. With an invalid size, the default, frames keep the size of the video.
+     */
+    void setMaximumFrameSize(const QSize &maximumFrameSize);
 
 signals:
     void error(const QString& errorMessage);
+    /**
+     * Emitted when a video is opened.
+     * @param videoSize the size of the pictures of the video.
+     * @param frameFormat the layout of the frames in the frame buffers. This is the pixel format the decoder
+     * produces, if the painters support it, so the frames are copied without conversion. Other formats are
+     * converted to YUV420P.
+     * @param frameRate the average number of frames per second of the video.
+     */
     void videoOpened(const QString& videoFilename, const QSize& videoSize,
-                     const QSize& totalFrameSize, const qint64 numberOfFrames);
-    void frameCopied(int index, qint64 frameNumber, const QSize& frameSize);
+                     const FrameFormat& frameFormat, const qint64 numberOfFrames, const qreal frameRate);
 
 protected:
     virtual bool event(QEvent *);
+    virtual void configureCodecContext(AVCodecContext *codecContext, const AVCodec *codec) override;
 private:
-    virtual void openVideoFileInternal(const QString &videoFilename);
-    void copyNextFrameInternal(std::weak_ptr<FrameBuffer> &buffer, int skipFrames);
+    virtual void openVideoFileInternal(const QStringList &videoFilenames) override;
+    void fillFrameSlots();
+    void copyNextFrameInternal(FrameSlot &slot);
+    void decodeNextFrame();
+    void copyBlendedFrame(FrameSlot &slot);
+    bool blendFrame(const AVFrame *first, const AVFrame *second, void *ptr, const FrameFormat &frameFormat,
+                    int weight);
+    void resetFrameBlending();
+    void decodeNextFrameDirectly(FrameSlot &slot);
+    bool copyFrame(const AVFrame *frame, void *ptr, const FrameFormat &frameFormat);
+    bool convertFrame(const AVFrame *frame, quint8 *bufferPointer, const FrameFormat &frameFormat);
+    qint64 loadFrameAfterSkipping(int skipFrames);
+    static int getBuffer(AVCodecContext *codecContext, AVFrame *frame, int flags);
+    bool isSkippedFrame(const AVFrame *frame) const;
+    bool setupDirectRenderingFrame(AVCodecContext *codecContext, AVFrame *frame);
     void seekToFrameInternal(const qint64 frameNumber);
-    QSize totalFrameSize();
+    FrameFormat frameFormat(QSize &pictureSize);
+
+    /** What to decode after a frame is copied into a slot. */
+    enum class NextFrameDecode {
+        NONE, // nothing, the next frame is blended or decoded directly into the next slot
+        NEXT, // the next frame, after skipping _nextFrameSkipFrames frames
+        FOR_BLENDING // the next frame, to blend the sub frames between it and _blendFrame
+    };
 
     qint64 _currentFrameNumber;
+    NextFrameDecode _nextFrameDecode = NextFrameDecode::NONE;
+    int _nextFrameSkipFrames = 0;
+    std::shared_ptr<FrameSlotRing> _frameSlots;
+    /** the time it took to decode the frame in frameYuv(), including the frames skipped before it */
+    qint64 _decodeNanoseconds = 0;
+    bool _speedAdaptiveDecodingEnabled = false;
+
+    int _subFramesPerFrame = 1;
+    /** the next sub frame to blend between _blendFrame and frameYuv(), or 0 if we're not blending */
+    int _subFrame = 0;
+    std::unique_ptr<AVFrameWrapper> _blendFrame;
+    qint64 _blendFrameNumber = 0;
+    const FrameBlender _frameBlender;
+
+    QSize _maximumFrameSize;
+    /**
+     * converts frames in pixel formats the painters do not support, or frames that are larger than the maximum frame
+     * size. nullptr if the frames need no conversion.
+     */
+    SwsContext *_conversionContext = nullptr;
+    /** the size of the pictures after conversion */
+    QSize _convertedSize;
+
+    bool _directRenderingEnabled = false;
+    /** true if direct rendering is possible for the current video */
+    bool _directRenderingActive = false;
+    /** true if the frame in frameYuv() has already been handed to the painter */
+    bool _currentFrameCopied = false;
+    /** with direct rendering, the frames to skip before decoding the next frame */
+    int _pendingSkipFrames = 0;
+    /** the mapped pixel buffer the decoder can use for the frame that is being decoded */
+    void *_directRenderingTarget = nullptr;
+    FrameFormat _directRenderingTargetFormat;
+    /** the direct rendering target is only used for a frame with this number or later */
+    qint64 _directRenderingFrameNumber = 0;
+    /** the mapped pixel buffer the decoder used for the last decoded frame, if any */
+    void *_directRenderedFrame = nullptr;
 };
 
 #endif // VIDEOREADER_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "frameformat.h"
+
+namespace
+{
+bool isHalfHeightChroma(PixelFormat pixelFormat)
+{
+    return pixelFormat != PixelFormat::YUV422P && pixelFormat != PixelFormat::YUV422P10;
+}
+}
+
+const char *pixelFormatName(PixelFormat pixelFormat)
+{
+    switch (pixelFormat) {
+    case PixelFormat::YUV420P:
+        return "YUV420P";
+    case PixelFormat::YUV422P:
+        return "YUV422P";
+    case PixelFormat::NV12:
+        return "NV12";
+    case PixelFormat::YUV420P10:
+        return "YUV420P10";
+    case PixelFormat::YUV422P10:
+        return "YUV422P10";
+    }
+    return "unknown";
+}
+
+FrameFormat::FrameFormat():
+    _pixelFormat(PixelFormat::YUV420P)
+{
+    // empty
+}
+
+FrameFormat::FrameFormat(PixelFormat pixelFormat, const QSize &frameSize):
+    _pixelFormat(pixelFormat), _frameSize(frameSize)
+{
+    // empty
+}
+
+PixelFormat FrameFormat::pixelFormat() const
+{
+    return _pixelFormat;
+}
+
+const QSize &FrameFormat::frameSize() const
+{
+    return _frameSize;
+}
+
+bool FrameFormat::isValid() const
+{
+    return !_frameSize.isEmpty();
+}
+
+int FrameFormat::planes() const
+{
+    return (_pixelFormat == PixelFormat::NV12) ? 2 : 3;
+}
+
+int FrameFormat::lineSize(int plane) const
+{
+    if (plane == 0 || _pixelFormat == PixelFormat::NV12) {
+        return (_frameSize.width() + 3) & ~3;
+    }
+    return (_frameSize.width() / 2 + 3) & ~3;
+}
+
+int FrameFormat::lines(int plane) const
+{
+    if (plane == 0 || !isHalfHeightChroma(_pixelFormat)) {
+        return _frameSize.height();
+    }
+    return _frameSize.height() / 2;
+}
+
+int FrameFormat::planeOffset(int plane) const
+{
+    int offset = 0;
+    for (int i = 0; i < plane; ++i) {
+        offset += lineSize(i) * lines(i);
+    }
+    return offset;
+}
+
+int FrameFormat::bufferSize() const
+{
+    return planeOffset(planes());
+}
+
+int FrameFormat::bytesPerSample() const
+{
+    return (_pixelFormat == PixelFormat::YUV420P10 || _pixelFormat == PixelFormat::YUV422P10) ? 2 : 1;
+}
+
+int FrameFormat::samplesPerPixel(int plane) const
+{
+    return (plane > 0 && _pixelFormat == PixelFormat::NV12) ? 2 : 1;
+}
+
+bool FrameFormat::operator==(const FrameFormat &other) const
+{
+    return _pixelFormat == other._pixelFormat && _frameSize == other._frameSize;
+}
+
+bool FrameFormat::operator!=(const FrameFormat &other) const
+{
+    return !(*this == other);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAMEFORMAT_H
+#define FRAMEFORMAT_H
+
+#include <QtCore/QMetaType>
+#include <QtCore/QSize>
+
+/**
+ * The pixel formats of frames in the frame buffers of the painters. Decoders output these formats themselves, so
+ * their frames are copied into the frame buffers without conversion.
+ */
+enum class PixelFormat
+{
+    /** 8 bit Y, U and V planes. The U and V planes have half the width and half the height of the Y plane. */
+    YUV420P,
+    /** 8 bit Y, U and V planes. The U and V planes have half the width and the full height of the Y plane. */
+    YUV422P,
+    /** an 8 bit Y plane, followed by a plane of interleaved U and V samples with half the height of the Y plane. */
+    NV12,
+    /** as YUV420P, with 10 bit samples in 16 bit little endian words. */
+    YUV420P10,
+    /** as YUV422P, with 10 bit samples in 16 bit little endian words. */
+    YUV422P10
+};
+
+const char *pixelFormatName(PixelFormat pixelFormat);
+
+/**
+ * The layout of a frame in a frame buffer: the planes of the pixel format, one after the other.
+ *
+ * The frame size is the line size of the Y plane in bytes by the number of lines of the Y plane. The line sizes of the
+ * other planes are multiples of four bytes, so every line can be uploaded to a texture with the default alignment.
+ */
+class FrameFormat
+{
+public:
+    static const int MAXIMUM_PLANES = 3;
+
+    /** Create an invalid frame format. */
+    FrameFormat();
+    FrameFormat(PixelFormat pixelFormat, const QSize &frameSize);
+
+    PixelFormat pixelFormat() const;
+    const QSize &frameSize() const;
+    bool isValid() const;
+
+    int planes() const;
+    /** line size of \param plane, in bytes. */
+    int lineSize(int plane) const;
+    /** number of lines of \param plane. */
+    int lines(int plane) const;
+    /** offset of \param plane from the start of the frame buffer, in bytes. */
+    int planeOffset(int plane) const;
+    /** size in bytes of a frame buffer. */
+    int bufferSize() const;
+
+    /** number of bytes of a single sample. */
+    int bytesPerSample() const;
+    /** number of samples per pixel of \param plane, which is 2 for the interleaved U and V samples of NV12. */
+    int samplesPerPixel(int plane) const;
+
+    bool operator==(const FrameFormat &other) const;
+    bool operator!=(const FrameFormat &other) const;
+
+private:
+    PixelFormat _pixelFormat;
+    QSize _frameSize;
+};
+
+Q_DECLARE_METATYPE(FrameFormat)
+
+#endif // FRAMEFORMAT_H
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "framering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QtCore/QtDebug>
+
+namespace
+{
+/** With fewer buffers, a single slow frame already makes the video stutter. */
+const int MINIMUM_SIZE = 16;
+/** A ring needs a buffer for the shown frame and one to fill, even if the memory budget does not allow it. */
+const int SMALLEST_SIZE = 2;
+/** Sizes for a speed are rounded up to a multiple of this, so small changes of speed give the same size. */
+const int SIZE_STEP = 8;
+/** The current size is kept while the wanted size differs from it by at most this part of it. */
+const qreal RESIZE_THRESHOLD = 0.25;
+/** The size of the ring when it is not known how fast its frames are shown, as before it depended on the speed. */
+const int DEFAULT_SIZE = 150;
+/** Number of seconds of decoded frames the ring holds. */
+const qreal READ_AHEAD_SECONDS = 1.0;
+}
+
+FrameRing::FrameRing(int size)
+{
+    resize(size);
+}
+
+int FrameRing::sizeFor(qint64 memoryBudget, qint64 frameBytes, qreal shownEntriesPerSecond, int currentSize)
+{
+    int size = DEFAULT_SIZE;
+    if (shownEntriesPerSecond > 0) {
+        // the entries that are shown in the read ahead time. A slow decoder needs this read ahead the most, so the
+        // decoding speed does not make the ring smaller.
+        const int shownEntries = static_cast<int>(std::ceil(shownEntriesPerSecond * READ_AHEAD_SECONDS));
+        size = qMax(MINIMUM_SIZE, (shownEntries + SIZE_STEP - 1) / SIZE_STEP * SIZE_STEP);
+    }
+    int budgetSize = size;
+    if (frameBytes > 0) {
+        budgetSize = static_cast<int>(qMin(static_cast<qint64>(std::numeric_limits<int>::max()),
+                                           memoryBudget / frameBytes));
+    }
+    // resizing reallocates all buffers, which is not worth it for a small change.
+    if (currentSize > 0 && currentSize <= budgetSize && qAbs(size - currentSize) <= currentSize * RESIZE_THRESHOLD) {
+        return currentSize;
+    }
+    return qMax(SMALLEST_SIZE, qMin(size, budgetSize));
+}
+
+void FrameRing::resize(int size)
+{
+    _frameNumbers.assign(static_cast<std::size_t>(qMax(1, size)), -1);
+    _writePosition = 0;
+    _readPosition = 0;
+    _fillPosition = 0;
+    resetStatistics();
+}
+
+int FrameRing::size() const
+{
+    return static_cast<int>(_frameNumbers.size());
+}
+
+bool FrameRing::hasBufferToFill() const
+{
+    return _fillPosition != _readPosition;
+}
+
+int FrameRing::buffersToFill() const
+{
+    return (_readPosition - _fillPosition + size()) % size();
+}
+
+int FrameRing::takeBufferToFill()
+{
+    const int index = _fillPosition;
+    _fillPosition = (_fillPosition + 1) % size();
+    return index;
+}
+
+void FrameRing::setFrameLoaded(int index, qint64 frameNumber)
+{
+    if (index < 0 || index >= size()) {
+        // the frame was requested before the ring was resized.
+        return;
+    }
+    if (frameNumber < 0) {
+        // a cancelled request, which does not add a frame after the last written one.
+        _frameNumbers[index] = -1;
+        return;
+    }
+    _writePosition = index;
+    _frameNumbers[index] = frameNumber;
+}
+
+void FrameRing::forgetFrames()
+{
+    std::fill(_frameNumbers.begin(), _frameNumbers.end(), -1);
+    _writePosition = _readPosition;
+}
+
+bool FrameRing::showFrame(qint64 frameNumber)
+{
+    // if we are requested to show the current frame, do nothing.
+    if (_frameNumbers[_readPosition] >= frameNumber) {
+        return false;
+    }
+
+    const int currentlyFilled = filled();
+    _minimumFilled = (_filledSamples == 0) ? currentlyFilled : qMin(_minimumFilled, currentlyFilled);
+    _filledSum += currentlyFilled;
+    ++_filledSamples;
+
+    int newIndex = (_readPosition + 1) % size();
+    while (_frameNumbers[newIndex] < frameNumber && newIndex != _readPosition) {
+        newIndex = (newIndex + 1) % size();
+    }
+    if (_frameNumbers[newIndex] < frameNumber) {
+        qDebug() << "frame not present, have to wait for new frames to arrive to catch up.";
+        ++_underruns;
+    }
+
+    _readPosition = newIndex;
+    return true;
+}
+
+int FrameRing::shownBuffer() const
+{
+    return _readPosition;
+}
+
+qint64 FrameRing::frameNumber(int index) const
+{
+    return _frameNumbers[index];
+}
+
+FrameRingStatistics FrameRing::statistics() const
+{
+    FrameRingStatistics statistics;
+    statistics.size = size();
+    statistics.filled = filled();
+    statistics.minimumFilled = _minimumFilled;
+    statistics.averageFilled = (_filledSamples > 0) ? static_cast<qreal>(_filledSum) / _filledSamples : 0;
+    statistics.underruns = _underruns;
+    return statistics;
+}
+
+void FrameRing::resetStatistics()
+{
+    _minimumFilled = 0;
+    _filledSum = 0;
+    _filledSamples = 0;
+    _underruns = 0;
+}
+
+/**
+ * Frames are loaded in the order the buffers are filled, so the frames after the shown frame, up to the last written
+ * frame, are loaded.
+ */
+int FrameRing::filled() const
+{
+    return (_writePosition - _readPosition + size()) % size();
+}
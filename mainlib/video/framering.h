@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <vector>
+#include <QtCore/QtGlobal>
+
+/** Counters for how full a FrameRing is, so its size can be tuned. */
+struct FrameRingStatistics
+{
+    /** number of frame buffers in the ring */
+    int size = 0;
+    /** number of frames that are loaded, but not shown yet */
+    int filled = 0;
+    /** the lowest number of filled frame buffers when a frame was shown, since the statistics were reset */
+    int minimumFilled = 0;
+    /** the average number of filled frame buffers when a frame was shown, since the statistics were reset */
+    qreal averageFilled = 0;
+    /** number of times a frame had to be shown that was not loaded yet, since the statistics were reset */
+    int underruns = 0;
+};
+
+/**
+ * Keeps track of a ring of frame buffers for a painter: which buffer is shown, which buffer was loaded last and which
+ * buffers should be filled with new frames. The painters keep the buffers themselves.
+ */
+class FrameRing
+{
+public:
+    explicit FrameRing(int size = 0);
+
+    /**
+     * Calculate the number of frame buffers for a ring. The ring holds about a second of the frames that are shown,
+     * so it can bridge a slow frame or a busy disk. It is never bigger than \param memoryBudget allows, even if that
+     * is less than the minimum size for smooth playback.
+     * @param frameBytes the size of a frame buffer, in bytes.
+     * @param shownEntriesPerSecond the number of entries of the ring that are expected to be shown per second, or 0
+     * if not known yet. With frame blending, every sub frame is an entry, and skipped frames take no entry.
+     * @param currentSize the size of the ring with buffers of \param frameBytes, or 0 if there is none. It is returned
+     * when it fits the budget and is close to the size for the speed, so the buffers are not reallocated every time
+     * the speed changes a little.
+     */
+    static int sizeFor(qint64 memoryBudget, qint64 frameBytes, qreal shownEntriesPerSecond, int currentSize = 0);
+
+    /** Resize the ring to \param size buffers. This forgets all loaded frames and resets the statistics. */
+    void resize(int size);
+    int size() const;
+
+    /** true if there are buffers that should be filled with new frames. */
+    bool hasBufferToFill() const;
+    /** number of buffers that should be filled with new frames. */
+    int buffersToFill() const;
+    /** Get the index of the next buffer that should be filled with a new frame. */
+    int takeBufferToFill();
+
+    /**
+     * Mark the buffer at \param index as loaded with frame \param frameNumber. A frameNumber of -1, for a cancelled
+     * request or a frame that could not be loaded, only marks the buffer as empty.
+     */
+    void setFrameLoaded(int index, qint64 frameNumber);
+    /** Forget the frames loaded up to now, including the shown frame, because they are not the frames to show. */
+    void forgetFrames();
+
+    /**
+     * Select the first buffer with a frame number of at least \param frameNumber for showing.
+     * @return true if a new frame was selected. False if the current frame is already at or past frameNumber.
+     */
+    bool showFrame(qint64 frameNumber);
+    /** index of the buffer that is shown */
+    int shownBuffer() const;
+    /** frame number of the frame in the buffer at \param index, or -1 if no frame was loaded. */
+    qint64 frameNumber(int index) const;
+
+    FrameRingStatistics statistics() const;
+    void resetStatistics();
+
+private:
+    int filled() const;
+
+    std::vector<qint64> _frameNumbers;
+    /** The last position in which a frame was written. */
+    int _writePosition = 0;
+    /** The current position from which a frame will displayed. */
+    int _readPosition = 0;
+    /** The next position that will be filled with a new frame. */
+    int _fillPosition = 0;
+
+    int _minimumFilled = 0;
+    qint64 _filledSum = 0;
+    int _filledSamples = 0;
+    int _underruns = 0;
+};
+
+#endif // FRAMERING_H
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "frameslotring.h"
+
+#include <QtCore/QMutexLocker>
+
+FrameSlotRing::FrameSlotRing(int size, int firstSlot):
+    _slots(static_cast<std::size_t>(qMax(1, size))), _size(_slots.size()),
+    _requested(0), _filled(0), _cancelledBefore(0), _readerWaiting(true), _filling(false), _closed(false)
+{
+    // the slot of a sequence number is its remainder, so starting all sequence numbers at firstSlot starts there.
+    const quint64 first = static_cast<quint64>(qMax(0, firstSlot)) % _size;
+    _requested.store(first);
+    _filled.store(first);
+    _cancelledBefore.store(first);
+    _retired = first;
+}
+
+int FrameSlotRing::size() const
+{
+    return static_cast<int>(_size);
+}
+
+bool FrameSlotRing::hasFreeSlot() const
+{
+    return _requested.load(std::memory_order_relaxed) - _retired < _size;
+}
+
+int FrameSlotRing::freeSlots() const
+{
+    return static_cast<int>(_size - (_requested.load(std::memory_order_relaxed) - _retired));
+}
+
+int FrameSlotRing::nextSlotToRequest() const
+{
+    return static_cast<int>(_requested.load(std::memory_order_relaxed) % _size);
+}
+
+bool FrameSlotRing::requestFrame(void *data, const FrameFormat &frameFormat, int skipFrames, bool blendFrames)
+{
+    prepareRequest(0, data, frameFormat, skipFrames, blendFrames);
+    return requestFrames(1);
+}
+
+void FrameSlotRing::prepareRequest(int offset, void *data, const FrameFormat &frameFormat, int skipFrames,
+                                   bool blendFrames)
+{
+    Q_ASSERT(offset < freeSlots());
+    FrameSlot &slot = _slots[(_requested.load(std::memory_order_relaxed) + offset) % _size];
+    slot.data = data;
+    slot.frameFormat = frameFormat;
+    slot.skipFrames = skipFrames;
+    slot.blendFrames = blendFrames;
+    slot.frameNumber = -1;
+}
+
+bool FrameSlotRing::requestFrames(int count)
+{
+    Q_ASSERT(count <= freeSlots());
+    if (count <= 0) {
+        return false;
+    }
+    _requested.store(_requested.load(std::memory_order_relaxed) + count);
+
+    // this pairs with waitForRequests(): either the reader sees the new requests, or we see that it is waiting.
+    return _readerWaiting.exchange(false);
+}
+
+void FrameSlotRing::cancelRequests()
+{
+    _cancelledBefore.store(_requested.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+bool FrameSlotRing::hasFilledSlot() const
+{
+    return _filled.load(std::memory_order_acquire) != _retired;
+}
+
+int FrameSlotRing::filledSlots() const
+{
+    return static_cast<int>(_filled.load(std::memory_order_acquire) - _retired);
+}
+
+int FrameSlotRing::filledSlotIndex() const
+{
+    return static_cast<int>(_retired % _size);
+}
+
+const FrameSlot &FrameSlotRing::filledSlot() const
+{
+    return _slots[_retired % _size];
+}
+
+bool FrameSlotRing::filledSlotCancelled() const
+{
+    return _retired < _cancelledBefore.load(std::memory_order_relaxed);
+}
+
+void FrameSlotRing::retireSlot()
+{
+    Q_ASSERT(hasFilledSlot());
+    ++_retired;
+}
+
+void FrameSlotRing::close()
+{
+    _closed.store(true);
+    QMutexLocker locker(&_closeMutex);
+    while (_filling.load()) {
+        // the reader is copying a frame into a slot, or decoding one into it with direct rendering.
+        _fillingStopped.wait(&_closeMutex);
+    }
+}
+
+FrameSlot *FrameSlotRing::slotToFill()
+{
+    // this pairs with close(): either the painter sees we're filling a slot, or we see that the ring was closed.
+    _filling.store(true);
+    if (_closed.load()) {
+        stopFilling();
+        return nullptr;
+    }
+    // skip the cancelled requests. The painter knows they were cancelled, so we do not have to touch their slots.
+    const quint64 requested = _requested.load();
+    const quint64 cancelledBefore = _cancelledBefore.load(std::memory_order_acquire);
+    const quint64 filled = _filled.load(std::memory_order_relaxed);
+    if (filled < cancelledBefore) {
+        _filled.store(qMin(cancelledBefore, requested), std::memory_order_release);
+    }
+    if (!hasRequests()) {
+        stopFilling();
+        return nullptr;
+    }
+    return &_slots[_filled.load(std::memory_order_relaxed) % _size];
+}
+
+void FrameSlotRing::setSlotFilled()
+{
+    _filled.store(_filled.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    stopFilling();
+}
+
+bool FrameSlotRing::waitForRequests()
+{
+    _readerWaiting.store(true);
+    if (_closed.load() || !hasRequests()) {
+        return true;
+    }
+    // requests arrived after all. If the painter did not see we were waiting, we should handle them ourselves.
+    return !_readerWaiting.exchange(false);
+}
+
+bool FrameSlotRing::hasRequests() const
+{
+    return _filled.load(std::memory_order_relaxed) != _requested.load();
+}
+
+void FrameSlotRing::stopFilling()
+{
+    // this pairs with close(): either close() sees we stopped filling, or we see that the ring was closed and wake it.
+    _filling.store(false);
+    if (_closed.load()) {
+        QMutexLocker locker(&_closeMutex);
+        _fillingStopped.wakeAll();
+    }
+}
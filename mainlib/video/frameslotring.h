@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAMESLOTRING_H
+#define FRAMESLOTRING_H
+
+#include <atomic>
+#include <vector>
+
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+#include "frameformat.h"
+
+/** A frame buffer in a FrameSlotRing, with the request for the frame to load into it and the result. */
+struct FrameSlot
+{
+    /** the memory to load the frame into. Set by the painter when the frame is requested. */
+    void *data = nullptr;
+    /** the layout of the frame buffer */
+    FrameFormat frameFormat;
+    /** number of frames to skip before loading the frame */
+    int skipFrames = 0;
+    /** whether the frames up to the next frame may be blended, see FrameCopyingVideoReader::setFrameBlending. */
+    bool blendFrames = false;
+
+    /** number of the loaded frame, or -1 if no frame could be loaded. Set by the reader. */
+    qint64 frameNumber = -1;
+    /** time it took to decode the frame, including the skipped frames */
+    qint64 decodeNanoseconds = 0;
+    /**
+     * time it took to copy the frame into the frame buffer. This is 0 for a frame that was decoded directly into the
+     * frame buffer. For a blended frame, it is the time it took to blend the frame.
+     */
+    qint64 copyNanoseconds = 0;
+};
+
+/**
+ * A ring of frame slots that the painter, on the gui thread, and the video reader, on its own thread, use to hand
+ * frame buffers to each other without locks, memory allocation or events for every frame.
+ *
+ * Three sequence numbers keep track of the slots: the painter requests a frame for a free slot, the reader fills the
+ * slot and the painter retires it, after which it can show the frame. Slots are requested, filled and retired in
+ * order, so a slot with sequence number n is at index n % size(). Every slot is written by only one thread at a time:
+ * the painter writes the request before publishing the requested sequence number, the reader writes the result before
+ * publishing the filled sequence number.
+ *
+ * The reader does not poll for requests. When it runs out of requests, it marks itself waiting, and the painter wakes
+ * it up when it requests a frame while the reader is waiting.
+ *
+ * Closing the ring is the only moment the painter waits for the reader. It sleeps on a wait condition until the
+ * reader is done with the slot it is filling, which takes a copy, or a decode with direct rendering.
+ */
+class FrameSlotRing
+{
+public:
+    /**
+     * Create a ring of \param size slots. The first frame is requested for the slot at \param firstSlot, so a painter
+     * that already holds frames in the buffers before it can request the frames after them.
+     */
+    explicit FrameSlotRing(int size, int firstSlot = 0);
+
+    int size() const;
+
+    /*
+     * Methods for the painter.
+     */
+    /** true if a frame can be requested for the next slot, because that slot has been retired. */
+    bool hasFreeSlot() const;
+    /** number of slots frames can be requested for. */
+    int freeSlots() const;
+    /** index of the slot the next request will be for. */
+    int nextSlotToRequest() const;
+    /**
+     * Request a frame for the next slot.
+     * @return true if the reader was waiting for requests and has to be woken up.
+     */
+    bool requestFrame(void *data, const FrameFormat &frameFormat, int skipFrames, bool blendFrames);
+    /**
+     * Prepare the request for the slot \param offset places after the next slot to request. Prepared requests are
+     * handed to the reader all at once with requestFrames().
+     */
+    void prepareRequest(int offset, void *data, const FrameFormat &frameFormat, int skipFrames, bool blendFrames);
+    /**
+     * Request frames for the next \param count slots, which should have been prepared with prepareRequest(). The
+     * reader fills them in one go.
+     * @return true if the reader was waiting for requests and has to be woken up.
+     */
+    bool requestFrames(int count);
+    /**
+     * Cancel all requests up to now. The reader skips the requests it has not started on yet, and the frames of all
+     * cancelled requests are reported as cancelled by filledSlotCancelled().
+     */
+    void cancelRequests();
+    /** true if the reader filled a slot that has not been retired yet. */
+    bool hasFilledSlot() const;
+    /** number of slots the reader filled that have not been retired yet. */
+    int filledSlots() const;
+    /** index of the oldest filled slot. */
+    int filledSlotIndex() const;
+    const FrameSlot &filledSlot() const;
+    /** true if the request for the oldest filled slot was cancelled, so its frame should not be used. */
+    bool filledSlotCancelled() const;
+    /** Retire the oldest filled slot, so its frame can be shown and the slot can be requested again later. */
+    void retireSlot();
+    /**
+     * Stop the reader from filling slots, and wait until it is done with a slot it is filling at the moment. After
+     * this, the memory of the slots can be freed or unmapped.
+     */
+    void close();
+
+    /*
+     * Methods for the reader.
+     */
+    /** Get the next slot to fill, or nullptr if there are no requests or the ring was closed. */
+    FrameSlot *slotToFill();
+    /** Publish the slot from slotToFill() as filled. */
+    void setSlotFilled();
+    /**
+     * Tell the painter that the reader is waiting for requests.
+     * @return true if the reader can wait for the painter to wake it up, false if new requests arrived in the meantime.
+     */
+    bool waitForRequests();
+
+private:
+    bool hasRequests() const;
+    /** Mark the reader as not filling a slot, and wake up close() if it is waiting for that. */
+    void stopFilling();
+
+    std::vector<FrameSlot> _slots;
+    const quint64 _size;
+
+    // The sequence numbers are written by different threads, so they are kept on different cache lines.
+    std::atomic<quint64> _requested;
+    char _requestedPadding[64];
+    std::atomic<quint64> _filled;
+    char _filledPadding[64];
+    /** the reader skips requests before this sequence number */
+    std::atomic<quint64> _cancelledBefore;
+    /** only used by the painter */
+    quint64 _retired = 0;
+
+    std::atomic<bool> _readerWaiting;
+    std::atomic<bool> _filling;
+    std::atomic<bool> _closed;
+    /** protects nothing but the wait of close() for _fillingStopped. */
+    QMutex _closeMutex;
+    QWaitCondition _fillingStopped;
+};
+
+#endif // FRAMESLOTRING_H
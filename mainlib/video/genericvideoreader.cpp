@@ -2,7 +2,9 @@
 
 #include <array>
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QSize>
+#include <QtCore/QTime>
 #include <QtCore/QtDebug>
 
 extern "C" {
@@ -10,8 +12,69 @@ extern "C" {
 #include <libavformat/avformat.h>
 }
 
+#include "importer/videoindexcache.h"
+#include "demuxer.h"
+#include "videoindexer.h"
+#include "throttledfile.h"
+#include "videofilesource.h"
+
 namespace {
 const int ERROR_STR_BUF_SIZE = 128;
+/** size of the buffer of the I/O context, the same as the buffer libav uses for its own file protocol. */
+const int IO_BUFFER_SIZE = 32 * 1024;
+/**
+ * the next video file of a segmented video is opened when playback is this close to the end of the current file. This
+ * leaves time for opening a file on a slow network share, while only one extra file is open most of the time.
+ */
+const int NEXT_SEGMENT_PREPARE_SECONDS = 10;
+
+/** Convert a VideoDecoderThreadType to libav's thread type flags */
+int libavThreadType(const VideoDecoderThreadType threadType)
+{
+    switch (threadType) {
+    case VideoDecoderThreadType::FRAME:
+        return FF_THREAD_FRAME;
+    case VideoDecoderThreadType::SLICE:
+        return FF_THREAD_SLICE;
+    default:
+        return FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+}
+
+/** read_packet callback of the I/O context, which reads from the VideoFileSource in \param opaque. */
+int readFileSource(void *opaque, uint8_t *buffer, int bufferSize)
+{
+    VideoFileSource *fileSource = static_cast<VideoFileSource*>(opaque);
+    const qint64 bytesRead = fileSource->read(reinterpret_cast<char*>(buffer), bufferSize);
+    if (bytesRead < 0) {
+        return AVERROR(EIO);
+    }
+    return (bytesRead == 0) ? AVERROR_EOF : static_cast<int>(bytesRead);
+}
+
+/** seek callback of the I/O context, which seeks in the VideoFileSource in \param opaque. */
+int64_t seekFileSource(void *opaque, int64_t offset, int whence)
+{
+    VideoFileSource *fileSource = static_cast<VideoFileSource*>(opaque);
+    if (whence & AVSEEK_SIZE) {
+        return fileSource->size();
+    }
+    qint64 position;
+    switch (whence & ~AVSEEK_FORCE) {
+    case SEEK_SET:
+        position = offset;
+        break;
+    case SEEK_CUR:
+        position = fileSource->position() + offset;
+        break;
+    case SEEK_END:
+        position = fileSource->size() + offset;
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+    return fileSource->seek(position) ? position : AVERROR(EINVAL);
+}
 }
 GenericVideoReader::GenericVideoReader(QObject *parent) :
     QObject(parent)
@@ -24,6 +87,33 @@ GenericVideoReader::~GenericVideoReader()
     close();
 }
 
+void GenericVideoReader::setDecoderThreading(int threadCount, VideoDecoderThreadType threadType)
+{
+    _decoderThreadCount = qMax(1, threadCount);
+    _decoderThreadType = threadType;
+}
+
+void GenericVideoReader::setPipelineTimings(const std::shared_ptr<PipelineTimings> &pipelineTimings)
+{
+    _pipelineTimings = pipelineTimings;
+}
+
+void GenericVideoReader::setThreadRole(indoorcycling::ThreadRole threadRole)
+{
+    _threadRole = threadRole;
+}
+
+void GenericVideoReader::setFileAccess(VideoFileAccess fileAccess)
+{
+    _fileAccess = fileAccess;
+}
+
+void GenericVideoReader::setFileThrottle(qint64 bytesPerSecond, int latencyMicroseconds)
+{
+    _throttleBytesPerSecond = bytesPerSecond;
+    _throttleLatencyMicroseconds = latencyMicroseconds;
+}
+
 void GenericVideoReader::initialize()
 {
     if (!_initialized) {
@@ -35,13 +125,12 @@ void GenericVideoReader::initialize()
 
 void GenericVideoReader::close()
 {
-    _videoStream = nullptr;
-    if (_codecContext) {
-        avcodec_close(_codecContext);
-    }
-    if (_formatContext) {
-        avformat_close_input(&_formatContext);
-    }
+    // the next segment is opened on another thread, so wait for it before closing it.
+    takeNextSegment();
+    _segment.reset();
+    _segmentFilenames.clear();
+    _segmentFrameNumbers.clear();
+    _segmentIndex = 0;
 }
 
 /**
@@ -53,6 +142,9 @@ void GenericVideoReader::loadFramesUntilTargetFrame(qint64 targetFrameNumber)
     bool seekAgain;
     bool extraSeekDone = false;
     qint64 currentFrameNumber = -1;
+    // the frames before the target frame are not shown, so we don't need to reconstruct those that are not
+    // used as a reference.
+    _discardNonReferenceFramesBefore = targetFrameNumber;
     do {
         seekAgain = false;
         currentFrameNumber = loadNextFrame();
@@ -62,16 +154,29 @@ void GenericVideoReader::loadFramesUntilTargetFrame(qint64 targetFrameNumber)
         // targetted frame. In that case, we do another seek to a frame number
         // some frames before the targetted frame to hopefully get a keyframe there.
         // We only do this once to prevent us from causing an endless loop here.
-        if (!extraSeekDone && currentFrameNumber > 100 && currentFrameNumber > targetFrameNumber) {
+        // When there is an index for the video, we seek directly to the key frame, so this is not needed.
+        if (!hasVideoIndex() && !extraSeekDone && currentFrameNumber > 100 && currentFrameNumber > targetFrameNumber) {
             performSeek(targetFrameNumber - 500);
             seekAgain = true;
             extraSeekDone = true;
         }
 
     } while (seekAgain || (currentFrameNumber >= 0 && currentFrameNumber < targetFrameNumber));
+    _discardNonReferenceFramesBefore = -1;
     emit seekReady(currentFrameNumber);
 }
 
+qint64 GenericVideoReader::skipToFrame(qint64 frameNumber)
+{
+    qint64 currentFrameNumber;
+    _discardNonReferenceFramesBefore = frameNumber;
+    do {
+        currentFrameNumber = loadNextFrame();
+    } while (currentFrameNumber >= 0 && currentFrameNumber < frameNumber);
+    _discardNonReferenceFramesBefore = -1;
+    return currentFrameNumber;
+}
+
 void GenericVideoReader::printError(int errorNumber, const QString &message)
 {
     std::array<char, ERROR_STR_BUF_SIZE> errorString;
@@ -90,89 +195,412 @@ void GenericVideoReader::printError(const QString &message)
 void GenericVideoReader::performSeek(qint64 targetFrameNumber)
 {
     qDebug() << "seeking to" << targetFrameNumber;
-    AVStream* videoStream = formatContext()->streams[_currentVideoStream];
-    double timeBase = av_q2d(videoStream->time_base);
-    double framerate = av_q2d(videoStream->avg_frame_rate);
-
-    qint64  ts = targetFrameNumber / (timeBase * framerate);
-    av_seek_frame(formatContext(), _currentVideoStream, ts,
-                  AVSEEK_FLAG_FRAME | AVSEEK_FLAG_BACKWARD);
+    if (!_segment) {
+        return;
+    }
+    const int segmentIndex = segmentForFrame(targetFrameNumber);
+    if (segmentIndex != _segmentIndex && !switchToSegment(segmentIndex)) {
+        return;
+    }
+    // a frame that was decoded ahead is from the start of the segment, so it is of no use after a seek.
+    av_frame_free(&_segment->decodedFrame);
+    const qint64 segmentFrameNumber = targetFrameNumber - _segment->firstFrameNumber;
+    if (!_segment->index.isEmpty()) {
+        // seek directly to the key frame before the target frame, so we'll have to decode at most one GOP.
+        if (_segment->fileSource) {
+            const VideoIndexEntry &keyFrame = _segment->index.entries()[
+                    static_cast<std::size_t>(_segment->index.keyFrameBefore(segmentFrameNumber))];
+            _segment->fileSource->prefetch(keyFrame.position());
+        }
+        _segment->demuxer(_pipelineTimings).seek(_segment->index.seekTimestampForFrame(segmentFrameNumber),
+                                                 AVSEEK_FLAG_BACKWARD);
         avcodec_flush_buffers(codecContext());
+        return;
+    }
+    double timeBase = av_q2d(_segment->stream->time_base);
+    double framerate = av_q2d(_segment->stream->avg_frame_rate);
+
+    qint64  ts = segmentFrameNumber / (timeBase * framerate);
+    _segment->demuxer(_pipelineTimings).seek(ts, AVSEEK_FLAG_FRAME | AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(codecContext());
 }
 
+/**
+ * Decode the next frame. Packets are read by the demuxer on its own thread, so reading from disk overlaps with
+ * decoding. When frame threading is enabled, avcodec_send_packet hands the packet to one of the decoder threads
+ * and returns, so the decoding of the next frames overlaps with copying the current frame. At the end of a video file
+ * of a segmented video, decoding continues with the next file.
+ * @return the frame number of the decoded frame, or -1 at the end of the file or on a decoding error.
+ */
 qint64 GenericVideoReader::loadNextFrame()
 {
-    AVPacket packet;
-    int frameFinished = 0;
-    while (!frameFinished) {
-        if (av_read_frame(formatContext(), &packet) < 0) {
-            qDebug() << "end of file reached";
-            return -1;
+    if (!_segment) {
+        return -1;
+    }
+    AVFrame* frame = _frameYuv->frame;
+    int result = receiveFrame(frame);
+    while (result == AVERROR_EOF && _segmentIndex + 1 < _segmentFilenames.size() &&
+           switchToSegment(_segmentIndex + 1)) {
+        if (_segment->decodedFrame) {
+            // the first frame of the next file was decoded in the background.
+            av_frame_unref(frame);
+            av_frame_move_ref(frame, _segment->decodedFrame);
+            av_frame_free(&_segment->decodedFrame);
+            result = 0;
+        } else {
+            result = receiveFrame(frame);
         }
-        if (packet.stream_index == _currentVideoStream) {
-            avcodec_decode_video2(codecContext(), _frameYuv->frame,
-                                  &frameFinished, &packet);
+    }
+    if (result < 0) {
+        if (result == AVERROR_EOF) {
+            qDebug() << "end of file reached";
+        } else {
+            printError(result, "Unable to decode frame");
         }
+        return -1;
     }
 
+    // With frame threading or B-frames, the packet that completed the frame is not the packet the frame was
+    // decoded from, so use the timestamps that were copied to the frame by libav.
     qint64 currentFrameNumber;
-    qint64 pts = packet.pts;
-    if (pts == static_cast<qint64>(AV_NOPTS_VALUE)) {
-        currentFrameNumber = packet.dts;
+    const qint64 pts = frame->pts;
+    const qint64 dts = frame->pkt_dts;
+    if (!_segment->index.isEmpty()) {
+        currentFrameNumber = _segment->timestampToFrameNumber((pts == static_cast<qint64>(AV_NOPTS_VALUE)) ? dts : pts);
+    } else if (pts == static_cast<qint64>(AV_NOPTS_VALUE)) {
+        currentFrameNumber = _segment->firstFrameNumber + dts;
     } else {
-        currentFrameNumber = timestampToFrameNumber(pts);
+        currentFrameNumber = _segment->timestampToFrameNumber(pts);
     }
-
-    av_free_packet(&packet);
+    prepareNextSegment(currentFrameNumber);
     return currentFrameNumber;
 }
 
+/**
+ * Receive the next frame of the current video file from the decoder, feeding it packets until it has one.
+ * @return the result of avcodec_receive_frame.
+ */
+int GenericVideoReader::receiveFrame(AVFrame *frame)
+{
+    int result;
+    while ((result = avcodec_receive_frame(codecContext(), frame)) == AVERROR(EAGAIN)) {
+        // at the end of the file, takePacket() returns a null packet, which puts the decoder in draining mode,
+        // so it returns the frames it still holds.
+        AVPacket* packet = _segment->demuxer(_pipelineTimings).takePacket();
+        // the skip setting is picked up by the decoder for every packet, so only the packets of frames that will
+        // not be shown are decoded partially.
+        codecContext()->skip_frame = AVDISCARD_DEFAULT;
+        if (packet && _discardNonReferenceFramesBefore >= 0 && packet->pts != static_cast<qint64>(AV_NOPTS_VALUE) &&
+                timestampToFrameNumber(packet->pts) < _discardNonReferenceFramesBefore) {
+            codecContext()->skip_frame = AVDISCARD_NONREF;
+        }
+        result = avcodec_send_packet(codecContext(), packet);
+        av_packet_free(&packet);
+        if (result < 0 && result != AVERROR_EOF) {
+            // a single corrupt packet should not stop the video, so we continue with the next packet.
+            printError(result, "Unable to decode packet");
+        }
+    }
+    return result;
+}
+
 qint64 GenericVideoReader::totalNumberOfFrames()
 {
-    AVStream* videoStream = formatContext()->streams[_currentVideoStream];
-    return timestampToFrameNumber(videoStream->duration);
+    return _segmentFrameNumbers.empty() ? 0 : _segmentFrameNumbers.back();
 }
 
 void GenericVideoReader::openVideoFileInternal(const QString &videoFilename)
+{
+    openVideoFileInternal(QStringList(videoFilename));
+}
+
+void GenericVideoReader::openVideoFileInternal(const QStringList &videoFilenames)
 {
     initialize();
-    if (_formatContext && QString(_formatContext->filename) == videoFilename) {
+    if (_segment && _segmentFilenames == videoFilenames) {
         return;
     }
     close();
-    int errorNr = avformat_open_input(&_formatContext, videoFilename.toStdString().c_str(),
+    _segmentFilenames = videoFilenames;
+    _segment = openSegment(videoFilenames.value(0), 0, nullptr);
+    _frameYuv.reset(new AVFrameWrapper);
+    determineSegmentFrameNumbers(false);
+}
+
+/**
+ * Open \param videoFilename as a segment of the video, with the number of its first frame in the whole video. The
+ * codec context is configured like \param configuredLike, or with configureCodecContext() for the first video file.
+ * Opening a segment does not change the state of the reader, so the next segment of a video can be opened on another
+ * thread.
+ * @return the segment, or nullptr if the video file could not be opened.
+ */
+std::shared_ptr<VideoSegment> GenericVideoReader::openSegment(const QString &videoFilename, qint64 firstFrameNumber,
+                                                              const AVCodecContext *configuredLike)
+{
+    std::shared_ptr<VideoSegment> segment = std::make_shared<VideoSegment>(videoFilename, firstFrameNumber);
+    segment->threadRole = _threadRole;
+    if (_fileAccess != VideoFileAccess::DIRECT || _throttleBytesPerSecond > 0 || _throttleLatencyMicroseconds > 0) {
+        if (!openFileSource(*segment)) {
+            printError(QString("Unable to open %1").arg(videoFilename));
+        }
+    }
+    int errorNr = avformat_open_input(&segment->formatContext, videoFilename.toStdString().c_str(),
                                                                               NULL, NULL);
     if (errorNr != 0) {
         printError(errorNr, QString("Unable to open %1").arg(videoFilename));
+        return nullptr;
     }
-    errorNr = avformat_find_stream_info(_formatContext, NULL);
+    errorNr = avformat_find_stream_info(segment->formatContext, NULL);
     if (errorNr < 0) {
         printError(errorNr, QString("Unable to find video stream"));
     }
-    av_dump_format(_formatContext, 0, videoFilename.toStdString().c_str(), 0);
+    av_dump_format(segment->formatContext, 0, videoFilename.toStdString().c_str(), 0);
 
-    _currentVideoStream = findVideoStream(_formatContext);
-    if (_currentVideoStream < 0) {
+    segment->streamIndex = findVideoStream(segment->formatContext);
+    if (segment->streamIndex < 0) {
         printError("Unable to find video stream");
+        return nullptr;
     }
-    _videoStream = _formatContext->streams[_currentVideoStream];
+    segment->stream = segment->formatContext->streams[segment->streamIndex];
 
-    _codecContext = _videoStream->codec;
-    if (!_codecContext) {
+    segment->codecContext = segment->stream->codec;
+    if (!segment->codecContext) {
         printError("Unable to open codec context");
+        return nullptr;
     }
 
-    _codec = avcodec_find_decoder(_codecContext->codec_id);
-    if (!_codec) {
+    segment->codec = avcodec_find_decoder(segment->codecContext->codec_id);
+    if (!segment->codec) {
         printError("Unable to find codec");
+        return nullptr;
     }
 
-    errorNr = avcodec_open2(_codecContext, _codec, NULL);
+    if (configuredLike) {
+        segment->codecContext->thread_count = configuredLike->thread_count;
+        segment->codecContext->thread_type = configuredLike->thread_type;
+        segment->codecContext->lowres = configuredLike->lowres;
+        segment->codecContext->get_buffer2 = configuredLike->get_buffer2;
+        segment->codecContext->opaque = configuredLike->opaque;
+    } else {
+        segment->codecContext->thread_count = _decoderThreadCount;
+        segment->codecContext->thread_type = libavThreadType(_decoderThreadType);
+        configureCodecContext(segment->codecContext, segment->codec);
+    }
+    errorNr = avcodec_open2(segment->codecContext, segment->codec, NULL);
     if (errorNr < 0) {
         printError(errorNr, "Unable to open codec");
+        return nullptr;
     }
+    return segment;
+}
 
-    _frameYuv.reset(new AVFrameWrapper);
+/**
+ * Open the video file of \param segment as a VideoFileSource, and let libav read from it through a custom I/O context,
+ * instead of with its own file protocol. The file name is still passed to libav when the input is opened, so the
+ * format can be guessed from the extension.
+ */
+bool GenericVideoReader::openFileSource(VideoSegment &segment)
+{
+    std::unique_ptr<QFile> file;
+    if (_throttleBytesPerSecond > 0 || _throttleLatencyMicroseconds > 0) {
+        file.reset(new ThrottledFile(segment.filename, _throttleBytesPerSecond, _throttleLatencyMicroseconds));
+    } else {
+        file.reset(new QFile(segment.filename));
+    }
+    segment.fileSource.reset(new VideoFileSource(std::move(file), _fileAccess));
+    segment.fileSource->setThreadRole(segment.threadRole);
+    if (!segment.fileSource->open()) {
+        segment.fileSource.reset();
+        return false;
+    }
+
+    unsigned char *buffer = static_cast<unsigned char*>(av_malloc(IO_BUFFER_SIZE));
+    segment.ioContext = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, segment.fileSource.get(), &readFileSource,
+                                           nullptr, &seekFileSource);
+    segment.formatContext = avformat_alloc_context();
+    segment.formatContext->pb = segment.ioContext;
+    return true;
+}
+
+void GenericVideoReader::configureCodecContext(AVCodecContext *, const AVCodec *)
+{
+    // empty
+}
+
+void GenericVideoReader::loadVideoIndex(bool buildIfMissing, const std::atomic<bool> *cancelled)
+{
+    if (!_segment) {
+        return;
+    }
+    loadSegmentIndex(*_segment);
+    if (_segment->index.isEmpty() && buildIfMissing) {
+        QTime time;
+        time.start();
+        _segment->index = _segment->buildVideoIndex(cancelled);
+        qDebug() << "building index of" << _segment->index.numberOfFrames() << "frames took" << time.elapsed() << "ms";
+        if (!_segment->index.isEmpty()) {
+            VideoIndexCache().save(QFileInfo(_segment->filename), _segment->index);
+        }
+    }
+    determineSegmentFrameNumbers(buildIfMissing);
+}
+
+/** Load the frame index of \param segment from the cache, if it is there. */
+void GenericVideoReader::loadSegmentIndex(VideoSegment &segment) const
+{
+    std::unique_ptr<VideoIndex> cachedIndex = VideoIndexCache().load(QFileInfo(segment.filename));
+    if (cachedIndex) {
+        segment.index = *cachedIndex;
+    }
+}
+
+bool GenericVideoReader::hasVideoIndex() const
+{
+    return _segment && !_segment->index.isEmpty();
+}
+
+int GenericVideoReader::numberOfSegments() const
+{
+    return _segmentFilenames.size();
+}
+
+/**
+ * Determine the number of frames of a video file that is not the current segment. The frame index of the file is
+ * used if it is in the cache, otherwise the file is opened, to build the index if \param buildIndexIfMissing is true,
+ * or to estimate the number of frames from the duration.
+ */
+qint64 GenericVideoReader::segmentNumberOfFrames(const QString &videoFilename, bool buildIndexIfMissing)
+{
+    const QFileInfo videoFileInfo(videoFilename);
+    VideoIndexCache cache;
+    std::unique_ptr<VideoIndex> cachedIndex = cache.load(videoFileInfo);
+    if (cachedIndex) {
+        return cachedIndex->numberOfFrames();
+    }
+    std::shared_ptr<VideoSegment> segment = openSegment(videoFilename, 0, codecContext());
+    if (!segment) {
+        return 0;
+    }
+    if (buildIndexIfMissing) {
+        segment->index = segment->buildVideoIndex();
+        if (!segment->index.isEmpty()) {
+            cache.save(videoFileInfo, segment->index);
+        }
+    }
+    return segment->numberOfFrames();
+}
+
+/** Determine the numbers of the first frames of the video files, from the number of frames in each of them. */
+void GenericVideoReader::determineSegmentFrameNumbers(bool buildIndexesIfMissing)
+{
+    _segmentFrameNumbers.assign(1, 0);
+    if (!_segment) {
+        return;
+    }
+    for (int i = 0; i < _segmentFilenames.size(); ++i) {
+        const qint64 numberOfFrames = (i == _segmentIndex) ? _segment->numberOfFrames() :
+                                                             segmentNumberOfFrames(_segmentFilenames[i],
+                                                                                   buildIndexesIfMissing);
+        _segmentFrameNumbers.push_back(_segmentFrameNumbers.back() + numberOfFrames);
+    }
+}
+
+/** Get the index of the video file that contains \param frameNumber. */
+int GenericVideoReader::segmentForFrame(qint64 frameNumber) const
+{
+    int segmentIndex = 0;
+    while (segmentIndex + 1 < _segmentFilenames.size() &&
+           frameNumber >= _segmentFrameNumbers[static_cast<std::size_t>(segmentIndex + 1)]) {
+        ++segmentIndex;
+    }
+    return segmentIndex;
+}
+
+/**
+ * Continue decoding with the video file at \param segmentIndex. If that file was opened in the background, it is
+ * taken over, otherwise it is opened now.
+ * @return false if the file could not be opened, or is encoded differently than the current file.
+ */
+bool GenericVideoReader::switchToSegment(int segmentIndex)
+{
+    const bool prepared = (segmentIndex == _nextSegmentIndex);
+    std::shared_ptr<VideoSegment> segment = takeNextSegment();
+    if (!prepared || !segment) {
+        segment = openSegment(_segmentFilenames[segmentIndex],
+                              _segmentFrameNumbers[static_cast<std::size_t>(segmentIndex)], codecContext());
+        if (segment) {
+            loadSegmentIndex(*segment);
+        }
+    }
+    if (!segment) {
+        return false;
+    }
+    if (segment->codecContext->width != codecContext()->width ||
+            segment->codecContext->height != codecContext()->height ||
+            segment->codecContext->pix_fmt != codecContext()->pix_fmt) {
+        printError(QString("%1 is not encoded like the other video files of the video").arg(segment->filename));
+        return false;
+    }
+    qDebug() << "continuing with" << segment->filename << (prepared ? "opened in the background" : "");
+    _segment = segment;
+    _segmentIndex = segmentIndex;
+    return true;
+}
+
+/**
+ * Start opening the next video file in the background when \param currentFrameNumber is near the end of the current
+ * file. When the decoder does not use our own buffers for its frames, the first frame of the file is decoded as well.
+ * A missing frame index of the file is queued to be built, so the video files of a video are indexed as they are
+ * played, instead of all of them when the video is opened.
+ */
+void GenericVideoReader::prepareNextSegment(qint64 currentFrameNumber)
+{
+    const int nextSegmentIndex = _segmentIndex + 1;
+    if (nextSegmentIndex >= _segmentFilenames.size() || _nextSegmentIndex == nextSegmentIndex) {
+        return;
+    }
+    const qint64 nextFirstFrameNumber = _segmentFrameNumbers[static_cast<std::size_t>(nextSegmentIndex)];
+    const qreal frameRate = av_q2d(_segment->stream->avg_frame_rate);
+    if (currentFrameNumber < nextFirstFrameNumber - NEXT_SEGMENT_PREPARE_SECONDS * qMax(frameRate, 1.0)) {
+        return;
+    }
+    takeNextSegment();
+    const QString videoFilename = _segmentFilenames[nextSegmentIndex];
+    const std::shared_ptr<PipelineTimings> pipelineTimings = _pipelineTimings;
+    _nextSegmentIndex = nextSegmentIndex;
+    // the current segment is kept alive until the next one is opened, as its codec context is used as an example.
+    const std::shared_ptr<VideoSegment> currentSegment = _segment;
+    _nextSegment = QtConcurrent::run([this, videoFilename, nextFirstFrameNumber, currentSegment, pipelineTimings]() {
+        std::shared_ptr<VideoSegment> segment = openSegment(videoFilename, nextFirstFrameNumber,
+                                                            currentSegment->codecContext);
+        if (segment) {
+            loadSegmentIndex(*segment);
+            if (segment->index.isEmpty()) {
+                // building the index now would keep the switch waiting, the file plays with estimated frame
+                // numbers this time.
+                VideoIndexer::enqueue(videoFilename);
+            }
+            // a decoder with a get_buffer2 of our own may write into the buffers of the reader, which can only be
+            // done on the thread of the reader.
+            if (segment->codecContext->get_buffer2 == &avcodec_default_get_buffer2) {
+                segment->decodeFirstFrame(pipelineTimings);
+            }
+        }
+        return segment;
+    });
+}
+
+/** Take the video file that is opened in the background, waiting for it if it is not opened yet. */
+std::shared_ptr<VideoSegment> GenericVideoReader::takeNextSegment()
+{
+    if (_nextSegmentIndex < 0) {
+        return nullptr;
+    }
+    _nextSegment.waitForFinished();
+    std::shared_ptr<VideoSegment> segment = _nextSegment.result();
+    _nextSegment = QFuture<std::shared_ptr<VideoSegment>>();
+    _nextSegmentIndex = -1;
+    return segment;
 }
 
 /**
@@ -190,24 +618,19 @@ int GenericVideoReader::findVideoStream(AVFormatContext *formatContext) const
     return -1;
 }
 
-qint64 GenericVideoReader::frameNumberToTimestamp(const qint64 frameNumber) const
-{
-    return frameNumber / av_q2d(av_mul_q(_videoStream->time_base, _videoStream->avg_frame_rate));
-}
-
 qint64 GenericVideoReader::timestampToFrameNumber(const qint64 timestamp) const
 {
-    return timestamp * av_q2d(av_mul_q(_videoStream->time_base, _videoStream->avg_frame_rate));
+    return _segment->timestampToFrameNumber(timestamp);
 }
 
 AVCodecContext *GenericVideoReader::codecContext() const
 {
-    return _codecContext;
+    return _segment ? _segment->codecContext : nullptr;
 }
 
 AVFormatContext *GenericVideoReader::formatContext() const
 {
-    return _formatContext;
+    return _segment ? _segment->formatContext : nullptr;
 }
 
 AVFrameWrapper &GenericVideoReader::frameYuv() const
@@ -217,8 +640,12 @@ AVFrameWrapper &GenericVideoReader::frameYuv() const
 
 const AVStream *GenericVideoReader::videoStream() const
 {
-    Q_ASSERT(_videoStream != nullptr);
-    return _videoStream;
+    return _segment ? _segment->stream : nullptr;
+}
+
+PipelineTimings &GenericVideoReader::pipelineTimings() const
+{
+    return *_pipelineTimings;
 }
 
 AVFrameWrapper::AVFrameWrapper()
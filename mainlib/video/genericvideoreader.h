@@ -1,8 +1,18 @@
 #ifndef GENERICVIDEOREADER_H
 #define GENERICVIDEOREADER_H
 
+#include <atomic>
 #include <memory>
+#include <vector>
+#include <QtCore/QFuture>
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+#include "config/bigringsettings.h"
+#include "util/threadrole.h"
+#include "pipelinetimings.h"
+#include "videoindex.h"
+#include "videosegment.h"
 
 struct AVCodec;
 struct AVCodecContext;
@@ -32,6 +42,29 @@ public:
     explicit GenericVideoReader(QObject *parent = 0);
     virtual ~GenericVideoReader();
 
+    /**
+     * Set the number of threads and the way libav uses these threads for decoding. This has to be called
+     * before a video file is opened. By default, only a single thread is used.
+     */
+    void setDecoderThreading(int threadCount, VideoDecoderThreadType threadType);
+    /**
+     * Set the histograms in which the time taken by demuxing, decoding and copying frames is recorded. This has to be
+     * called before a video file is opened.
+     */
+    void setPipelineTimings(const std::shared_ptr<PipelineTimings> &pipelineTimings);
+    /** Set the way video files are read. This has to be called before a video file is opened. */
+    void setFileAccess(VideoFileAccess fileAccess);
+    /**
+     * Set the role of the threads that demux and read ahead the video files. This has to be called before a video
+     * file is opened. The thread the reader itself runs on is given its role by its owner.
+     */
+    void setThreadRole(indoorcycling::ThreadRole threadRole);
+    /**
+     * Read video files as if they are on slow storage, to measure how playback copes with a network share or a busy
+     * disk. This has to be called before a video file is opened. See ThrottledFile.
+     */
+    void setFileThrottle(qint64 bytesPerSecond, int latencyMicroseconds);
+
 signals:
     void error(const QString& errorMessage);
     void seekReady(qint64 frameNumber);
@@ -39,33 +72,93 @@ signals:
 public slots:
 
 protected:
-    virtual void openVideoFileInternal(const QString &videoFilename);
+    void openVideoFileInternal(const QString &videoFilename);
+    /**
+     * Open a video that consists of several consecutive video files, which are played as a single video. Frame numbers
+     * are those of the whole video. When playback nears the end of a file, the next file is opened, and its first
+     * frame decoded, in the background, so playback continues without delay. All files should be encoded in the same
+     * frame size and pixel format.
+     */
+    virtual void openVideoFileInternal(const QStringList &videoFilenames);
+    /**
+     * Called after the decoder threading has been set up, but before the codec is opened. Subclasses can override
+     * this to change the settings of the codec context.
+     */
+    virtual void configureCodecContext(AVCodecContext *codecContext, const AVCodec *codec);
     void performSeek(qint64 targetFrameNumber);
     void loadFramesUntilTargetFrame(qint64 targetFrameNumber);
     qint64 loadNextFrame();
+    /**
+     * Load frames until the frame with \param frameNumber or a later frame is loaded. The frames before it are
+     * decoded only as far as needed, as frames that are not used as a reference by other frames are discarded.
+     * @return the number of the loaded frame, or -1 at the end of the file.
+     */
+    qint64 skipToFrame(qint64 frameNumber);
     qint64 totalNumberOfFrames();
+    /**
+     * Load the frame index for the currently opened video file from the cache. If there is no index in the
+     * cache and \param buildIfMissing is true, the index is built by reading all packets in the file, and saved
+     * to the cache. Building stops early, without saving, when \param cancelled is set. Without an index, seeking and
+     * frame numbers are estimated from the average frame rate. With \param buildIfMissing, the missing indexes of the
+     * other video files of the video are built too, which is only meant for work that needs exact frame numbers and
+     * runs in the background; a player indexes the other files as it reaches them, see prepareNextSegment().
+     */
+    void loadVideoIndex(bool buildIfMissing, const std::atomic<bool> *cancelled = nullptr);
+    /** true if there is a frame index for the currently opened video file. */
+    bool hasVideoIndex() const;
+    /** the number of video files of the opened video. */
+    int numberOfSegments() const;
 
     AVCodecContext *codecContext() const;
     AVFormatContext *formatContext() const;
     AVFrameWrapper &frameYuv() const;
     const AVStream *videoStream() const;
+    PipelineTimings &pipelineTimings() const;
+    qint64 timestampToFrameNumber(const qint64 timestamp) const;
+    /** Log \param message, with the description of libav error \param errorNumber, and emit it as an error. */
+    void printError(int errorNumber, const QString& message);
+    void printError(const QString &message);
 private:
     void initialize();
     void close();
-    void printError(int errorNumber, const QString& message);
-    void printError(const QString &message);
+    std::shared_ptr<VideoSegment> openSegment(const QString &videoFilename, qint64 firstFrameNumber,
+                                              const AVCodecContext *configuredLike);
+    bool openFileSource(VideoSegment &segment);
     int findVideoStream(AVFormatContext* formatContext) const;
-    qint64 frameNumberToTimestamp(const qint64 frameNumber) const;
-    qint64 timestampToFrameNumber(const qint64 timestamp) const;
+    int receiveFrame(AVFrame *frame);
+    void loadSegmentIndex(VideoSegment &segment) const;
+    qint64 segmentNumberOfFrames(const QString &videoFilename, bool buildIndexIfMissing);
+    void determineSegmentFrameNumbers(bool buildIndexesIfMissing);
+    int segmentForFrame(qint64 frameNumber) const;
+    bool switchToSegment(int segmentIndex);
+    void prepareNextSegment(qint64 currentFrameNumber);
+    std::shared_ptr<VideoSegment> takeNextSegment();
 
     bool _initialized = false;
-    // libav specific data
-    AVCodec* _codec = nullptr;
-    AVCodecContext* _codecContext = nullptr;
-    AVFormatContext* _formatContext = nullptr;
+    /** the video files of the opened video, in the order they are played. */
+    QStringList _segmentFilenames;
+    /**
+     * the number of the first frame of every video file in the frame numbering of the whole video, followed by the
+     * number of frames of the whole video.
+     */
+    std::vector<qint64> _segmentFrameNumbers;
+    int _segmentIndex = 0;
+    /** the video file that is being decoded. */
+    std::shared_ptr<VideoSegment> _segment;
+    /** the video file after _segment, which is opened in the background, or an empty future. */
+    QFuture<std::shared_ptr<VideoSegment>> _nextSegment;
+    /** index of the video file that is opened in _nextSegment, or -1 if there is none. */
+    int _nextSegmentIndex = -1;
     std::unique_ptr<AVFrameWrapper> _frameYuv;
-    int _currentVideoStream;
-    AVStream* _videoStream = nullptr;
+    /** packets of frames before this frame number are decoded with non-reference frames discarded. */
+    qint64 _discardNonReferenceFramesBefore = -1;
+    int _decoderThreadCount = 1;
+    VideoDecoderThreadType _decoderThreadType = VideoDecoderThreadType::FRAME_AND_SLICE;
+    std::shared_ptr<PipelineTimings> _pipelineTimings = std::make_shared<PipelineTimings>();
+    VideoFileAccess _fileAccess = VideoFileAccess::DIRECT;
+    indoorcycling::ThreadRole _threadRole = indoorcycling::ThreadRole::INTERACTIVE;
+    qint64 _throttleBytesPerSecond = 0;
+    int _throttleLatencyMicroseconds = 0;
 };
 
 #endif // GENERICVIDEOREADER_H
@@ -21,6 +21,8 @@
 #include "openglpainter2.h"
 
 #include <QtGui/QOpenGLContext>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
 #include <QtCore/QtMath>
 #include <QtCore/QThread>
 #include <QtCore/QTime>
@@ -28,60 +30,77 @@
 #include <QtGui/QOpenGLFunctions>
 
 OpenGLPainter2::OpenGLPainter2(QGLWidget* widget, QObject *parent) :
-    QObject(parent), _widget(widget), _openGLInitialized(false), _firstFrameLoaded(false),
-    _texturesInitialized(false), _aspectRatioMode(Qt::KeepAspectRatioByExpanding),
-    _currentPixelBufferWritePosition(0),
-    _currentPixelBufferReadPosition(0),
-    _currentPixelBufferMappedPosition(0)
+    VideoPainter(parent), _widget(widget), _openGLInitialized(false), _firstFrameLoaded(false),
+    _texturesInitialized(false), _aspectRatioMode(Qt::KeepAspectRatioByExpanding)
 {
     Q_INIT_RESOURCE(shaders);
 }
 
 OpenGLPainter2::~OpenGLPainter2()
 {
-    // we'll make sure that the map pixel buffers cannot be used anymore. To do this, we'll reset all the FrameBuffer
-    // objects in them.
-    std::for_each(_pixelBuffers.begin(), _pixelBuffers.end(),
-                  [](PixelBuffer &buffer) {
-        buffer.mappedPixelBuffer->reset();
-    });
+    // we'll make sure that the mapped pixel buffers cannot be used anymore.
+    closeFrameSlots();
 }
 
 /**
- * 3 textures will be loaded, one for each of the Y, U and V planes. These textures will be applied by the the
- * OpenGL fragment shader. The GPU is much more efficient than the CPU for doing conversion from YUV to RGB, and scaling the
- * video to the right size.
+ * A texture will be loaded for every plane of the frame, so 3 for the Y, U and V planes, or 2 for NV12. These textures
+ * will be applied by the the OpenGL fragment shader. The GPU is much more efficient than the CPU for doing conversion
+ * from YUV to RGB, and scaling the video to the right size.
+ *
+ * The widget is repainted for every change of the overlays as well, so the textures are only loaded when the shown
+ * frame differs from the frame that is in the textures already.
+ * @return true if the textures were loaded.
  */
-void OpenGLPainter2::loadTextures()
+bool OpenGLPainter2::loadTextures()
 {
-    loadPlaneTextureFromPbo(GL_TEXTURE0, _yTextureId, _textureWidths[0], _textureHeights[0], (size_t) 0);
-    loadPlaneTextureFromPbo(GL_TEXTURE1, _uTextureId, _textureWidths[1], _textureHeights[1], _textureOffsets[1]);
-    loadPlaneTextureFromPbo(GL_TEXTURE2, _vTextureId, _textureWidths[2], _textureHeights[2], _textureOffsets[2]);
+    const int shownBuffer = _frameRing.shownBuffer();
+    const qint64 shownFrameNumber = _frameRing.frameNumber(shownBuffer);
+    if (_texturesInitialized && shownBuffer == _textureBuffer && shownFrameNumber == _textureFrameNumber) {
+        return false;
+    }
+
+    const std::array<GLuint, 3> textureIds = {{ _yTextureId, _uTextureId, _vTextureId }};
+    for (int i = 0; i < _frameFormat.planes(); ++i) {
+        loadPlaneTextureFromPbo(GL_TEXTURE0 + i, textureIds[i], i);
+    }
 
     // on the first pass, we need to load the textures with glTexImage2D
     // on every subsequent pass we can use glTexSubImage2D, which can be faster.
     // To facilitate this, set _texturesInitialized to true after the first pass.
     _texturesInitialized = true;
+    _textureBuffer = shownBuffer;
+    _textureFrameNumber = shownFrameNumber;
+    return true;
 }
 
-void OpenGLPainter2::loadPlaneTextureFromPbo(int glTextureUnit, int textureUnit,
-                                           int lineSize, int height, size_t offset)
+/**
+ * Load \param plane from the pixel buffer of the shown frame. 10 bit samples are loaded into 16 bit textures, the
+ * interleaved U and V samples of NV12 into the luminance and alpha of a texture.
+ */
+void OpenGLPainter2::loadPlaneTextureFromPbo(int glTextureUnit, int textureUnit, int plane)
 {
 
     _glFunctions->glActiveTexture(glTextureUnit);
     _glFunctions->glBindTexture(GL_TEXTURE_RECTANGLE, textureUnit);
-    QOpenGLBuffer &pixelBuffer = _pixelBuffers[_currentPixelBufferReadPosition].openGlPixelBuffer;
+    QOpenGLBuffer &pixelBuffer = _pixelBuffers[_frameRing.shownBuffer()].openGlPixelBuffer;
 
     pixelBuffer.bind();
 
+    const bool interleaved = (_frameFormat.samplesPerPixel(plane) == 2);
+    const bool sixteenBits = (_frameFormat.bytesPerSample() == 2);
+    const GLenum format = interleaved ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+    const GLenum type = sixteenBits ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    const GLint internalFormat = sixteenBits ? GL_LUMINANCE16 : static_cast<GLint>(format);
+    void *offset = reinterpret_cast<void*>(static_cast<quintptr>(_textureOffsets[plane]));
+
     // for the first texture upload of a texture unit, we need to use glTexImage2D. After that, we can use
     // glTexSubImage2D, which should be faster most of the times.
     if (_texturesInitialized) {
-        _glFunctions->glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, lineSize, height,
-                        GL_LUMINANCE, GL_UNSIGNED_BYTE, (void*) offset);
+        _glFunctions->glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, _textureWidths[plane], _textureHeights[plane],
+                                      format, type, offset);
     } else {
-        _glFunctions->glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_LUMINANCE, lineSize, height,
-                     0,GL_LUMINANCE,GL_UNSIGNED_BYTE, (void*) offset);
+        _glFunctions->glTexImage2D(GL_TEXTURE_RECTANGLE, 0, internalFormat, _textureWidths[plane],
+                                   _textureHeights[plane], 0, format, type, offset);
     }
 
     pixelBuffer.release();
@@ -122,7 +141,13 @@ void OpenGLPainter2::paint(QPainter *painter, const QRectF &rect, Qt::AspectRati
 
     _program.bind();
 
-    loadTextures();
+    QElapsedTimer uploadTimer;
+    uploadTimer.start();
+    const bool uploaded = loadTextures();
+    if (uploaded) {
+        _pipelineTimings->record(PipelineStage::UPLOAD, uploadTimer.nsecsElapsed());
+    }
+    countPaint(uploaded, combinedSizeOfTextures());
 
     // set the texture and vertex coordinates using VBOs.
     _textureCoordinatesBuffer.bind();
@@ -159,109 +184,106 @@ void OpenGLPainter2::paint(QPainter *painter, const QRectF &rect, Qt::AspectRati
 //    qDebug() << "Painting took" << time.elapsed() << "ms";
 }
 
-std::weak_ptr<FrameBuffer> OpenGLPainter2::getNextFrameBuffer()
+void *OpenGLPainter2::frameBufferToFill(int index)
 {
-    if (!_openGLInitialized) {
-        _widget->context()->makeCurrent();
-        initializeOpenGL();
-    }
     _widget->context()->makeCurrent();
 
-    QOpenGLBuffer &openGlBuffer = _pixelBuffers[_currentPixelBufferMappedPosition].openGlPixelBuffer;
+    PixelBuffer &pixelBuffer = _pixelBuffers[index];
+    QOpenGLBuffer &openGlBuffer = pixelBuffer.openGlPixelBuffer;
 
     openGlBuffer.bind();
-    // if the frame buffer is currently mapped, we first need to reset the mapped pointer and then unmap the pixel buffer.
-    std::shared_ptr<FrameBuffer> oldFrameBuffer = _pixelBuffers[_currentPixelBufferMappedPosition].mappedPixelBuffer;
-    if (oldFrameBuffer) {
-        // resets the mapped pointer in oldFrameBuffer. reset() uses a mutex internally
-        oldFrameBuffer->reset();
+    // if the frame buffer is currently mapped, we first need to unmap the pixel buffer.
+    if (pixelBuffer.mapped) {
         openGlBuffer.unmap();
     }
 
     /* map the OpenGL buffer to a pointer in memory, so a frame can be copied */
     void *mappedBufferPtr = openGlBuffer.map(QOpenGLBuffer::WriteOnly);
+    pixelBuffer.mapped = (mappedBufferPtr != nullptr);
 
     if (mappedBufferPtr == nullptr) {
-        qWarning("Unable map opengl pixel buffer nr %d", _currentPixelBufferMappedPosition);
+        qWarning("Unable map opengl pixel buffer nr %d", index);
     }
 
-    std::shared_ptr<FrameBuffer> frameBuffer(new FrameBuffer(mappedBufferPtr, _sourceTotalSize, _currentPixelBufferMappedPosition));
-    _pixelBuffers[_currentPixelBufferMappedPosition].mappedPixelBuffer = frameBuffer;
-
-    // Set mapped pixel buffer position to the next position to map.
-    _currentPixelBufferMappedPosition = (_currentPixelBufferMappedPosition + 1) % _pixelBuffers.size();
-
     openGlBuffer.release();
 
-    return frameBuffer;
+    return mappedBufferPtr;
 }
 
-void OpenGLPainter2::setVideoSize(const QSize &videoSize, const QSize& frameSize)
+void OpenGLPainter2::resizeBuffers(int size, const FrameFormat &)
 {
     if (!_openGLInitialized) {
         _widget->context()->makeCurrent();
         initializeOpenGL();
-        qDebug() << "initializing opengl";
-    }
-    if (frameSize != _sourceTotalSize) {
-        _sourceSizeDirty = true;
-        _sourceTotalSize = frameSize;
-        _sourcePictureSize = videoSize;
-        initYuv420PTextureInfo();
     }
-}
-
-void OpenGLPainter2::setFrameLoaded(int index, qint64 frameNumber, const QSize &)
-{
-    QTime time;
-    time.start();
     _widget->context()->makeCurrent();
-    _currentPixelBufferWritePosition = index;
-    QOpenGLBuffer &buffer = _pixelBuffers[index].openGlPixelBuffer;
-    buffer.bind();
-    buffer.unmap();
-    buffer.release();
-    _pixelBuffers[index].frameNumber = frameNumber;
-    _firstFrameLoaded = true;
-    _glFunctions->glFlush();
-}
 
-/**
- * Request new frames to make sure the buffer is a full as possible.
- */
-void OpenGLPainter2::requestNewFrames()
-{
-    while (_currentPixelBufferMappedPosition != _currentPixelBufferReadPosition) {
-        emit frameNeeded(getNextFrameBuffer());
+    for (PixelBuffer &buffer: _pixelBuffers) {
+        if (buffer.mapped) {
+            buffer.openGlPixelBuffer.bind();
+            buffer.openGlPixelBuffer.unmap();
+            buffer.openGlPixelBuffer.release();
+        }
+        if (buffer.openGlPixelBuffer.isCreated()) {
+            buffer.openGlPixelBuffer.destroy();
+        }
     }
-}
+    _pixelBuffers.clear();
+    _pixelBuffers.resize(static_cast<std::size_t>(size));
 
-bool OpenGLPainter2::showFrame(qint64 frameNumber)
-{
-    // if we are requested to show the current frame, do nothing.
-    if (_pixelBuffers[_currentPixelBufferReadPosition].frameNumber >= frameNumber) {
-        qDebug() << "now new frame shown, because" << _pixelBuffers[_currentPixelBufferReadPosition].frameNumber << ">=" << frameNumber;
-        return false;
+    for (PixelBuffer &buffer: _pixelBuffers) {
+        QOpenGLBuffer pixelBuffer(QOpenGLBuffer::PixelUnpackBuffer);
+        pixelBuffer.create();
+        pixelBuffer.bind();
+        pixelBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        pixelBuffer.allocate(combinedSizeOfTextures());
+        pixelBuffer.release();
+        buffer.openGlPixelBuffer = pixelBuffer;
     }
+    _firstFrameLoaded = false;
+    _texturesInitialized = false;
+}
 
-    quint32 newIndex = (_currentPixelBufferReadPosition + 1) % _pixelBuffers.size();
-    while (_pixelBuffers[newIndex].frameNumber < frameNumber && newIndex != _currentPixelBufferReadPosition) {
-        newIndex = (newIndex + 1) % _pixelBuffers.size();
+void OpenGLPainter2::setVideoSize(const QSize &videoSize, const FrameFormat &frameFormat)
+{
+    if (!_openGLInitialized) {
+        _widget->context()->makeCurrent();
+        initializeOpenGL();
+        qDebug() << "initializing opengl";
     }
-    if (newIndex == _currentPixelBufferWritePosition) {
-        qDebug() << "frame not present, have to wait for new frames to arrive to catch up.";
+    if (frameFormat != _frameFormat) {
+        _widget->context()->makeCurrent();
+        if (!_program.isLinked() || frameFormat.pixelFormat() != _frameFormat.pixelFormat()) {
+            initializeShaderProgram(frameFormat.pixelFormat());
+        }
+        _sourceSizeDirty = true;
+        _frameFormat = frameFormat;
+        _sourcePictureSize = videoSize;
+        initTextureInfo();
     }
-
-    _currentPixelBufferReadPosition = newIndex;
-    requestNewFrames();
-    return true;
+    resizeFrameRing(frameFormat);
 }
 
-void OpenGLPainter2::fillBuffers()
+void OpenGLPainter2::setFrameLoaded(int index, qint64 frameNumber)
 {
-    for (quint32 i = 0; i < _pixelBuffers.size(); ++i) {
-        emit frameNeeded(getNextFrameBuffer());
+    _widget->context()->makeCurrent();
+    PixelBuffer &pixelBuffer = _pixelBuffers[index];
+    if (pixelBuffer.mapped) {
+        QOpenGLBuffer &buffer = pixelBuffer.openGlPixelBuffer;
+        buffer.bind();
+        buffer.unmap();
+        buffer.release();
+        pixelBuffer.mapped = false;
+    }
+    _frameRing.setFrameLoaded(index, frameNumber);
+    if (index == _textureBuffer) {
+        // the frame in the textures is not in its pixel buffer anymore.
+        _textureBuffer = -1;
     }
+    if (frameNumber >= 0) {
+        _firstFrameLoaded = true;
+    }
+    _glFunctions->glFlush();
 }
 
 void OpenGLPainter2::handleLoggedMessage(const QOpenGLDebugMessage &debugMessage)
@@ -270,11 +292,11 @@ void OpenGLPainter2::handleLoggedMessage(const QOpenGLDebugMessage &debugMessage
 }
 
 /**
- * @brief compile the opengl shader program from the sources and link it, if the program is not yet linked.
+ * @brief check the OpenGL features we need and generate the textures.
  */
 void OpenGLPainter2::initializeOpenGL()
 {
-    Q_ASSERT_X(!_program.isLinked(), "initializeOpenGL", "OpenGL already initialized");
+    Q_ASSERT_X(!_openGLInitialized, "initializeOpenGL", "OpenGL already initialized");
     qDebug() << "INITIALIZING OPENGL";
     _glFunctions = QOpenGLContext::currentContext()->versionFunctions<QOpenGLFunctions_1_3>();
     if (!_glFunctions) {
@@ -283,15 +305,6 @@ void OpenGLPainter2::initializeOpenGL()
     }
     _glFunctions->initializeOpenGLFunctions();
     QOpenGLFunctions functions(QOpenGLContext::currentContext());
-    if (!_program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":///vertexshader.glsl")) {
-        qFatal("Unable to add vertex shader: %s", qPrintable(_program.log()));
-    }
-    if (!_program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":///fragmentshader.glsl")) {
-        qFatal("Unable to add fragment shader: %s", qPrintable(_program.log()));
-    }
-    if (!_program.link()) {
-        qFatal("Unable to link shader program: %s", qPrintable(_program.log()));
-    }
     QOpenGLContext* glContext = QOpenGLContext::currentContext();
     if (!functions.hasOpenGLFeature(QOpenGLFunctions::NPOTTextures)) {
         qFatal("OpenGL needs to have support for 'Non power of two textures'");
@@ -315,6 +328,45 @@ void OpenGLPainter2::initializeOpenGL()
     _openGLInitialized = true;
 }
 
+/**
+ * @brief compile the variant of the fragment shader for \param pixelFormat and link the shader program.
+ *
+ * The variants are made by defining the macros the fragment shader checks, right after its #version and #extension
+ * lines.
+ */
+void OpenGLPainter2::initializeShaderProgram(PixelFormat pixelFormat)
+{
+    _program.removeAllShaders();
+    if (!_program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":///vertexshader.glsl")) {
+        qFatal("Unable to add vertex shader: %s", qPrintable(_program.log()));
+    }
+
+    QFile fragmentShaderFile(":///fragmentshader.glsl");
+    if (!fragmentShaderFile.open(QIODevice::ReadOnly)) {
+        qFatal("Unable to read fragment shader");
+    }
+    QByteArray fragmentShader = fragmentShaderFile.readAll();
+    QByteArray defines;
+    if (pixelFormat == PixelFormat::NV12) {
+        defines += "#define INTERLEAVED_CHROMA\n";
+    }
+    if (pixelFormat == PixelFormat::YUV422P || pixelFormat == PixelFormat::YUV422P10) {
+        defines += "#define FULL_HEIGHT_CHROMA\n";
+    }
+    if (pixelFormat == PixelFormat::YUV420P10 || pixelFormat == PixelFormat::YUV422P10) {
+        defines += "#define TEN_BIT_SAMPLES\n";
+    }
+    const int extensionLine = fragmentShader.indexOf("#extension");
+    fragmentShader.insert(fragmentShader.indexOf('\n', extensionLine) + 1, defines);
+    if (!_program.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader)) {
+        qFatal("Unable to add fragment shader: %s", qPrintable(_program.log()));
+    }
+    if (!_program.link()) {
+        qFatal("Unable to link shader program: %s", qPrintable(_program.log()));
+    }
+    qDebug() << "using fragment shader for" << pixelFormatName(pixelFormat);
+}
+
 void OpenGLPainter2::initializeVertexCoordinatesBuffer(const QRectF& videoRect)
 {
     const QVector<GLfloat> vertexCoordinates =
@@ -363,11 +415,7 @@ void OpenGLPainter2::adjustPaintAreas(const QRectF& targetRect, Qt::AspectRatioM
 
 quint32 OpenGLPainter2::combinedSizeOfTextures()
 {
-    quint32 size = 0u;
-    for (int i = 0; i < 3; ++i) {
-        size += _textureWidths[i] * _textureHeights[i];
-    }
-    return size;
+    return static_cast<quint32>(_frameFormat.bufferSize());
 }
 
 void OpenGLPainter2::initializeTextureCoordinatesBuffer()
@@ -390,34 +438,19 @@ void OpenGLPainter2::initializeTextureCoordinatesBuffer()
     _textureCoordinatesBuffer.release();
 }
 
-void OpenGLPainter2::initYuv420PTextureInfo()
+/**
+ * The textures are as wide as the number of samples in a line of their plane, so 10 bit samples take two bytes of a
+ * line, and the interleaved U and V samples of NV12 make a single texel.
+ */
+void OpenGLPainter2::initTextureInfo()
 {
-    const int bytesPerLineY = (_sourceTotalSize.width() + 3) & ~3;
-    const int bytesPerLineUAndV = (_sourceTotalSize.width() / 2 + 3) & ~3;
-    _textureWidths[0] = bytesPerLineY;
-    _textureHeights[0] = _sourceTotalSize.height();
-    _textureOffsets[0] = 0;
-    _textureWidths[1] = bytesPerLineUAndV;
-    _textureHeights[1] = _sourceTotalSize.height() / 2;
-    _textureOffsets[1] = bytesPerLineY * _sourceTotalSize.height();
-    _textureWidths[2] = bytesPerLineUAndV;
-    _textureHeights[2] = _sourceTotalSize.height() / 2;
-    _textureOffsets[2] = bytesPerLineY * _sourceTotalSize.height() + bytesPerLineUAndV * _sourceTotalSize.height()/2;
+    for (int i = 0; i < _frameFormat.planes(); ++i) {
+        _textureWidths[i] = _frameFormat.lineSize(i) / (_frameFormat.bytesPerSample() * _frameFormat.samplesPerPixel(i));
+        _textureHeights[i] = _frameFormat.lines(i);
+        _textureOffsets[i] = _frameFormat.planeOffset(i);
+    }
 
     initializeTextureCoordinatesBuffer();
 
-    for (quint32 i = 0; i < _pixelBuffers.size(); ++i) {
-        if (_pixelBuffers[i].openGlPixelBuffer.isCreated()) {
-            _pixelBuffers[i].openGlPixelBuffer.destroy();
-        }
-        QOpenGLBuffer pixelBuffer(QOpenGLBuffer::PixelUnpackBuffer);
-        pixelBuffer.create();
-        pixelBuffer.bind();
-        pixelBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-        pixelBuffer.allocate(combinedSizeOfTextures());
-        pixelBuffer.release();
-        _pixelBuffers[i].openGlPixelBuffer = pixelBuffer;
-    }
     _texturesInitialized = false;
 }
-
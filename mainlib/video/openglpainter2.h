@@ -21,7 +21,6 @@
 #ifndef OPENGLPAINTER_H
 #define OPENGLPAINTER_H
 
-#include <QObject>
 #include <QtGui/QOpenGLBuffer>
 #include <QtGui/QOpenGLDebugMessage>
 #include <QtGui/QOpenGLShaderProgram>
@@ -29,14 +28,15 @@
 #include <QtGui/QOpenGLFunctions_1_3>
 
 #include <array>
-#include <memory>
-#include "framebuffer.h"
+#include <vector>
+#include "videopainter.h"
 
-namespace
-{
-const int NUMBER_OF_BUFFERS = 150;
-}
-class OpenGLPainter2 : public QObject
+/**
+ * Paints video frames with OpenGL. Frames are uploaded from pixel buffer objects to textures, and converted to RGB
+ * and scaled by a fragment shader. Every pixel format has its own variant of the fragment shader, so frames are
+ * uploaded in the format the decoder produced them in.
+ */
+class OpenGLPainter2 : public VideoPainter
 {
     Q_OBJECT
 public:
@@ -44,62 +44,38 @@ public:
     virtual ~OpenGLPainter2();
 
     /** paint the current from using OpenGL */
-    void paint(QPainter* painter, const QRectF& rect, Qt::AspectRatioMode aspectRatioMode);
-signals:
-    /**
-     * When this signal is emitted, we need to load another frame for the painter.
-     * @param frameBuffer the structure in which to load the frame.
-     */
-    void frameNeeded(const std::weak_ptr<FrameBuffer>& frameBuffer);
+    virtual void paint(QPainter* painter, const QRectF& rect, Qt::AspectRatioMode aspectRatioMode) override;
 public slots:
-    /**
-     * Set the video size.
-     * @param videoSize the destination size, in which the video should be presented.
-     * @param frameSize the source size, coming from the video file.
-     */
-    void setVideoSize(const QSize& videoSize, const QSize &frameSize);
-    /**
-     * Signal to the painter that a frame is loaded.
-     * @param index internal index in the OpenGLPainter. Get this from the FrameBuffer that has been loaded.
-     * @param frameNumber number of the frame, from the video file.
-     * @param frameSize size of the frame.
-     */
-    void setFrameLoaded(int index, qint64 frameNumber, const QSize& frameSize);
-    /**
-     * Prepare a frame for painting.
-     * @param frameNumber frame number of the frame that should be shown later.
-     * @return true if a new frame was prepared. False if no new frame has to be shown
-     */
-    bool showFrame(qint64 frameNumber);
-    /**
-     * Make the painter fill it's buffers
-     */
-    void fillBuffers();
+    virtual void setVideoSize(const QSize& videoSize, const FrameFormat &frameFormat) override;
+protected:
+    /** Map the pixel buffer at \param index to memory, so we can copy frame information from libav to it. */
+    virtual void *frameBufferToFill(int index) override;
+    /** Unmap the pixel buffer at \param index, so it can be uploaded to a texture. */
+    virtual void setFrameLoaded(int index, qint64 frameNumber) override;
+    virtual void resizeBuffers(int size, const FrameFormat &frameFormat) override;
 private slots:
     void handleLoggedMessage(const QOpenGLDebugMessage &debugMessage);
 private:
     void initializeOpenGL();
-    void initYuv420PTextureInfo();
-    void loadTextures();
-    void loadPlaneTextureFromPbo(int glTextureUnit, int textureUnit,
-                                  int lineSize, int height, size_t offset);
+    void initializeShaderProgram(PixelFormat pixelFormat);
+    void initTextureInfo();
+    bool loadTextures();
+    void loadPlaneTextureFromPbo(int glTextureUnit, int textureUnit, int plane);
     void adjustPaintAreas(const QRectF& targetRect, Qt::AspectRatioMode aspectRationMode);
     void initializeVertexCoordinatesBuffer(const QRectF &videoRect);
     void initializeTextureCoordinatesBuffer();
     quint32 combinedSizeOfTextures();
-    /** Get a new FrameBuffer, to which we can copy frame information from libav */
-    std::weak_ptr<FrameBuffer> getNextFrameBuffer();
-    /**
-     * Make the OpenGLPainter reqeuest new frames to fill it's buffers.
-     */
-    void requestNewFrames();
 
     QGLWidget* _widget;
     QOpenGLFunctions_1_3 *_glFunctions;
     bool _openGLInitialized;
     bool _firstFrameLoaded;
     bool _texturesInitialized;
-    QSize _sourceTotalSize;
+    /** index of the pixel buffer whose frame is loaded in the textures, or -1 if the textures hold no frame. */
+    int _textureBuffer = -1;
+    /** number of the frame that is loaded in the textures. */
+    qint64 _textureFrameNumber = -1;
+    FrameFormat _frameFormat;
     QSize _sourcePictureSize;
     QRectF _targetRect;
     QRectF _blackBar1, _blackBar2;
@@ -120,23 +96,14 @@ private:
     /**
      * Buffer containing
      * * a QOpenGLBuffer representing an OpenGL Pixel Buffer Object.
-     * * a Mapped Pixel Buffer object, which represents the QOpenGLBuffer mapped to memory, so we can copy a frame into it.
-     * * a frameNumber, representing the number of the frame that is contained.
+     * * whether the QOpenGLBuffer is mapped to memory, so a frame can be copied into it.
      */
     struct PixelBuffer {
         QOpenGLBuffer openGlPixelBuffer;
-        std::shared_ptr<FrameBuffer> mappedPixelBuffer;
-        qint64 frameNumber;
+        bool mapped = false;
     };
-    /** This is our frame buffer, containing a number of frames that can be displayed */
-    std::array<PixelBuffer, NUMBER_OF_BUFFERS> _pixelBuffers;
-
-    /** The last position in _pixelBuffers in which a frame was written. */
-    quint32 _currentPixelBufferWritePosition;
-    /** The current position from which a frame will displayed. */
-    quint32 _currentPixelBufferReadPosition;
-    /** The last position in _pixelBuffers which has been mapped to memory. */
-    quint32 _currentPixelBufferMappedPosition;
+    /** This is our frame buffer, containing a number of frames that can be displayed. _frameRing keeps the positions. */
+    std::vector<PixelBuffer> _pixelBuffers;
 
     QOpenGLShaderProgram _program;
 };
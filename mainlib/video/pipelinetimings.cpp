@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "pipelinetimings.h"
+
+namespace
+{
+/** number of buckets per power of two is 2^SUB_BUCKET_BITS */
+const int SUB_BUCKET_BITS = 2;
+const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const qreal NANOSECONDS_PER_MILLISECOND = 1e6;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(qint64 nanoseconds)
+{
+    nanoseconds = qMax(Q_INT64_C(0), nanoseconds);
+    _buckets[static_cast<std::size_t>(bucketIndex(nanoseconds))].fetch_add(1, std::memory_order_relaxed);
+    _totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    qint64 maximum = _maximum.load(std::memory_order_relaxed);
+    while (nanoseconds > maximum && !_maximum.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed)) {
+        // maximum is updated by compare_exchange_weak, try again.
+    }
+    // the count is written last, so a reader never sees more latencies counted than are in the buckets.
+    _count.fetch_add(1, std::memory_order_release);
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return _count.load(std::memory_order_acquire);
+}
+
+qreal LatencyHistogram::average() const
+{
+    const quint64 latencies = count();
+    return (latencies == 0) ? 0 : static_cast<qreal>(_totalNanoseconds.load(std::memory_order_relaxed)) / latencies;
+}
+
+qint64 LatencyHistogram::maximum() const
+{
+    return _maximum.load(std::memory_order_relaxed);
+}
+
+qint64 LatencyHistogram::percentile(qreal fraction) const
+{
+    const quint64 latencies = count();
+    if (latencies == 0) {
+        return 0;
+    }
+    const quint64 target = qMax(Q_UINT64_C(1), static_cast<quint64>(fraction * latencies + 0.5));
+    quint64 counted = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        counted += _buckets[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
+        if (counted >= target) {
+            return qMin(bucketUpperBound(i), maximum() + 1);
+        }
+    }
+    return maximum() + 1;
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<quint64> &bucket: _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _totalNanoseconds.store(0, std::memory_order_relaxed);
+    _maximum.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_release);
+}
+
+int LatencyHistogram::bucketIndex(qint64 nanoseconds)
+{
+    if (nanoseconds < SUB_BUCKETS) {
+        return static_cast<int>(qMax(Q_INT64_C(0), nanoseconds));
+    }
+    int exponent = SUB_BUCKET_BITS;
+    while ((nanoseconds >> (exponent + 1)) != 0) {
+        ++exponent;
+    }
+    // the bits after the highest bit select the bucket within the power of two.
+    const int subBucket = static_cast<int>(nanoseconds >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return qMin((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket, BUCKETS - 1);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS) {
+        return index + 1;
+    }
+    const int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const qint64 bucketSize = Q_INT64_C(1) << (exponent - SUB_BUCKET_BITS);
+    return (SUB_BUCKETS + index % SUB_BUCKETS + 1) * bucketSize;
+}
+
+const char *pipelineStageName(PipelineStage stage)
+{
+    switch (stage) {
+    case PipelineStage::DEMUX:
+        return "demux";
+    case PipelineStage::DECODE:
+        return "decode";
+    case PipelineStage::COPY:
+        return "copy";
+    case PipelineStage::MAP:
+        return "map";
+    case PipelineStage::UPLOAD:
+        return "upload";
+    case PipelineStage::PAINT:
+        return "paint";
+    }
+    return "unknown";
+}
+
+PipelineTimings::PipelineTimings()
+{
+    // empty
+}
+
+void PipelineTimings::record(PipelineStage stage, qint64 nanoseconds)
+{
+    _histograms[static_cast<std::size_t>(stage)].record(nanoseconds);
+}
+
+const LatencyHistogram &PipelineTimings::histogram(PipelineStage stage) const
+{
+    return _histograms[static_cast<std::size_t>(stage)];
+}
+
+QString PipelineTimings::summary() const
+{
+    QString summary = QString("%1 %2 %3 %4 %5 %6 %7\n").arg("stage", -6).arg("count", 8).arg("avg ms", 8)
+            .arg("p50", 8).arg("p95", 8).arg("p99", 8).arg("max", 8);
+    for (int i = 0; i < STAGES; ++i) {
+        const PipelineStage stage = static_cast<PipelineStage>(i);
+        const LatencyHistogram &stageHistogram = histogram(stage);
+        summary += QString("%1 %2 %3 %4 %5 %6 %7\n").arg(pipelineStageName(stage), -6)
+                .arg(stageHistogram.count(), 8)
+                .arg(stageHistogram.average() / NANOSECONDS_PER_MILLISECOND, 8, 'f', 2)
+                .arg(stageHistogram.percentile(0.5) / NANOSECONDS_PER_MILLISECOND, 8, 'f', 2)
+                .arg(stageHistogram.percentile(0.95) / NANOSECONDS_PER_MILLISECOND, 8, 'f', 2)
+                .arg(stageHistogram.percentile(0.99) / NANOSECONDS_PER_MILLISECOND, 8, 'f', 2)
+                .arg(stageHistogram.maximum() / NANOSECONDS_PER_MILLISECOND, 8, 'f', 2);
+    }
+    return summary;
+}
+
+void PipelineTimings::reset()
+{
+    for (LatencyHistogram &stageHistogram: _histograms) {
+        stageHistogram.reset();
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef PIPELINETIMINGS_H
+#define PIPELINETIMINGS_H
+
+#include <array>
+#include <atomic>
+
+#include <QtCore/QString>
+#include <QtCore/QtGlobal>
+
+/**
+ * Histogram of latencies, in nanoseconds. Every power of two is split in four buckets, so a percentile is known
+ * within 25%. Latencies can be recorded from any thread without locks, while another thread reads the histogram.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /** Record a latency of \param nanoseconds. */
+    void record(qint64 nanoseconds);
+    /** number of latencies that were recorded. */
+    quint64 count() const;
+    /** average latency, in nanoseconds. */
+    qreal average() const;
+    /** highest latency, in nanoseconds. */
+    qint64 maximum() const;
+    /**
+     * Get a percentile of the latencies.
+     * @param fraction the percentile as a fraction, for instance 0.99 for the 99th percentile.
+     * @return the upper bound of the bucket that holds the percentile, in nanoseconds, or 0 without latencies.
+     */
+    qint64 percentile(qreal fraction) const;
+    void reset();
+
+    /** index of the bucket that holds \param nanoseconds. */
+    static int bucketIndex(qint64 nanoseconds);
+    /** the lowest latency that does not fit in the bucket at \param index anymore. */
+    static qint64 bucketUpperBound(int index);
+
+private:
+    /** four buckets for every power of two up to 2^40 nanoseconds, about 18 minutes. */
+    static const int BUCKETS = 160;
+
+    std::array<std::atomic<quint64>, BUCKETS> _buckets;
+    std::atomic<quint64> _count;
+    std::atomic<qint64> _totalNanoseconds;
+    std::atomic<qint64> _maximum;
+};
+
+/** The stages a frame goes through, from the video file to the screen. */
+enum class PipelineStage
+{
+    /** reading a packet from the video file, on the demuxer thread */
+    DEMUX,
+    /** decoding a frame, including the frames that are skipped */
+    DECODE,
+    /** copying or blending a decoded frame into a frame buffer */
+    COPY,
+    /** mapping a frame buffer to memory, before a frame is requested for it */
+    MAP,
+    /** uploading a frame to textures, or converting it to an RGB image for software rendering */
+    UPLOAD,
+    /** painting a frame, including the upload */
+    PAINT
+};
+const char *pipelineStageName(PipelineStage stage);
+
+/**
+ * Latency histograms for the stages of the video pipeline. The reader, the demuxer and the painter each record the
+ * stages they perform, on their own threads.
+ */
+class PipelineTimings
+{
+public:
+    PipelineTimings();
+
+    void record(PipelineStage stage, qint64 nanoseconds);
+    const LatencyHistogram &histogram(PipelineStage stage) const;
+    /**
+     * A table with a line for every stage, with the number of latencies and the average, 50th, 95th and 99th
+     * percentile and maximum latency in milliseconds.
+     */
+    QString summary() const;
+    void reset();
+
+private:
+    static const int STAGES = static_cast<int>(PipelineStage::PAINT) + 1;
+
+    std::array<LatencyHistogram, STAGES> _histograms;
+};
+
+#endif // PIPELINETIMINGS_H
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "proxytranscoder.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QtDebug>
+
+#include "importer/videoindexcache.h"
+#include "util/threadrole.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+namespace
+{
+// a key frame every half second means a seek decodes at most a dozen or so frames.
+const double PROXY_KEY_FRAME_INTERVAL_SECONDS = 0.5;
+// constant quality settings that keep the proxy close to the original.
+const char* const H264_PRESET = "veryfast";
+const char* const H264_CRF = "20";
+const int MPEG4_QUANTIZER = 3;
+// previews are small, so a lower quality is good enough.
+const int PREVIEW_JPEG_QUANTIZER = 5;
+
+/** Frame size of the proxy, reduced to fit \param maximumFrameSize. Width and height are even, for YUV 4:2:0. */
+QSize proxyFrameSize(const QSize &videoFrameSize, const QSize &maximumFrameSize)
+{
+    QSize frameSize = videoFrameSize;
+    if (!maximumFrameSize.isEmpty() && (frameSize.width() > maximumFrameSize.width() ||
+                                        frameSize.height() > maximumFrameSize.height())) {
+        frameSize = frameSize.scaled(maximumFrameSize, Qt::KeepAspectRatio);
+    }
+    return QSize(frameSize.width() & ~1, frameSize.height() & ~1);
+}
+}
+
+ProxyTranscoder::ProxyTranscoder(QObject *parent) :
+    GenericVideoReader(parent), _cancelled(false)
+{
+    // empty
+}
+
+ProxyTranscoder::~ProxyTranscoder()
+{
+    closeOutput();
+}
+
+bool ProxyTranscoder::transcode(const QStringList &videoFilenames, const QString &proxyFilename,
+                                const QSize &maximumFrameSize)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    openVideoFileInternal(videoFilenames);
+    if (!codecContext()) {
+        return false;
+    }
+    // the frame numbers of the proxy should be the ones that are used when playing the video, which uses the index.
+    loadVideoIndex(true, &_cancelled);
+
+    const QSize frameSize = proxyFrameSize(QSize(codecContext()->width, codecContext()->height), maximumFrameSize);
+    const QString partialFilename = proxyFilename + ".part";
+    if (frameSize.isEmpty() || !openOutput(partialFilename, frameSize)) {
+        closeOutput();
+        QFile::remove(partialFilename);
+        return false;
+    }
+
+    _proxyIndexEntries.clear();
+    bool success = true;
+    const qint64 frameStep = qMax(1, _previewFrameStep);
+    const qint64 numberOfFrames = (totalNumberOfFrames() + frameStep - 1) / frameStep;
+    qint64 lastFrameNumber = -1;
+    qint64 frameNumber;
+    indoorcycling::beginBackgroundWork();
+    // for a preview, the frames in between are skipped, and only decoded as far as they are needed as a reference.
+    while (success && !_cancelled &&
+           (frameNumber = (frameStep > 1) ? skipToFrame((lastFrameNumber + 1) * frameStep) : loadNextFrame()) >= 0) {
+        frameNumber /= frameStep;
+        // frames have to be written in order, so a frame that has the timestamp of an earlier frame is left out.
+        if (frameNumber <= lastFrameNumber) {
+            continue;
+        }
+        // a frame that the decoder dropped, or that was left out, leaves a gap. The previous frame is repeated in it,
+        // so the frames after it keep their frame numbers.
+        if (lastFrameNumber >= 0) {
+            success = repeatScaledFrame(lastFrameNumber, frameNumber);
+        }
+        const AVFrame *frame = frameYuv().frame;
+        _swsContext = sws_getCachedContext(_swsContext, frame->width, frame->height,
+                                           static_cast<AVPixelFormat>(frame->format), frameSize.width(),
+                                           frameSize.height(), _encoderContext->pix_fmt, SWS_BICUBIC,
+                                           nullptr, nullptr, nullptr);
+        // the encoder could still hold a reference to the previous frame.
+        av_frame_make_writable(_scaledFrame);
+        sws_scale(_swsContext, frame->data, frame->linesize, 0, frame->height, _scaledFrame->data,
+                  _scaledFrame->linesize);
+        if (lastFrameNumber < 0) {
+            // there is no previous frame for the frames before the first one, so the first frame is used for them.
+            success = repeatScaledFrame(-1, frameNumber);
+        }
+        _scaledFrame->pts = frameNumber;
+        success = success && encodeFrame(_scaledFrame);
+        lastFrameNumber = frameNumber;
+        // transcoding while riding should not take the cores the ride needs.
+        indoorcycling::throttleBackgroundWork();
+    }
+    // the last frame is repeated for frames that are missing at the end.
+    if (lastFrameNumber >= 0 && lastFrameNumber + 1 < numberOfFrames) {
+        success = success && !_cancelled && repeatScaledFrame(lastFrameNumber, numberOfFrames);
+        lastFrameNumber = numberOfFrames - 1;
+    }
+    success = success && !_cancelled && encodeFrame(nullptr);
+    if (success) {
+        const int errorNr = av_write_trailer(_outputFormatContext);
+        if (errorNr < 0) {
+            printError(errorNr, "Unable to finish proxy");
+            success = false;
+        }
+    }
+    closeOutput();
+
+    if (success) {
+        // the proxy's frame numbers are known exactly, so the proxy does not have to be indexed before it is used.
+        // The proxy does not exist yet, so its path is made canonical through the temporary file, which is next to it.
+        const QFileInfo partialFileInfo(partialFilename);
+        const QFileInfo proxyFileInfo(QDir(partialFileInfo.canonicalPath())
+                                      .filePath(QFileInfo(proxyFilename).fileName()));
+        VideoIndexCache().save(proxyFileInfo, partialFileInfo.size(), VideoIndex(std::move(_proxyIndexEntries)));
+        QFile::remove(proxyFilename);
+        success = QFile::rename(partialFilename, proxyFilename);
+    }
+    _proxyIndexEntries.clear();
+    if (success) {
+        qDebug() << "transcoding" << lastFrameNumber + 1 << "frames into" << proxyFilename << "took"
+                 << timer.elapsed() << "ms";
+    } else {
+        QFile::remove(partialFilename);
+    }
+    return success;
+}
+
+void ProxyTranscoder::cancel()
+{
+    _cancelled = true;
+}
+
+void ProxyTranscoder::setPreviewFrameStep(int frameStep)
+{
+    _previewFrameStep = frameStep;
+}
+
+/**
+ * Open a Matroska file with an H.264 encoder, or the MPEG-4 encoder if libav was built without an H.264 encoder. A
+ * preview is encoded as Motion JPEG. The frame numbers are used as timestamps, so the time base is the duration of a
+ * single frame.
+ */
+bool ProxyTranscoder::openOutput(const QString &filename, const QSize &frameSize)
+{
+    int errorNr = avformat_alloc_output_context2(&_outputFormatContext, nullptr, "matroska",
+                                                 filename.toStdString().c_str());
+    if (errorNr < 0) {
+        printError(errorNr, QString("Unable to create %1").arg(filename));
+        return false;
+    }
+    AVCodec *encoder;
+    if (_previewFrameStep > 0) {
+        encoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    } else {
+        encoder = avcodec_find_encoder(AV_CODEC_ID_H264);
+        if (!encoder) {
+            encoder = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+        }
+    }
+    if (!encoder) {
+        printError("Unable to find an encoder for the proxy");
+        return false;
+    }
+    _outputStream = avformat_new_stream(_outputFormatContext, nullptr);
+    _encoderContext = avcodec_alloc_context3(encoder);
+    if (!_outputStream || !_encoderContext) {
+        printError("Unable to create the video stream of the proxy");
+        return false;
+    }
+
+    AVRational frameRate = videoStream()->avg_frame_rate;
+    if (frameRate.num <= 0 || frameRate.den <= 0) {
+        frameRate = videoStream()->r_frame_rate;
+    }
+    if (_previewFrameStep > 1) {
+        frameRate = av_div_q(frameRate, av_make_q(_previewFrameStep, 1));
+    }
+    _encoderContext->width = frameSize.width();
+    _encoderContext->height = frameSize.height();
+    _encoderContext->pix_fmt = (encoder->id == AV_CODEC_ID_MJPEG) ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUV420P;
+    _encoderContext->sample_aspect_ratio = codecContext()->sample_aspect_ratio;
+    _encoderContext->time_base = av_inv_q(frameRate);
+    _encoderContext->framerate = frameRate;
+    _encoderContext->gop_size = qMax(1, static_cast<int>(av_q2d(frameRate) * PROXY_KEY_FRAME_INTERVAL_SECONDS));
+    _encoderContext->max_b_frames = 0;
+    _encoderContext->thread_count = 1;
+    if (_outputFormatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+        _encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    AVDictionary *options = nullptr;
+    if (encoder->id == AV_CODEC_ID_H264) {
+        av_dict_set(&options, "preset", H264_PRESET, 0);
+        av_dict_set(&options, "crf", H264_CRF, 0);
+    } else {
+        _encoderContext->flags |= AV_CODEC_FLAG_QSCALE;
+        _encoderContext->global_quality = FF_QP2LAMBDA * ((encoder->id == AV_CODEC_ID_MJPEG) ?
+                                                              PREVIEW_JPEG_QUANTIZER : MPEG4_QUANTIZER);
+    }
+    errorNr = avcodec_open2(_encoderContext, encoder, &options);
+    av_dict_free(&options);
+    if (errorNr < 0) {
+        printError(errorNr, "Unable to open the encoder of the proxy");
+        return false;
+    }
+    _outputStream->time_base = _encoderContext->time_base;
+    _outputStream->avg_frame_rate = frameRate;
+    avcodec_parameters_from_context(_outputStream->codecpar, _encoderContext);
+
+    _scaledFrame = av_frame_alloc();
+    _scaledFrame->width = frameSize.width();
+    _scaledFrame->height = frameSize.height();
+    _scaledFrame->format = _encoderContext->pix_fmt;
+    errorNr = av_frame_get_buffer(_scaledFrame, 32);
+    if (errorNr < 0) {
+        printError(errorNr, "Unable to allocate frame for the proxy");
+        return false;
+    }
+
+    errorNr = avio_open(&_outputFormatContext->pb, filename.toStdString().c_str(), AVIO_FLAG_WRITE);
+    if (errorNr < 0) {
+        printError(errorNr, QString("Unable to open %1").arg(filename));
+        return false;
+    }
+    errorNr = avformat_write_header(_outputFormatContext, nullptr);
+    if (errorNr < 0) {
+        printError(errorNr, QString("Unable to write header of %1").arg(filename));
+        return false;
+    }
+    return true;
+}
+
+bool ProxyTranscoder::encodeFrame(AVFrame *frame)
+{
+    int errorNr = avcodec_send_frame(_encoderContext, frame);
+    if (errorNr < 0) {
+        printError(errorNr, "Unable to encode frame of the proxy");
+        return false;
+    }
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = nullptr;
+    packet.size = 0;
+    while ((errorNr = avcodec_receive_packet(_encoderContext, &packet)) == 0) {
+        av_packet_rescale_ts(&packet, _encoderContext->time_base, _outputStream->time_base);
+        packet.stream_index = _outputStream->index;
+        _proxyIndexEntries.push_back(VideoIndexEntry(packet.pts, packet.dts, -1,
+                                                     (packet.flags & AV_PKT_FLAG_KEY) != 0));
+        // this takes over the packet's data.
+        errorNr = av_interleaved_write_frame(_outputFormatContext, &packet);
+        if (errorNr < 0) {
+            printError(errorNr, "Unable to write frame of the proxy");
+            return false;
+        }
+    }
+    return errorNr == AVERROR(EAGAIN) || errorNr == AVERROR_EOF;
+}
+
+/**
+ * Encode the frame that is in the scaled frame again, for every frame number after \param lastFrameNumber and before
+ * \param frameNumber. The frame is only referenced by the encoder, so it can be sent again with another timestamp.
+ */
+bool ProxyTranscoder::repeatScaledFrame(qint64 lastFrameNumber, qint64 frameNumber)
+{
+    bool success = true;
+    for (qint64 missingFrameNumber = lastFrameNumber + 1; success && missingFrameNumber < frameNumber;
+         ++missingFrameNumber) {
+        _scaledFrame->pts = missingFrameNumber;
+        success = encodeFrame(_scaledFrame);
+    }
+    return success;
+}
+
+void ProxyTranscoder::closeOutput()
+{
+    sws_freeContext(_swsContext);
+    _swsContext = nullptr;
+    av_frame_free(&_scaledFrame);
+    avcodec_free_context(&_encoderContext);
+    if (_outputFormatContext) {
+        if (_outputFormatContext->pb) {
+            avio_closep(&_outputFormatContext->pb);
+        }
+        avformat_free_context(_outputFormatContext);
+        _outputFormatContext = nullptr;
+    }
+    _outputStream = nullptr;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef PROXYTRANSCODER_H
+#define PROXYTRANSCODER_H
+
+#include <atomic>
+#include <vector>
+
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+
+#include "genericvideoreader.h"
+#include "videoindex.h"
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVStream;
+struct SwsContext;
+
+/**
+ * Re-encodes a video into a proxy: a copy that can be seeked quickly. Older videos often have a key frame only every
+ * few hundred frames, or none at all, so a seek has to decode many frames or ends up at the wrong frame. The proxy has
+ * a key frame every half second and no B-frames, and is written in a Matroska container, which keeps an index of the
+ * key frames. Every frame keeps its frame number, so the distances of a RealLifeVideo are the same for the proxy. Frames
+ * that cannot be decoded, or that have the timestamp of another frame, are replaced by the frame before them, so the
+ * proxy has as many frames as the index of the video. The index of the proxy is saved in the VideoIndexCache when
+ * it is written, so the proxy is never played with estimated frame numbers.
+ *
+ * A proxy can also be made as a preview, which has only a frame every second or so, each of which is a JPEG image. It
+ * is small, and any frame can be decoded on its own, so thumbnails are made from it instead of from the video.
+ *
+ * Transcoding uses a single thread for decoding and one for encoding, so the number of proxies that are transcoded at
+ * the same time determines how much of the cpu is used. See ProxyTranscodingQueue.
+ */
+class ProxyTranscoder : public GenericVideoReader
+{
+    Q_OBJECT
+public:
+    explicit ProxyTranscoder(QObject *parent = 0);
+    virtual ~ProxyTranscoder();
+
+    /**
+     * Transcode the video that consists of \param videoFilenames into a single proxy file, \param proxyFilename. The
+     * proxy is written to a temporary file first, which is renamed when it is complete.
+     * @param maximumFrameSize frames larger than this are reduced to fit it, keeping their aspect ratio. If the size
+     * is empty, the proxy has the resolution of the video.
+     * @return true if the proxy was written.
+     */
+    bool transcode(const QStringList &videoFilenames, const QString &proxyFilename, const QSize &maximumFrameSize);
+    /** Stop transcoding. This can be called from another thread than the one that is transcoding. */
+    void cancel();
+    /**
+     * Make a preview instead of a proxy: only every \param frameStep th frame of the video is kept, so frame n of the
+     * preview is frame n * frameStep of the video. This has to be called before transcode().
+     */
+    void setPreviewFrameStep(int frameStep);
+
+private:
+    bool openOutput(const QString &filename, const QSize &frameSize);
+    /** Encode \param frame and write the packets the encoder returns. Pass nullptr to flush the encoder. */
+    bool encodeFrame(AVFrame *frame);
+    bool repeatScaledFrame(qint64 lastFrameNumber, qint64 frameNumber);
+    void closeOutput();
+
+    std::atomic<bool> _cancelled;
+    /** every how many frames of the video a frame is kept in the preview, or 0 when making a proxy. */
+    int _previewFrameStep = 0;
+    AVFormatContext *_outputFormatContext = nullptr;
+    AVCodecContext *_encoderContext = nullptr;
+    AVStream *_outputStream = nullptr;
+    SwsContext *_swsContext = nullptr;
+    AVFrame *_scaledFrame = nullptr;
+    /** the packets written to the proxy, which become the index of the proxy. */
+    std::vector<VideoIndexEntry> _proxyIndexEntries;
+};
+
+#endif // PROXYTRANSCODER_H
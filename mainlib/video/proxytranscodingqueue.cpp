@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "proxytranscodingqueue.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QtDebug>
+
+#include "config/bigringsettings.h"
+#include "model/videoinformation.h"
+#include "proxytranscoder.h"
+#include "thumbnailer.h"
+#include "util/threadrole.h"
+
+namespace
+{
+// previews are only used for thumbnails, which are shown small.
+const QSize PREVIEW_MAXIMUM_FRAME_SIZE(320, 320);
+}
+
+ProxyTranscodingQueue::ProxyTranscodingQueue(QObject *parent) :
+    QObject(parent)
+{
+    qRegisterMetaType<RealLifeVideo>("RealLifeVideo");
+    _threadPool.setMaxThreadCount(BigRingSettings().videoProxyCpuBudget());
+}
+
+ProxyTranscodingQueue::~ProxyTranscodingQueue()
+{
+    _threadPool.clear();
+    {
+        QMutexLocker locker(&_mutex);
+        _stopping = true;
+        for (ProxyTranscoder *transcoder: _runningTranscoders) {
+            transcoder->cancel();
+        }
+    }
+    _threadPool.waitForDone();
+}
+
+bool ProxyTranscodingQueue::enqueue(const RealLifeVideo &rlv, const QSize &maximumFrameSize)
+{
+    return enqueue(rlv, rlv.videoInformation().proxyVideoFilename(), maximumFrameSize, 0);
+}
+
+bool ProxyTranscodingQueue::enqueuePreview(const RealLifeVideo &rlv)
+{
+    const QString previewFilename = Thumbnailer::previewFilePathFor(rlv);
+    if (!rlv.isValid() || rlv.videoInformation().isUpToDate(previewFilename)) {
+        return false;
+    }
+    QFileInfo(previewFilename).dir().mkpath(".");
+    return enqueue(rlv, previewFilename, PREVIEW_MAXIMUM_FRAME_SIZE, Thumbnailer::previewFrameStep(rlv));
+}
+
+bool ProxyTranscodingQueue::enqueue(const RealLifeVideo &rlv, const QString &proxyFilename,
+                                    const QSize &maximumFrameSize, int previewFrameStep)
+{
+    {
+        QMutexLocker locker(&_mutex);
+        if (proxyFilename.isEmpty() || _queuedProxyFilenames.contains(proxyFilename)) {
+            return false;
+        }
+        _queuedProxyFilenames.insert(proxyFilename);
+    }
+    qDebug() << "queueing" << proxyFilename << "for" << rlv.name();
+    QtConcurrent::run(&_threadPool, [this, rlv, proxyFilename, maximumFrameSize, previewFrameStep]() {
+        transcode(rlv, proxyFilename, maximumFrameSize, previewFrameStep);
+    });
+    return true;
+}
+
+bool ProxyTranscodingQueue::isQueued(const RealLifeVideo &rlv) const
+{
+    QMutexLocker locker(&_mutex);
+    return _queuedProxyFilenames.contains(rlv.videoInformation().proxyVideoFilename());
+}
+
+void ProxyTranscodingQueue::transcode(const RealLifeVideo &rlv, const QString &proxyFilename,
+                                      const QSize &maximumFrameSize, int previewFrameStep)
+{
+    // transcoding is not urgent, so let it give way to the rest of the application. The pool is our own, so the
+    // role stays with its threads.
+    indoorcycling::applyThreadRole(indoorcycling::ThreadRole::BACKGROUND);
+
+    ProxyTranscoder transcoder;
+    transcoder.setFileAccess(BigRingSettings().videoFileAccess());
+    transcoder.setThreadRole(indoorcycling::ThreadRole::BACKGROUND);
+    if (previewFrameStep > 0) {
+        transcoder.setPreviewFrameStep(previewFrameStep);
+    }
+    {
+        QMutexLocker locker(&_mutex);
+        if (_stopping) {
+            return;
+        }
+        _runningTranscoders.insert(&transcoder);
+    }
+    // a preview can be made from the proxy, which is quicker to decode, but a proxy has to be made from the video.
+    const QStringList videoFilenames = (previewFrameStep > 0) ? rlv.playbackVideoFilenames() : rlv.videoFilenames();
+    const bool success = transcoder.transcode(videoFilenames, proxyFilename, maximumFrameSize);
+    bool stopping;
+    {
+        QMutexLocker locker(&_mutex);
+        _runningTranscoders.remove(&transcoder);
+        _queuedProxyFilenames.remove(proxyFilename);
+        stopping = _stopping;
+    }
+    if (!stopping) {
+        emit proxyFinished(rlv, success);
+    }
+}
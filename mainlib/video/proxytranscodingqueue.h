@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef PROXYTRANSCODINGQUEUE_H
+#define PROXYTRANSCODINGQUEUE_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QSize>
+#include <QtCore/QThreadPool>
+
+#include "model/reallifevideo.h"
+
+class ProxyTranscoder;
+
+/**
+ * Creates proxies and previews of videos in the background, see ProxyTranscoder. Every video is transcoded on a single
+ * core, so the number of videos that are transcoded at the same time is limited to the number of cores that may be
+ * used for it, BigRingSettings::videoProxyCpuBudget(). Other videos wait in the queue.
+ */
+class ProxyTranscodingQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProxyTranscodingQueue(QObject *parent = 0);
+    /** Stops the proxies that are being transcoded, and waits for them. Proxies that were not complete are removed. */
+    virtual ~ProxyTranscodingQueue();
+
+    /**
+     * Queue creating a proxy of the video of \param rlv, with frames reduced to fit \param maximumFrameSize, or at
+     * the resolution of the video if the size is empty.
+     * @return false if the proxy is already queued.
+     */
+    bool enqueue(const RealLifeVideo &rlv, const QSize &maximumFrameSize);
+    /**
+     * Queue creating a preview of the video of \param rlv, from which thumbnails are made, see
+     * Thumbnailer::previewFilePathFor().
+     * @return false if the preview is already queued, or up to date.
+     */
+    bool enqueuePreview(const RealLifeVideo &rlv);
+    /** true if a proxy of the video of \param rlv is queued or being transcoded. */
+    bool isQueued(const RealLifeVideo &rlv) const;
+
+signals:
+    /** Emitted, from the thread that transcoded it, when a proxy or preview of the video of \param rlv is done. */
+    void proxyFinished(const RealLifeVideo &rlv, bool success);
+
+private:
+    bool enqueue(const RealLifeVideo &rlv, const QString &proxyFilename, const QSize &maximumFrameSize,
+                 int previewFrameStep);
+    void transcode(const RealLifeVideo &rlv, const QString &proxyFilename, const QSize &maximumFrameSize,
+                   int previewFrameStep);
+
+    QThreadPool _threadPool;
+    mutable QMutex _mutex;
+    bool _stopping = false;
+    /** proxy and preview files that are queued or being transcoded. */
+    QSet<QString> _queuedProxyFilenames;
+    QSet<ProxyTranscoder*> _runningTranscoders;
+};
+
+#endif // PROXYTRANSCODINGQUEUE_H
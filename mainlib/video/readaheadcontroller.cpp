@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "readaheadcontroller.h"
+
+#include <cmath>
+
+namespace
+{
+/** Number of seconds ahead for which the frames are predicted. */
+const qreal PREDICTION_SECONDS = 2.0;
+/** weight of a new acceleration in the moving average, as speeds from the trainer are noisy. */
+const qreal ACCELERATION_AVERAGING_WEIGHT = 0.3;
+/** Speeds that are further apart than this are not used to calculate the acceleration, as the ride was paused. */
+const qint64 MAXIMUM_SPEED_INTERVAL_MILLISECONDS = 1000;
+/** Part of the decoding speed that is planned for, so a slow frame does not make the decoder fall behind. */
+const qreal DECODE_SPEED_MARGIN = 0.8;
+/** The decoder always keeps this many frames ahead, even when the cyclist stands still. */
+const int MINIMUM_READ_AHEAD_FRAMES = 8;
+/** Part of the read ahead that is left when it is refilled in a batch. */
+const qreal REFILL_PART = 0.5;
+/** weight of a new frame in the moving average of the decoding time */
+const qreal FRAME_TIME_AVERAGING_WEIGHT = 0.05;
+}
+
+ReadAheadController::ReadAheadController(int maximumStepSize) :
+    _maximumStepSize(qMax(1, maximumStepSize))
+{
+    // empty
+}
+
+void ReadAheadController::setSpeed(qreal metersPerSecond, qint64 timestampMilliseconds)
+{
+    const qint64 interval = timestampMilliseconds - _speedTimestamp;
+    if (_speedTimestamp >= 0 && interval > 0 && interval <= MAXIMUM_SPEED_INTERVAL_MILLISECONDS) {
+        const qreal acceleration = (metersPerSecond - _speed) * 1000 / interval;
+        _acceleration += ACCELERATION_AVERAGING_WEIGHT * (acceleration - _acceleration);
+    } else if (interval != 0) {
+        _acceleration = 0;
+    }
+    _speed = qMax(qreal(0), metersPerSecond);
+    _speedTimestamp = timestampMilliseconds;
+}
+
+void ReadAheadController::setMetersPerFrame(qreal metersPerFrame)
+{
+    _metersPerFrame = metersPerFrame;
+}
+
+void ReadAheadController::setDecodeFramesPerSecond(qreal decodeFramesPerSecond)
+{
+    _decodeFramesPerSecond = decodeFramesPerSecond;
+}
+
+void ReadAheadController::addDecodedFrame(int skipFrames, qint64 decodeNanoseconds, qint64 copyNanoseconds)
+{
+    // the decoding time includes the skipped frames. Counted per decoded frame, a bigger step size would look like
+    // slower decoding, which calls for an even bigger step size.
+    const qreal frameNanoseconds = static_cast<qreal>(decodeNanoseconds) / (qMax(0, skipFrames) + 1) + copyNanoseconds;
+    if (frameNanoseconds <= 0) {
+        return;
+    }
+    if (_averageFrameNanoseconds == 0) {
+        _averageFrameNanoseconds = frameNanoseconds;
+    } else {
+        _averageFrameNanoseconds += FRAME_TIME_AVERAGING_WEIGHT * (frameNanoseconds - _averageFrameNanoseconds);
+    }
+    _decodeFramesPerSecond = 1e9 / _averageFrameNanoseconds;
+}
+
+qreal ReadAheadController::decodeFramesPerSecond() const
+{
+    return _decodeFramesPerSecond;
+}
+
+void ReadAheadController::reset()
+{
+    _speed = 0;
+    _acceleration = 0;
+    _speedTimestamp = -1;
+}
+
+qreal ReadAheadController::acceleration() const
+{
+    return _acceleration;
+}
+
+qreal ReadAheadController::predictedFrames() const
+{
+    if (_metersPerFrame <= 0) {
+        return 0;
+    }
+    qreal meters;
+    if (_acceleration < 0 && _speed + _acceleration * PREDICTION_SECONDS < 0) {
+        // the cyclist comes to a stop before the end of the prediction time.
+        meters = _speed * _speed / (-2 * _acceleration);
+    } else {
+        meters = _speed * PREDICTION_SECONDS + _acceleration * PREDICTION_SECONDS * PREDICTION_SECONDS / 2;
+    }
+    return meters / _metersPerFrame;
+}
+
+qreal ReadAheadController::peakFramesPerSecond() const
+{
+    if (_metersPerFrame <= 0) {
+        return 0;
+    }
+    const qreal peakSpeed = qMax(_speed, _speed + _acceleration * PREDICTION_SECONDS);
+    return peakSpeed / _metersPerFrame;
+}
+
+int ReadAheadController::stepSize() const
+{
+    if (_decodeFramesPerSecond <= 0) {
+        return 1;
+    }
+    const qreal stepSize = std::ceil(peakFramesPerSecond() / (_decodeFramesPerSecond * DECODE_SPEED_MARGIN));
+    return qBound(1, static_cast<int>(stepSize), _maximumStepSize);
+}
+
+int ReadAheadController::readAheadFrames() const
+{
+    const int frames = static_cast<int>(std::ceil(predictedFrames() / stepSize()));
+    return qMax(MINIMUM_READ_AHEAD_FRAMES, frames);
+}
+
+int ReadAheadController::refillFrames() const
+{
+    return static_cast<int>(readAheadFrames() * REFILL_PART);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef READAHEADCONTROLLER_H
+#define READAHEADCONTROLLER_H
+
+#include <QtCore/QtGlobal>
+
+/**
+ * Predicts how many frames of a video are needed in the next seconds of a ride, from the speed and acceleration of
+ * the cyclist and the number of meters per frame of the video. The VideoPlayer uses the prediction to choose how many
+ * frames the reader skips, before the frames that are shown run past the frames that are decoded, and as the least
+ * number of frames that should be decoded ahead. In energy saving mode, no more frames than that are decoded ahead.
+ */
+class ReadAheadController
+{
+public:
+    /** @param maximumStepSize the highest number of video frames that are advanced for every decoded frame. */
+    explicit ReadAheadController(int maximumStepSize);
+
+    /**
+     * Set the speed of the cyclist, in meters per second. The acceleration is derived from the speeds that are set.
+     * @param timestampMilliseconds the time of the speed, from any fixed point in time.
+     */
+    void setSpeed(qreal metersPerSecond, qint64 timestampMilliseconds);
+    /** Set the number of meters per frame of the video at the current position. */
+    void setMetersPerFrame(qreal metersPerFrame);
+    /** Set the observed decoding speed, in frames per second. */
+    void setDecodeFramesPerSecond(qreal decodeFramesPerSecond);
+    /**
+     * Count a decoded frame in a moving average of the decoding speed.
+     * @param skipFrames number of frames of the video that were skipped before the frame.
+     * @param decodeNanoseconds time it took to decode the frame, including the skipped frames.
+     * @param copyNanoseconds time it took to copy the frame into its frame buffer.
+     */
+    void addDecodedFrame(int skipFrames, qint64 decodeNanoseconds, qint64 copyNanoseconds);
+    /** the observed decoding speed, in frames of the video per second, or 0 if it is not known yet. */
+    qreal decodeFramesPerSecond() const;
+    /** Forget the speed and acceleration, for instance because the ride starts at another position. */
+    void reset();
+
+    /** the acceleration of the cyclist, in meters per second squared. */
+    qreal acceleration() const;
+    /** number of video frames that are passed in the prediction time, at the current speed and acceleration. */
+    qreal predictedFrames() const;
+    /** the highest number of video frames per second that is passed in the prediction time. */
+    qreal peakFramesPerSecond() const;
+    /**
+     * Number of video frames to advance for every decoded frame, so the decoder keeps up with the peak frame rate. 1
+     * means that no frames are skipped.
+     */
+    int stepSize() const;
+    /** Number of decoded frames that cover the prediction time, with stepSize(). */
+    int readAheadFrames() const;
+    /**
+     * Number of decoded frames ahead below which the read ahead is refilled in one batch, when decoding in batches.
+     * The decoder then works in bursts and sleeps in between, instead of waking up for every frame that is shown.
+     */
+    int refillFrames() const;
+
+private:
+    const int _maximumStepSize;
+    qreal _speed = 0;
+    qreal _acceleration = 0;
+    /** timestamp of the last speed, or -1 if no speed was set. */
+    qint64 _speedTimestamp = -1;
+    qreal _metersPerFrame = 0;
+    qreal _decodeFramesPerSecond = 0;
+    /** moving average of the time it takes to decode and copy a frame of the video. */
+    qreal _averageFrameNanoseconds = 0;
+};
+
+#endif // READAHEADCONTROLLER_H
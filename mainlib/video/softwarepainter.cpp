@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "softwarepainter.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtDebug>
+#include <QtGui/QPainter>
+
+SoftwarePainter::SoftwarePainter(QObject *parent) :
+    VideoPainter(parent)
+{
+    qDebug() << "painting video using" << indoorcycling::instructionSetName(_converter.instructionSet());
+}
+
+SoftwarePainter::~SoftwarePainter()
+{
+    // make sure the frame buffers cannot be used anymore, as their memory is about to be freed.
+    closeFrameSlots();
+}
+
+void SoftwarePainter::paint(QPainter *painter, const QRectF &rect, Qt::AspectRatioMode aspectRatioMode)
+{
+    if (!_firstFrameLoaded) {
+        painter->fillRect(rect, Qt::black);
+        return;
+    }
+
+    adjustPaintAreas(rect, aspectRatioMode);
+    countPaint(updateImage(), _frameFormat.bufferSize());
+
+    painter->drawImage(_videoRect.topLeft(), _scaledImage);
+    painter->fillRect(_blackBar1, Qt::black);
+    painter->fillRect(_blackBar2, Qt::black);
+}
+
+/**
+ * Convert the current frame to RGB and scale it, if that was not done before.
+ * @return true if the current frame was converted.
+ */
+bool SoftwarePainter::updateImage()
+{
+    bool converted = false;
+    const int index = _frameRing.shownBuffer();
+    const qint64 frameNumber = _frameRing.frameNumber(index);
+    if (frameNumber >= 0 && frameNumber != _imageFrameNumber && index < static_cast<int>(_pixelBuffers.size())) {
+        const quint8 *pixelBuffer = _pixelBuffers[index].data();
+        if (_image.size() != _sourcePictureSize) {
+            _image = QImage(_sourcePictureSize, QImage::Format_RGB32);
+        }
+        QElapsedTimer convertTimer;
+        convertTimer.start();
+        _converter.convert(_frameFormat, pixelBuffer, _sourcePictureSize.width(), _sourcePictureSize.height(),
+                           _image.bits(), _image.bytesPerLine());
+        _pipelineTimings->record(PipelineStage::UPLOAD, convertTimer.nsecsElapsed());
+        _imageFrameNumber = frameNumber;
+        _scaledImageDirty = true;
+        converted = true;
+    }
+    if (_scaledImageDirty) {
+        const QSize videoSize = _videoRect.size().toSize();
+        if (videoSize == _image.size()) {
+            _scaledImage = _image;
+        } else {
+            _scaledImage = _image.scaled(videoSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        _scaledImageDirty = false;
+    }
+    return converted;
+}
+
+void *SoftwarePainter::frameBufferToFill(int index)
+{
+    return _pixelBuffers[index].data();
+}
+
+void SoftwarePainter::resizeBuffers(int size, const FrameFormat &frameFormat)
+{
+    _pixelBuffers.assign(static_cast<std::size_t>(size), std::vector<quint8>(frameFormat.bufferSize()));
+    _imageFrameNumber = -1;
+}
+
+void SoftwarePainter::setVideoSize(const QSize &videoSize, const FrameFormat &frameFormat)
+{
+    if (frameFormat != _frameFormat) {
+        _frameFormat = frameFormat;
+        _sourcePictureSize = videoSize;
+        _imageFrameNumber = -1;
+        _targetRect = QRectF();
+    }
+    resizeFrameRing(frameFormat);
+}
+
+void SoftwarePainter::setFrameLoaded(int index, qint64 frameNumber)
+{
+    _frameRing.setFrameLoaded(index, frameNumber);
+    _firstFrameLoaded |= (frameNumber >= 0);
+}
+
+void SoftwarePainter::adjustPaintAreas(const QRectF &targetRect, Qt::AspectRatioMode aspectRatioMode)
+{
+    if (targetRect != _targetRect || aspectRatioMode != _aspectRatioMode) {
+        _targetRect = targetRect;
+        _aspectRatioMode = aspectRatioMode;
+
+        const QSizeF videoSizeAdjusted(QSizeF(_sourcePictureSize).scaled(targetRect.size(), aspectRatioMode));
+        _videoRect = QRectF(QPointF(), videoSizeAdjusted);
+        _videoRect.moveCenter(targetRect.center());
+
+        if (targetRect.left() == _videoRect.left()) {
+            // black bars on top and bottom
+            _blackBar1 = QRectF(targetRect.topLeft(), _videoRect.topRight());
+            _blackBar2 = QRectF(_videoRect.bottomLeft(), targetRect.bottomRight());
+        } else {
+            // black bars on the sides
+            _blackBar1 = QRectF(targetRect.topLeft(), _videoRect.bottomLeft());
+            _blackBar2 = QRectF(_videoRect.topRight(), targetRect.bottomRight());
+        }
+        _scaledImageDirty = true;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOFTWAREPAINTER_H
+#define SOFTWAREPAINTER_H
+
+#include <vector>
+#include <QtGui/QImage>
+
+#include "videopainter.h"
+#include "yuvtorgbconverter.h"
+
+/**
+ * Paints video frames without OpenGL, for systems on which OpenGL does not work well. Frames are converted to RGB
+ * and scaled on the cpu, and painted with QPainter.
+ *
+ * Only frames that are actually shown are converted, and every frame is converted and scaled only once, no matter how
+ * many times it is painted.
+ */
+class SoftwarePainter : public VideoPainter
+{
+    Q_OBJECT
+public:
+    explicit SoftwarePainter(QObject *parent = 0);
+    virtual ~SoftwarePainter();
+
+    virtual void paint(QPainter* painter, const QRectF& rect, Qt::AspectRatioMode aspectRatioMode) override;
+public slots:
+    virtual void setVideoSize(const QSize& videoSize, const FrameFormat &frameFormat) override;
+protected:
+    virtual void *frameBufferToFill(int index) override;
+    virtual void setFrameLoaded(int index, qint64 frameNumber) override;
+    virtual void resizeBuffers(int size, const FrameFormat &frameFormat) override;
+private:
+    void adjustPaintAreas(const QRectF& targetRect, Qt::AspectRatioMode aspectRatioMode);
+    bool updateImage();
+
+    /** Buffers in memory for the frames, in the same layout as the pixel buffers of the OpenGLPainter2. */
+    std::vector<std::vector<quint8>> _pixelBuffers;
+
+    const YuvToRgbConverter _converter;
+    bool _firstFrameLoaded = false;
+    FrameFormat _frameFormat;
+    QSize _sourcePictureSize;
+    QRectF _targetRect;
+    QRectF _videoRect;
+    QRectF _blackBar1, _blackBar2;
+    Qt::AspectRatioMode _aspectRatioMode = Qt::KeepAspectRatioByExpanding;
+
+    /** The frame in RGB, in the size of the video */
+    QImage _image;
+    /** _image, scaled to the size in which it is painted */
+    QImage _scaledImage;
+    /** frame number of the frame in _image, or -1 if _image needs to be updated. */
+    qint64 _imageFrameNumber = -1;
+    bool _scaledImageDirty = true;
+};
+
+#endif // SOFTWAREPAINTER_H
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "throttledfile.h"
+
+#include <QtCore/QThread>
+
+ThrottledFile::ThrottledFile(const QString &name, qint64 bytesPerSecond, int latencyMicroseconds, QObject *parent):
+    QFile(name, parent), _bytesPerSecond(bytesPerSecond), _latencyMicroseconds(latencyMicroseconds), _reads(0),
+    _bytesRead(0)
+{
+    // empty
+}
+
+int ThrottledFile::reads() const
+{
+    return _reads;
+}
+
+qint64 ThrottledFile::bytesRead() const
+{
+    return _bytesRead;
+}
+
+qint64 ThrottledFile::readData(char *data, qint64 maxSize)
+{
+    const qint64 bytesRead = QFile::readData(data, maxSize);
+    qint64 microseconds = _latencyMicroseconds;
+    if (_bytesPerSecond > 0 && bytesRead > 0) {
+        microseconds += bytesRead * 1000000 / _bytesPerSecond;
+    }
+    if (microseconds > 0) {
+        QThread::usleep(static_cast<unsigned long>(microseconds));
+    }
+    ++_reads;
+    if (bytesRead > 0) {
+        _bytesRead += bytesRead;
+    }
+    return bytesRead;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef THROTTLEDFILE_H
+#define THROTTLEDFILE_H
+
+#include <atomic>
+#include <QtCore/QFile>
+
+/**
+ * A file that is read slowly, to simulate a video library on a network share or a busy disk. Every read from the
+ * file waits for the latency, and for the time it takes to transfer the bytes at the bandwidth.
+ *
+ * The file has to be opened with QIODevice::Unbuffered, so every read is throttled.
+ */
+class ThrottledFile : public QFile
+{
+    Q_OBJECT
+public:
+    /**
+     * @param bytesPerSecond the bandwidth of the simulated storage, or 0 for unlimited bandwidth.
+     * @param latencyMicroseconds the time every read takes, on top of the time needed for the bandwidth.
+     */
+    explicit ThrottledFile(const QString &name, qint64 bytesPerSecond, int latencyMicroseconds, QObject *parent = 0);
+
+    /** number of reads from the file since it was created. */
+    int reads() const;
+    /** number of bytes read from the file since it was created. */
+    qint64 bytesRead() const;
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    const qint64 _bytesPerSecond;
+    const int _latencyMicroseconds;
+    std::atomic<int> _reads;
+    std::atomic<qint64> _bytesRead;
+};
+
+#endif // THROTTLEDFILE_H
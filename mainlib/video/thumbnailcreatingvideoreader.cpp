@@ -14,6 +14,9 @@ extern "C" {
 }
 
 #include "model/reallifevideo.h"
+#include "model/videoinformation.h"
+#include "thumbnailer.h"
+#include "util/threadrole.h"
 
 namespace {
 QEvent::Type CreateImageForFrameEventType = static_cast<QEvent::Type>(QEvent::User + 102);
@@ -48,9 +51,12 @@ void ThumbnailCreatingVideoReader::createImageForFrame(const RealLifeVideo& rlv,
     QCoreApplication::postEvent(this, new CreateImageForFrameEvent(rlv, distance));
 }
 
-void ThumbnailCreatingVideoReader::openVideoFileInternal(const QString &videoFilename)
+void ThumbnailCreatingVideoReader::openVideoFileInternal(const QStringList &videoFilenames)
 {
-    GenericVideoReader::openVideoFileInternal(videoFilename);
+    GenericVideoReader::openVideoFileInternal(videoFilenames);
+    if (!codecContext()) {
+        return;
+    }
 
     _frameRgb.reset(new AVFrameWrapper);
     int numBytes= avpicture_get_size(AV_PIX_FMT_RGB24,
@@ -59,16 +65,24 @@ void ThumbnailCreatingVideoReader::openVideoFileInternal(const QString &videoFil
     avpicture_fill(_frameRgb->asPicture(), reinterpret_cast<uint8_t*>(_imageBuffer.data()), AV_PIX_FMT_RGB24,
                    codecContext()->width, codecContext()->height);
 
-    _swsContext = sws_getContext(codecContext()->width, codecContext()->height, AV_PIX_FMT_YUV420P,
+    _swsContext = sws_getContext(codecContext()->width, codecContext()->height, codecContext()->pix_fmt,
                                  codecContext()->width, codecContext()->height, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR,
                                  nullptr, nullptr, nullptr);
 }
 
-void ThumbnailCreatingVideoReader::createImageForFrameNumber(RealLifeVideo& rlv, const qreal distance)
+/**
+ * Create the image for \param distance from the opened video, which has a frame for every \param frameStep frames of
+ * the video of \param rlv.
+ */
+void ThumbnailCreatingVideoReader::createImageForFrameNumber(RealLifeVideo& rlv, const qreal distance, int frameStep)
 {
     // the first few frames are sometimes black, so when requested to take a "screenshot" of the first frames, just
     // skip to a few frames after the start.
     qint64 frameNumber = qMax(20, static_cast<int>(rlv.frameForDistance(distance)));
+    if (frameStep > 1) {
+        // the first frame of a preview could be black as well.
+        frameNumber = qMax(static_cast<qint64>(1), frameNumber / frameStep);
+    }
     qDebug() << "creating image for" << rlv.name() << "distance" << distance << "frame nr" << frameNumber;
     performSeek(frameNumber);
     loadFramesUntilTargetFrame(frameNumber);
@@ -83,10 +97,17 @@ bool ThumbnailCreatingVideoReader::event(QEvent *event)
         RealLifeVideo& rlv = createImageForFrameEvent->_rlv;
         const qreal distance = createImageForFrameEvent->_distance;
         qDebug() << "creating thumbnail for rlv" << rlv.name();
-        openVideoFileInternal(rlv.videoFilename());
-
-        rlv.setNumberOfFrames(totalNumberOfFrames());
-        createImageForFrameNumber(rlv, distance);
+        indoorcycling::beginBackgroundWork();
+        const QString previewFilename = Thumbnailer::previewFilePathFor(rlv);
+        if (rlv.videoInformation().isUpToDate(previewFilename)) {
+            openVideoFileInternal(QStringList(previewFilename));
+            createImageForFrameNumber(rlv, distance, Thumbnailer::previewFrameStep(rlv));
+        } else {
+            openVideoFileInternal(rlv.playbackVideoFilenames());
+            rlv.setNumberOfFrames(totalNumberOfFrames());
+            createImageForFrameNumber(rlv, distance, 1);
+        }
+        indoorcycling::throttleBackgroundWork();
         return true;
     }
     return GenericVideoReader::event(event);
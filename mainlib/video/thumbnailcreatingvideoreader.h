@@ -24,9 +24,9 @@ signals:
 protected:
     virtual bool event(QEvent *) override;
 private:
-    virtual void openVideoFileInternal(const QString& videoFilename) override;
+    virtual void openVideoFileInternal(const QStringList& videoFilenames) override;
 
-    void createImageForFrameNumber(RealLifeVideo &rlv, const qreal distance);
+    void createImageForFrameNumber(RealLifeVideo &rlv, const qreal distance, int frameStep);
     QImage createImage();
 
     bool _initialized;
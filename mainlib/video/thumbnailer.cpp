@@ -28,6 +28,7 @@
 #include <QtGui/QPainter>
 
 #include "thumbnailcreatingvideoreader.h"
+#include "util/threadrole.h"
 
 namespace
 {
@@ -45,6 +46,7 @@ Thumbnailer::Thumbnailer(QObject *parent): QObject(parent), _videoReader(new Thu
     _emptyPixmap = createEmptyPixmap();
 
     // the video reader is running on a seperate thread, so it will not block the UI when decoding video frames.
+    _videoReader->setThreadRole(indoorcycling::ThreadRole::BACKGROUND);
     _videoReader->moveToThread(_videoReaderThread);
 
     connect(_videoReader, &ThumbnailCreatingVideoReader::newFrameReady, this, &Thumbnailer::setNewFrame);
@@ -52,7 +54,7 @@ Thumbnailer::Thumbnailer(QObject *parent): QObject(parent), _videoReader(new Thu
     // Make sure that when the videoReaderThread is stopped and it is deleted
     connect(_videoReaderThread, &QThread::finished, _videoReaderThread, &QThread::deleteLater);
     connect(_videoReaderThread, &QThread::finished, _videoReader, &ThumbnailCreatingVideoReader::deleteLater);
-    _videoReaderThread->start();
+    indoorcycling::startThread(_videoReaderThread, indoorcycling::ThreadRole::BACKGROUND);
 }
 
 Thumbnailer::~Thumbnailer()
@@ -144,6 +146,26 @@ QDir Thumbnailer::thumbnailDirectory()
     }
 }
 
+QDir Thumbnailer::previewDirectory()
+{
+    QStringList paths = QStandardPaths::standardLocations(QStandardPaths::CacheLocation);
+    if (paths.isEmpty()) {
+        return QDir("/tmp/previews");
+    } else {
+        return QDir(QString("%1/previews").arg(paths[0]));
+    }
+}
+
+QString Thumbnailer::previewFilePathFor(const RealLifeVideo &rlv)
+{
+    return previewDirectory().absoluteFilePath(QString("%1.mkv").arg(rlv.name()));
+}
+
+int Thumbnailer::previewFrameStep(const RealLifeVideo &rlv)
+{
+    return qMax(1, qRound(rlv.videoFrameRate()));
+}
+
 bool Thumbnailer::doesThumbnailExistsFor(const RealLifeVideo &rlv, const qreal distance)
 {
     QFile cacheFile(cacheFilePathFor(rlv, distance));
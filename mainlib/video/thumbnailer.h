@@ -42,6 +42,14 @@ public:
 
     QPixmap thumbnailFor(RealLifeVideo &rlv, const qreal distance = 0.0);
 
+    /**
+     * The file of the preview of the video of \param rlv, a small copy with a frame every second, from which thumbnails
+     * are made when it exists. Previews are kept in the cache directory. See ProxyTranscoder.
+     */
+    static QString previewFilePathFor(const RealLifeVideo &rlv);
+    /** The number of frames of the video of \param rlv for every frame of its preview. */
+    static int previewFrameStep(const RealLifeVideo &rlv);
+
 signals:
     void pixmapUpdated(const RealLifeVideo& rlv, const qreal distance, QPixmap pixmap);
 
@@ -49,6 +57,7 @@ private slots:
     void setNewFrame(const RealLifeVideo &rlv, const qreal distance, const QImage& frame);
 private:
     static QDir thumbnailDirectory();
+    static QDir previewDirectory();
     QPixmap createTextPixmap(const QString& text) const;
     QPixmap createEmptyPixmap() const;
     QPixmap createInvalidPixmap() const;
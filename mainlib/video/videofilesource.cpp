@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videofilesource.h"
+
+#include <cstring>
+#include <QtCore/QtDebug>
+
+const qint64 VideoFileSource::BLOCK_SIZE;
+const int VideoFileSource::BLOCK_COUNT;
+
+VideoFileSource::VideoFileSource(std::unique_ptr<QFile> file, VideoFileAccess fileAccess, QObject *parent):
+    QThread(parent), _file(std::move(file)), _fileAccess(fileAccess)
+{
+    // empty
+}
+
+VideoFileSource::~VideoFileSource()
+{
+    stop();
+    wait();
+    if (_mappedData) {
+        _file->unmap(const_cast<uchar*>(_mappedData));
+    }
+    _file->close();
+}
+
+bool VideoFileSource::open()
+{
+    if (!_file->open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qWarning("Unable to open %s: %s", qPrintable(_file->fileName()), qPrintable(_file->errorString()));
+        return false;
+    }
+    _size = _file->size();
+    if (_fileAccess == VideoFileAccess::MEMORY_MAPPED) {
+        _mappedData = _file->map(0, _size);
+        if (!_mappedData) {
+            qWarning("Unable to map %s into memory, reading ahead instead.", qPrintable(_file->fileName()));
+            _fileAccess = VideoFileAccess::READ_AHEAD;
+        }
+    }
+    if (_fileAccess == VideoFileAccess::READ_AHEAD) {
+        _blocks.resize(BLOCK_COUNT);
+        for (Block &block: _blocks) {
+            block.data.resize(static_cast<std::size_t>(BLOCK_SIZE));
+        }
+        indoorcycling::startThread(this, _threadRole);
+    }
+    return true;
+}
+
+void VideoFileSource::setThreadRole(indoorcycling::ThreadRole threadRole)
+{
+    _threadRole = threadRole;
+}
+
+VideoFileAccess VideoFileSource::fileAccess() const
+{
+    return _fileAccess;
+}
+
+qint64 VideoFileSource::size() const
+{
+    return _size;
+}
+
+qint64 VideoFileSource::position() const
+{
+    return _position;
+}
+
+bool VideoFileSource::seek(qint64 position)
+{
+    if (position < 0 || position > _size) {
+        return false;
+    }
+    _position = position;
+    return true;
+}
+
+qint64 VideoFileSource::read(char *data, qint64 maxSize)
+{
+    switch (_fileAccess) {
+    case VideoFileAccess::READ_AHEAD:
+        return readAhead(data, maxSize);
+    case VideoFileAccess::MEMORY_MAPPED:
+    {
+        const qint64 length = qBound(Q_INT64_C(0), maxSize, _size - _position);
+        std::memcpy(data, _mappedData + _position, static_cast<std::size_t>(length));
+        _position += length;
+        return length;
+    }
+    default:
+        if (_file->pos() != _position && !_file->seek(_position)) {
+            return -1;
+        }
+        const qint64 length = _file->read(data, maxSize);
+        if (length > 0) {
+            _position += length;
+        }
+        return length;
+    }
+}
+
+void VideoFileSource::prefetch(qint64 position)
+{
+    if (_fileAccess != VideoFileAccess::READ_AHEAD || position < 0 || position >= _size) {
+        return;
+    }
+    QMutexLocker locker(&_mutex);
+    setReadAheadBlock(position / BLOCK_SIZE);
+}
+
+/**
+ * Copy the bytes from the blocks that were read ahead. If a block is not read yet, the read ahead is moved to that
+ * block, and we wait until the reading thread has read it.
+ */
+qint64 VideoFileSource::readAhead(char *data, qint64 maxSize)
+{
+    QMutexLocker locker(&_mutex);
+    qint64 bytesRead = 0;
+    while (bytesRead < maxSize && _position < _size) {
+        const qint64 index = _position / BLOCK_SIZE;
+        setReadAheadBlock(index);
+        if (_failedBlock == index) {
+            // retry a block that failed while it was read ahead, as it is needed now.
+            _failedBlock = -1;
+            _blockNeeded.wakeOne();
+        }
+        const int failures = _failures;
+        int slot;
+        while ((slot = slotForBlock(index)) < 0) {
+            if (_failures != failures && _failedBlock == index) {
+                return (bytesRead > 0) ? bytesRead : -1;
+            }
+            _blockLoaded.wait(&_mutex);
+            // a prefetch may have moved the read ahead while we were waiting.
+            setReadAheadBlock(index);
+        }
+        Block &block = _blocks[static_cast<std::size_t>(slot)];
+        block.lastUse = ++_uses;
+        const qint64 offset = _position - index * BLOCK_SIZE;
+        const qint64 length = qMin(maxSize - bytesRead, block.length - offset);
+        if (length <= 0) {
+            // the file is shorter than it was when it was opened.
+            break;
+        }
+        std::memcpy(data + bytesRead, block.data.data() + offset, static_cast<std::size_t>(length));
+        bytesRead += length;
+        _position += length;
+    }
+    return bytesRead;
+}
+
+void VideoFileSource::setReadAheadBlock(qint64 index)
+{
+    if (index != _readAheadBlock) {
+        _readAheadBlock = index;
+        _blockNeeded.wakeOne();
+    }
+}
+
+int VideoFileSource::slotForBlock(qint64 index) const
+{
+    for (std::size_t i = 0; i < _blocks.size(); ++i) {
+        if (_blocks[i].index == index) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+/** The first block of the read ahead that is not read yet, or -1 if all blocks of the read ahead are read. */
+qint64 VideoFileSource::blockToLoad() const
+{
+    for (qint64 index = _readAheadBlock; isInReadAhead(index) && index * BLOCK_SIZE < _size; ++index) {
+        if (index != _failedBlock && slotForBlock(index) < 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/** An empty slot, or the least recently used slot with a block outside of the read ahead. */
+int VideoFileSource::slotToReplace() const
+{
+    int replaceSlot = -1;
+    for (std::size_t i = 0; i < _blocks.size(); ++i) {
+        const Block &block = _blocks[i];
+        if (static_cast<int>(i) == _loadingSlot) {
+            continue;
+        }
+        if (block.index < 0) {
+            return static_cast<int>(i);
+        }
+        if (!isInReadAhead(block.index) &&
+                (replaceSlot < 0 || block.lastUse < _blocks[static_cast<std::size_t>(replaceSlot)].lastUse)) {
+            replaceSlot = static_cast<int>(i);
+        }
+    }
+    return replaceSlot;
+}
+
+bool VideoFileSource::isInReadAhead(qint64 index) const
+{
+    return index >= _readAheadBlock && index < _readAheadBlock + BLOCK_COUNT;
+}
+
+/**
+ * Read the block with \param index from the file into \param data.
+ * @return the number of bytes read, which is less than BLOCK_SIZE for the last block, or -1 on a read error.
+ */
+qint64 VideoFileSource::readBlock(qint64 index, char *data)
+{
+    if (!_file->seek(index * BLOCK_SIZE)) {
+        return -1;
+    }
+    qint64 length = 0;
+    while (length < BLOCK_SIZE) {
+        const qint64 bytesRead = _file->read(data + length, BLOCK_SIZE - length);
+        if (bytesRead < 0) {
+            return -1;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        length += bytesRead;
+    }
+    return length;
+}
+
+/**
+ * Read the blocks of the read ahead that are not read yet. The file is only accessed from this thread, and the
+ * mutex is not held while reading, so the blocks that were read already can be used in the meantime.
+ */
+void VideoFileSource::run()
+{
+    QMutexLocker locker(&_mutex);
+    while (!_stopped) {
+        const qint64 index = blockToLoad();
+        const int slot = (index >= 0) ? slotToReplace() : -1;
+        if (slot < 0) {
+            _blockNeeded.wait(&_mutex);
+            continue;
+        }
+        Block &block = _blocks[static_cast<std::size_t>(slot)];
+        block.index = -1;
+        _loadingSlot = slot;
+        locker.unlock();
+
+        const qint64 length = readBlock(index, block.data.data());
+
+        locker.relock();
+        _loadingSlot = -1;
+        if (length < 0) {
+            qWarning("Unable to read %s at %lld: %s", qPrintable(_file->fileName()), index * BLOCK_SIZE,
+                     qPrintable(_file->errorString()));
+            _failedBlock = index;
+            ++_failures;
+        } else {
+            block.index = index;
+            block.length = length;
+            block.lastUse = _uses;
+        }
+        _blockLoaded.wakeAll();
+    }
+}
+
+void VideoFileSource::stop()
+{
+    QMutexLocker locker(&_mutex);
+    _stopped = true;
+    _blockNeeded.wakeAll();
+}
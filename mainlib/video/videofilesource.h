@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOFILESOURCE_H
+#define VIDEOFILESOURCE_H
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "config/bigringsettings.h"
+#include "util/threadrole.h"
+
+/**
+ * Reads a video file for libav, through a custom AVIOContext, so the reads suit the storage the file is on.
+ *
+ * - With VideoFileAccess::DIRECT, every read of libav is a read from the file.
+ * - With VideoFileAccess::READ_AHEAD, the file is read in large blocks on a separate thread. The blocks after the
+ *   block that is read last are read ahead, so steady playback does not wait for the disk, and a network share sees
+ *   a few large reads instead of many small ones. prefetch() moves the read ahead to where the next packets are,
+ *   for instance the key frame a seek will start from.
+ * - With VideoFileAccess::MEMORY_MAPPED, the file is mapped into memory, and the operating system reads ahead. If the
+ *   file cannot be mapped, it is read ahead instead.
+ *
+ * read(), seek() and position() should be called from a single thread, normally the thread of the Demuxer.
+ * prefetch() can be called from any thread.
+ */
+class VideoFileSource : public QThread
+{
+    Q_OBJECT
+public:
+    /** size of the blocks that are read ahead. */
+    static const qint64 BLOCK_SIZE = 2 * 1024 * 1024;
+    /** number of blocks that are kept, so this many blocks are read ahead. */
+    static const int BLOCK_COUNT = 16;
+
+    /** @param file the video file, which is opened by open(). With read ahead, it is read from the source's thread. */
+    explicit VideoFileSource(std::unique_ptr<QFile> file, VideoFileAccess fileAccess, QObject *parent = 0);
+    /** Stop reading ahead and close the file. */
+    virtual ~VideoFileSource();
+
+    /**
+     * Open the file, and start reading ahead if needed.
+     * @return false if the file could not be opened.
+     */
+    bool open();
+    /** Set the role of the read ahead thread. This should be set before open(). */
+    void setThreadRole(indoorcycling::ThreadRole threadRole);
+    /** The way the file is read. This is READ_AHEAD if the file could not be memory mapped. */
+    VideoFileAccess fileAccess() const;
+    /** size of the file in bytes. */
+    qint64 size() const;
+    /** the position of the next read. */
+    qint64 position() const;
+    /**
+     * Set the position of the next read to \param position.
+     * @return false if the position is outside of the file.
+     */
+    bool seek(qint64 position);
+    /**
+     * Read up to \param maxSize bytes into \param data from the current position. This blocks until the bytes are
+     * read from the file.
+     * @return the number of bytes read, 0 at the end of the file or -1 if the file could not be read.
+     */
+    qint64 read(char *data, qint64 maxSize);
+    /** Read ahead from \param position, because the data there will be needed soon. */
+    void prefetch(qint64 position);
+
+protected:
+    virtual void run() override;
+
+private:
+    /** A block of the file, read from the file position index * BLOCK_SIZE. */
+    struct Block {
+        qint64 index = -1;
+        qint64 length = 0;
+        quint64 lastUse = 0;
+        std::vector<char> data;
+    };
+
+    qint64 readAhead(char *data, qint64 maxSize);
+    /** Move the read ahead to the block with \param index. */
+    void setReadAheadBlock(qint64 index);
+    int slotForBlock(qint64 index) const;
+    qint64 blockToLoad() const;
+    int slotToReplace() const;
+    bool isInReadAhead(qint64 index) const;
+    qint64 readBlock(qint64 index, char *data);
+    void stop();
+
+    const std::unique_ptr<QFile> _file;
+    VideoFileAccess _fileAccess;
+    indoorcycling::ThreadRole _threadRole = indoorcycling::ThreadRole::INTERACTIVE;
+    qint64 _size = 0;
+    qint64 _position = 0;
+    const uchar *_mappedData = nullptr;
+
+    /** protects all fields below */
+    QMutex _mutex;
+    QWaitCondition _blockLoaded;
+    QWaitCondition _blockNeeded;
+    std::vector<Block> _blocks;
+    /** the first block that is read ahead. The blocks before it can be replaced by new blocks. */
+    qint64 _readAheadBlock = 0;
+    /** the slot that is being filled by the reading thread. */
+    int _loadingSlot = -1;
+    /** the block that could not be read last. It is not read ahead again until it is read explicitly. */
+    qint64 _failedBlock = -1;
+    /** number of blocks that could not be read, so a read can see that its block failed. */
+    int _failures = 0;
+    quint64 _uses = 0;
+    bool _stopped = false;
+};
+
+#endif // VIDEOFILESOURCE_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videoindex.h"
+
+#include <algorithm>
+
+VideoIndex::VideoIndex()
+{
+    // empty
+}
+
+VideoIndex::VideoIndex(std::vector<VideoIndexEntry> &&entries):
+    _entries(std::move(entries))
+{
+    std::stable_sort(_entries.begin(), _entries.end(), [](const VideoIndexEntry &first, const VideoIndexEntry &second) {
+        return first.pts() < second.pts();
+    });
+}
+
+bool VideoIndex::isEmpty() const
+{
+    return _entries.empty();
+}
+
+qint64 VideoIndex::numberOfFrames() const
+{
+    return static_cast<qint64>(_entries.size());
+}
+
+const std::vector<VideoIndexEntry> &VideoIndex::entries() const
+{
+    return _entries;
+}
+
+qint64 VideoIndex::timestampForFrame(qint64 frameNumber) const
+{
+    if (isEmpty()) {
+        return 0;
+    }
+    return _entries[boundFrameNumber(frameNumber)].pts();
+}
+
+qint64 VideoIndex::frameNumberForTimestamp(qint64 timestamp) const
+{
+    if (isEmpty()) {
+        return -1;
+    }
+    // find the first entry with a pts after the timestamp. The frame we're looking for is the one before it.
+    const auto it = std::upper_bound(_entries.begin(), _entries.end(), timestamp,
+                                     [](qint64 ts, const VideoIndexEntry &entry) {
+        return ts < entry.pts();
+    });
+    if (it == _entries.begin()) {
+        return 0;
+    }
+    return std::distance(_entries.begin(), it) - 1;
+}
+
+qint64 VideoIndex::keyFrameBefore(qint64 frameNumber) const
+{
+    if (isEmpty()) {
+        return 0;
+    }
+    for (qint64 i = boundFrameNumber(frameNumber); i > 0; --i) {
+        if (_entries[i].isKeyFrame()) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+qint64 VideoIndex::seekTimestampForFrame(qint64 frameNumber) const
+{
+    if (isEmpty()) {
+        return 0;
+    }
+    return _entries[keyFrameBefore(frameNumber)].dts();
+}
+
+qint64 VideoIndex::boundFrameNumber(qint64 frameNumber) const
+{
+    return qBound(Q_INT64_C(0), frameNumber, numberOfFrames() - 1);
+}
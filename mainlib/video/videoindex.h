@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOINDEX_H
+#define VIDEOINDEX_H
+
+#include <vector>
+#include <QtCore/QtGlobal>
+
+/**
+ * A single packet of the video stream, as found in the video file.
+ */
+class VideoIndexEntry
+{
+public:
+    explicit VideoIndexEntry(qint64 pts, qint64 dts, qint64 position, bool keyFrame):
+        _pts(pts), _dts(dts), _position(position), _keyFrame(keyFrame) {}
+
+    /** presentation timestamp, in time base units of the video stream */
+    qint64 pts() const { return _pts; }
+    /** decoding timestamp, in time base units of the video stream */
+    qint64 dts() const { return _dts; }
+    /** byte offset of the packet in the video file, or -1 if unknown */
+    qint64 position() const { return _position; }
+    bool isKeyFrame() const { return _keyFrame; }
+
+private:
+    qint64 _pts;
+    qint64 _dts;
+    qint64 _position;
+    bool _keyFrame;
+};
+
+/**
+ * Index of all frames in a video file. The entries are kept in presentation order, so the position of an
+ * entry in the index is the frame number of that frame. This makes it possible to map frame numbers to
+ * timestamps exactly, also for videos with a variable frame rate, and to find the key frame from which
+ * decoding has to start to reach a certain frame.
+ */
+class VideoIndex
+{
+public:
+    explicit VideoIndex();
+    /** Create an index from \param entries. The entries do not have to be in presentation order. */
+    explicit VideoIndex(std::vector<VideoIndexEntry> &&entries);
+
+    bool isEmpty() const;
+    qint64 numberOfFrames() const;
+    const std::vector<VideoIndexEntry> &entries() const;
+
+    /** Get the presentation timestamp of a frame. */
+    qint64 timestampForFrame(qint64 frameNumber) const;
+    /**
+     * Get the frame number for a presentation timestamp. If there is no frame with this exact timestamp,
+     * the last frame before the timestamp is returned.
+     */
+    qint64 frameNumberForTimestamp(qint64 timestamp) const;
+    /** Get the frame number of the last key frame at or before \param frameNumber. */
+    qint64 keyFrameBefore(qint64 frameNumber) const;
+    /**
+     * Get the timestamp to seek to, to be able to decode \param frameNumber. This is the decoding timestamp
+     * of the key frame before the frame.
+     */
+    qint64 seekTimestampForFrame(qint64 frameNumber) const;
+
+private:
+    qint64 boundFrameNumber(qint64 frameNumber) const;
+
+    std::vector<VideoIndexEntry> _entries;
+};
+
+#endif // VIDEOINDEX_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videoindexer.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtDebug>
+
+#include "config/bigringsettings.h"
+#include "util/threadrole.h"
+
+namespace
+{
+/** the video files that are waiting to be indexed, shared by all readers. */
+struct IndexingQueue
+{
+    IndexingQueue()
+    {
+        // reading a whole file is mostly waiting for the disk, reading several at the same time does not help.
+        threadPool.setMaxThreadCount(1);
+    }
+
+    ~IndexingQueue()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        stopping = true;
+        threadPool.clear();
+        threadPool.waitForDone();
+    }
+
+    QThreadPool threadPool;
+    QMutex mutex;
+    QSet<QString> queuedFilenames;
+    std::atomic<bool> stopping { false };
+};
+
+IndexingQueue &indexingQueue()
+{
+    static IndexingQueue queue;
+    return queue;
+}
+}
+
+VideoIndexer::VideoIndexer(QObject *parent) :
+    GenericVideoReader(parent)
+{
+    // empty
+}
+
+VideoIndexer::~VideoIndexer()
+{
+    // empty
+}
+
+void VideoIndexer::enqueue(const QString &videoFilename)
+{
+    IndexingQueue &queue = indexingQueue();
+    {
+        QMutexLocker locker(&queue.mutex);
+        if (queue.stopping || queue.queuedFilenames.contains(videoFilename)) {
+            return;
+        }
+        queue.queuedFilenames.insert(videoFilename);
+    }
+    qDebug() << "queueing building the index of" << videoFilename;
+    QtConcurrent::run(&queue.threadPool, [&queue, videoFilename]() {
+        // the pool is our own, so the role stays with its thread.
+        indoorcycling::applyThreadRole(indoorcycling::ThreadRole::BACKGROUND);
+        if (!queue.stopping) {
+            VideoIndexer indexer;
+            indexer.buildIndex(videoFilename, &queue.stopping);
+        }
+        QMutexLocker locker(&queue.mutex);
+        queue.queuedFilenames.remove(videoFilename);
+    });
+}
+
+void VideoIndexer::stopAll()
+{
+    indexingQueue().stop();
+}
+
+void VideoIndexer::buildIndex(const QString &videoFilename, const std::atomic<bool> *cancelled)
+{
+    setFileAccess(BigRingSettings().videoFileAccess());
+    setThreadRole(indoorcycling::ThreadRole::BACKGROUND);
+    openVideoFileInternal(videoFilename);
+    if (codecContext()) {
+        loadVideoIndex(true, cancelled);
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOINDEXER_H
+#define VIDEOINDEXER_H
+
+#include <atomic>
+
+#include "genericvideoreader.h"
+
+/**
+ * Builds the frame indexes of video files in the background, one file at a time, and saves them in the
+ * VideoIndexCache. Reading a whole video file takes a while, so a video that is played before its index is built is
+ * played with frame numbers estimated from its frame rate. The index is used from the next time the video is opened.
+ */
+class VideoIndexer : public GenericVideoReader
+{
+    Q_OBJECT
+public:
+    explicit VideoIndexer(QObject *parent = 0);
+    virtual ~VideoIndexer();
+
+    /** Queue building the index of \param videoFilename. Nothing is done if it is queued already. */
+    static void enqueue(const QString &videoFilename);
+    /** Stop building indexes, and wait for the index that is being built to stop. Call this before exiting. */
+    static void stopAll();
+
+private:
+    /** Build the index of \param videoFilename and save it, unless it is in the cache already. */
+    void buildIndex(const QString &videoFilename, const std::atomic<bool> *cancelled);
+};
+
+#endif // VIDEOINDEXER_H
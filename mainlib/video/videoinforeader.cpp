@@ -1,7 +1,9 @@
 #include "videoinforeader.h"
 
 extern "C" {
+#include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
+#include "libavutil/pixdesc.h"
 }
 VideoInfoReader::VideoInfoReader(QObject *parent) :
     GenericVideoReader(parent)
@@ -14,10 +16,34 @@ VideoInfoReader::~VideoInfoReader()
     // noop
 }
 
-VideoInfo VideoInfoReader::videoInfoForVideo(const QFileInfo &videoFileInfo)
+/**
+ * The number of frames is taken from the cached frame index if there is one, as that is exact. Otherwise, the number
+ * of frames in the container is used, or it is estimated from the duration, as the frame index is only built when a
+ * video is played. For a video of several video files, the frames of all files are counted.
+ */
+VideoInformation VideoInfoReader::probe(const VideoInformation &videoInformation)
 {
-    openVideoFileInternal(videoFileInfo.filePath());
+    const QFileInfo videoFileInfo(videoInformation.videoFilename());
+    if (!videoFileInfo.exists()) {
+        return videoInformation;
+    }
+    openVideoFileInternal(videoInformation.videoFilenames());
+    loadVideoIndex(false);
     const AVStream* stream = videoStream();
-    VideoInfo videoInfo = { static_cast<float>(av_q2d(stream->avg_frame_rate)) };
-    return videoInfo;
+    if (!stream || !codecContext()) {
+        return videoInformation;
+    }
+
+    VideoInformation probed = videoInformation;
+    if (probed.frameRate() <= 0) {
+        probed = VideoInformation(videoInformation.videoFilenames(),
+                                  static_cast<float>(av_q2d(stream->avg_frame_rate)));
+    }
+    const qint64 numberOfFrames = (hasVideoIndex() || numberOfSegments() > 1 || stream->nb_frames <= 0) ?
+                totalNumberOfFrames() : static_cast<qint64>(stream->nb_frames);
+    const char *pixelFormatName = av_get_pix_fmt_name(codecContext()->pix_fmt);
+    probed.setProbedMetadata(numberOfFrames, QSize(codecContext()->width, codecContext()->height),
+                             QString(pixelFormatName ? pixelFormatName : ""), videoFileInfo.size(),
+                             videoFileInfo.lastModified());
+    return probed;
 }
@@ -3,11 +3,10 @@
 
 #include <QFileInfo>
 
-struct VideoInfo {
-    float frameRate;
-};
-
 #include "genericvideoreader.h"
+#include "model/videoinformation.h"
+
+/** Reads the metadata of video files, without decoding them. */
 class VideoInfoReader : public GenericVideoReader
 {
     Q_OBJECT
@@ -15,7 +14,12 @@ public:
     explicit VideoInfoReader(QObject *parent = 0);
     virtual ~VideoInfoReader();
 
-    VideoInfo videoInfoForVideo(const QFileInfo &videoFileInfo);
+    /**
+     * Probe the video file of \param videoInformation for its number of frames, frame size and pixel format. The
+     * frame rate is taken from the video file if it is not known yet.
+     * @return \param videoInformation with the probed metadata, or unchanged if the video file does not exist.
+     */
+    VideoInformation probe(const VideoInformation &videoInformation);
 signals:
 
 public slots:
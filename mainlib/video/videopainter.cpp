@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videopainter.h"
+
+#include <cstring>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtDebug>
+
+namespace
+{
+const qint64 DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+}
+
+VideoPainter::VideoPainter(QObject *parent) :
+    QObject(parent), _pipelineTimings(std::make_shared<PipelineTimings>()), _memoryBudget(DEFAULT_MEMORY_BUDGET)
+{
+    // empty
+}
+
+void VideoPainter::setFrameBufferMemoryBudget(qint64 memoryBudget)
+{
+    _memoryBudget = memoryBudget;
+}
+
+void VideoPainter::setShownEntriesPerSecond(qreal shownEntriesPerSecond)
+{
+    _shownEntriesPerSecond = shownEntriesPerSecond;
+}
+
+void VideoPainter::setFrameRequest(int skipFrames, bool blendFrames)
+{
+    _skipFrames = skipFrames;
+    _blendFrames = blendFrames;
+}
+
+void VideoPainter::setReadAheadFrames(int readAheadFrames)
+{
+    _readAheadFrames = readAheadFrames;
+}
+
+void VideoPainter::setRefillFrames(int refillFrames)
+{
+    _refillFrames = refillFrames;
+}
+
+void VideoPainter::setPipelineTimings(const std::shared_ptr<PipelineTimings> &pipelineTimings)
+{
+    _pipelineTimings = pipelineTimings;
+}
+
+std::shared_ptr<FrameSlotRing> VideoPainter::frameSlots() const
+{
+    return _frameSlots;
+}
+
+void VideoPainter::loadFilledFrames()
+{
+    if (!_frameSlots) {
+        return;
+    }
+    while (_frameSlots->hasFilledSlot()) {
+        const FrameSlot &slot = _frameSlots->filledSlot();
+        const qint64 frameNumber = (_frameSlots->filledSlotCancelled()) ? -1 : slot.frameNumber;
+        setFrameLoaded(_frameSlots->filledSlotIndex(), frameNumber);
+        if (frameNumber >= 0) {
+            emit frameLoaded(frameNumber, slot.skipFrames, slot.decodeNanoseconds, slot.copyNanoseconds);
+        }
+        _frameSlots->retireSlot();
+    }
+}
+
+void VideoPainter::cancelFrameRequests()
+{
+    loadFilledFrames();
+    if (_frameSlots) {
+        _frameSlots->cancelRequests();
+    }
+    _frameRing.forgetFrames();
+}
+
+bool VideoPainter::adoptFrames(FrameSlotRing &frameSlots)
+{
+    if (!_frameSlots) {
+        return false;
+    }
+    // the frames after the ones that do not fit would be missing, as the reader continues after the last frame.
+    const int frameCount = frameSlots.filledSlots();
+    if (frameCount == 0 || frameCount > _frameRing.size()) {
+        return false;
+    }
+    if (frameSlots.filledSlot().frameFormat != _frameFormat) {
+        return false;
+    }
+    closeFrameSlots();
+    _frameRing.resize(_frameRing.size());
+    int adopted = 0;
+    while (frameSlots.hasFilledSlot()) {
+        const FrameSlot &slot = frameSlots.filledSlot();
+        if (!frameSlots.filledSlotCancelled() && slot.frameNumber >= 0) {
+            const int index = _frameRing.takeBufferToFill();
+            QElapsedTimer mapTimer;
+            mapTimer.start();
+            void *frameBuffer = frameBufferToFill(index);
+            _pipelineTimings->record(PipelineStage::MAP, mapTimer.nsecsElapsed());
+            if (frameBuffer) {
+                memcpy(frameBuffer, slot.data, static_cast<std::size_t>(_frameFormat.bufferSize()));
+            }
+            setFrameLoaded(index, frameBuffer ? slot.frameNumber : -1);
+            emit frameLoaded(slot.frameNumber, slot.skipFrames, slot.decodeNanoseconds, slot.copyNanoseconds);
+            ++adopted;
+        }
+        frameSlots.retireSlot();
+    }
+    // the reader continues after the adopted frames, in the buffers after them.
+    _frameSlots = std::make_shared<FrameSlotRing>(_frameRing.size(), adopted);
+    emit frameSlotsChanged(_frameSlots);
+    requestNewFrames();
+    return true;
+}
+
+FrameRingStatistics VideoPainter::frameRingStatistics() const
+{
+    return _frameRing.statistics();
+}
+
+void VideoPainter::resetFrameRingStatistics()
+{
+    _frameRing.resetStatistics();
+}
+
+FrameUploadStatistics VideoPainter::frameUploadStatistics() const
+{
+    return _frameUploadStatistics;
+}
+
+void VideoPainter::resetFrameUploadStatistics()
+{
+    _frameUploadStatistics = FrameUploadStatistics();
+}
+
+void VideoPainter::countPaint(bool uploaded, qint64 frameBytes)
+{
+    ++_frameUploadStatistics.paints;
+    if (uploaded) {
+        ++_frameUploadStatistics.uploads;
+        _frameUploadStatistics.uploadedBytes += frameBytes;
+    } else {
+        _frameUploadStatistics.savedBytes += frameBytes;
+    }
+}
+
+bool VideoPainter::showFrame(qint64 frameNumber)
+{
+    if (!_frameRing.showFrame(frameNumber)) {
+        return false;
+    }
+    requestNewFrames();
+    return true;
+}
+
+void VideoPainter::fillBuffers()
+{
+    cancelFrameRequests();
+    resizeFrameRing(_frameFormat);
+    if (!_frameSlots) {
+        return;
+    }
+    // the slots of the cancelled requests are requested again when the reader skipped them.
+    int count = _frameSlots->freeSlots();
+    if (_refillFrames >= 0 && _readAheadFrames > 0) {
+        count = qMin(count, _readAheadFrames);
+    }
+    requestFrames(count);
+}
+
+void VideoPainter::resizeFrameRing(const FrameFormat &frameFormat)
+{
+    if (!frameFormat.isValid()) {
+        return;
+    }
+    const int currentSize = (_frameSlots && frameFormat == _frameFormat) ? _frameRing.size() : 0;
+    const int size = FrameRing::sizeFor(_memoryBudget, frameFormat.bufferSize(), _shownEntriesPerSecond, currentSize);
+    if (frameFormat != _frameFormat || size != _frameRing.size() || !_frameSlots) {
+        qDebug() << "using" << size << pixelFormatName(frameFormat.pixelFormat()) << "frame buffers of"
+                 << frameFormat.frameSize() << "for showing" << _shownEntriesPerSecond << "frames per second";
+        closeFrameSlots();
+        _frameFormat = frameFormat;
+        resizeBuffers(size, frameFormat);
+        _frameRing.resize(size);
+        _frameSlots = std::make_shared<FrameSlotRing>(size);
+        emit frameSlotsChanged(_frameSlots);
+    }
+}
+
+void VideoPainter::closeFrameSlots()
+{
+    if (_frameSlots) {
+        _frameSlots->close();
+    }
+}
+
+void VideoPainter::requestNewFrames()
+{
+    if (!_frameSlots) {
+        return;
+    }
+    int count = qMin(_frameRing.buffersToFill(), _frameSlots->freeSlots());
+    if (_readAheadFrames > 0) {
+        // the buffers that are not to be filled hold the shown frame and the frames that are loaded or requested.
+        const int framesAhead = _frameRing.size() - 1 - _frameRing.buffersToFill();
+        if (_refillFrames >= 0 && framesAhead > _refillFrames) {
+            return;
+        }
+        count = qMin(count, qMax(0, _readAheadFrames - framesAhead));
+    }
+    requestFrames(count);
+}
+
+void VideoPainter::requestFrames(int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const int index = _frameRing.takeBufferToFill();
+        Q_ASSERT(index == (_frameSlots->nextSlotToRequest() + i) % _frameRing.size());
+        QElapsedTimer mapTimer;
+        mapTimer.start();
+        void *frameBuffer = frameBufferToFill(index);
+        _pipelineTimings->record(PipelineStage::MAP, mapTimer.nsecsElapsed());
+        _frameSlots->prepareRequest(i, frameBuffer, _frameFormat, _skipFrames, _blendFrames);
+    }
+    if (_frameSlots->requestFrames(count)) {
+        emit framesNeeded();
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOPAINTER_H
+#define VIDEOPAINTER_H
+
+#include <memory>
+#include <QtCore/QObject>
+#include <QtCore/QRectF>
+#include <QtCore/QSize>
+
+#include "frameformat.h"
+#include "framering.h"
+#include "frameslotring.h"
+#include "pipelinetimings.h"
+
+class QPainter;
+
+/** Counters for how often a painter painted a frame and how often it had to upload a new frame for that. */
+struct FrameUploadStatistics
+{
+    /** number of times the video was painted */
+    int paints = 0;
+    /** number of times a new frame was uploaded or converted for painting */
+    int uploads = 0;
+    /** number of bytes of frame buffers that were uploaded */
+    qint64 uploadedBytes = 0;
+    /** number of bytes that were not uploaded, because the frame painted was uploaded already */
+    qint64 savedBytes = 0;
+};
+
+/**
+ * Paints the frames of a video. A VideoPainter owns a ring of frame buffers. It requests frames for the buffers
+ * through a FrameSlotRing, which the video reader fills. The frames the reader filled are taken from the FrameSlotRing
+ * with loadFilledFrames().
+ *
+ * The number of buffers in the ring depends on the frame size, the memory budget and how fast the frames are shown.
+ * The ring is only resized when the frame format is set and by fillBuffers(), which is called after a seek, as the
+ * loaded frames are not needed then. Small changes of the speed keep the current size, see FrameRing::sizeFor().
+ */
+class VideoPainter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VideoPainter(QObject *parent = 0);
+    virtual ~VideoPainter() {}
+
+    /** paint the current frame */
+    virtual void paint(QPainter* painter, const QRectF& rect, Qt::AspectRatioMode aspectRatioMode) = 0;
+
+    /** Set the maximum number of bytes used for frame buffers. */
+    void setFrameBufferMemoryBudget(qint64 memoryBudget);
+    /**
+     * Set the number of entries of the ring that are expected to be shown per second, see FrameRing::sizeFor(). 0
+     * means it is not known.
+     */
+    void setShownEntriesPerSecond(qreal shownEntriesPerSecond);
+    /**
+     * Set the request for the frames that are requested from now on.
+     * @param skipFrames number of frames the reader should skip before loading a frame.
+     * @param blendFrames whether the reader may blend frames, see FrameCopyingVideoReader::setFrameBlending.
+     */
+    void setFrameRequest(int skipFrames, bool blendFrames);
+    /**
+     * Set the number of frames that are requested ahead of the shown frame. With fewer frames requested ahead, a new
+     * frame request takes effect sooner. 0, the default, requests frames for all buffers of the ring.
+     */
+    void setReadAheadFrames(int readAheadFrames);
+    /**
+     * Request frames in batches: new frames are only requested when fewer than \param refillFrames frames are ahead
+     * of the shown frame, and then up to the read ahead frames at once. fillBuffers() requests no more than the read
+     * ahead frames either. This saves energy, as the reader decodes in bursts and sleeps in between. -1, the default,
+     * requests a frame as soon as there is room for it.
+     */
+    void setRefillFrames(int refillFrames);
+    /** Set the histograms in which the time taken by mapping and uploading frames is recorded. */
+    void setPipelineTimings(const std::shared_ptr<PipelineTimings> &pipelineTimings);
+
+    /** The ring through which frames are requested from the reader. This changes when the ring is resized. */
+    std::shared_ptr<FrameSlotRing> frameSlots() const;
+    /**
+     * Take the frames the reader loaded since the last call, so they can be shown. frameLoaded is emitted for every
+     * frame.
+     */
+    void loadFilledFrames();
+    /**
+     * Cancel the frames that were requested up to now, for instance because the reader seeks to another position.
+     * The reader skips the requests it did not start on, and frames that were loaded already are not shown.
+     */
+    void cancelFrameRequests();
+    /**
+     * Take over the frames another reader loaded through \param frameSlots, for instance the frames a VideoPreparer
+     * decoded before the video was played. The frames are copied into the buffers, in the order they were loaded, and
+     * the frames after them are requested through a new ring, which frameSlotsChanged is emitted with. frameSlots
+     * should be closed, so its reader does not load more frames after them.
+     * @return false if the frames were not taken over, because they do not fit in the buffers or have another frame
+     * format.
+     */
+    bool adoptFrames(FrameSlotRing &frameSlots);
+
+    /** Get the counters for how full the ring of frame buffers is. */
+    FrameRingStatistics frameRingStatistics() const;
+    void resetFrameRingStatistics();
+    /** Get the counters for how many paints needed a new frame to be uploaded. */
+    FrameUploadStatistics frameUploadStatistics() const;
+    void resetFrameUploadStatistics();
+signals:
+    /** Emitted when frames are requested while the reader was waiting for requests. */
+    void framesNeeded();
+    /** Emitted when the frame buffers were replaced, with the ring through which new frames are requested. */
+    void frameSlotsChanged(const std::shared_ptr<FrameSlotRing> &frameSlots);
+    /**
+     * Emitted from loadFilledFrames() for every frame that is loaded, with the number of frames skipped before it and
+     * the times of the FrameSlot.
+     */
+    void frameLoaded(qint64 frameNumber, int skipFrames, qint64 decodeNanoseconds, qint64 copyNanoseconds);
+public slots:
+    /**
+     * Set the video size.
+     * @param videoSize the destination size, in which the video should be presented.
+     * @param frameFormat the layout of the frames, coming from the video file.
+     */
+    virtual void setVideoSize(const QSize& videoSize, const FrameFormat &frameFormat) = 0;
+    /**
+     * Prepare a frame for painting.
+     * @param frameNumber frame number of the frame that should be shown later.
+     * @return true if a new frame was prepared. False if no new frame has to be shown
+     */
+    bool showFrame(qint64 frameNumber);
+    /**
+     * Make the painter fill it's buffers. This cancels the frames that were requested before, so the reader can start
+     * on the new requests right away.
+     */
+    void fillBuffers();
+
+protected:
+    /**
+     * Resize the ring of frame buffers, if \param frameFormat, the memory budget or the speed at which frames are
+     * shown call for other buffers.
+     */
+    void resizeFrameRing(const FrameFormat &frameFormat);
+    /** Make sure the reader does not write to the frame buffers anymore. Call this before freeing them. */
+    void closeFrameSlots();
+    /** Make the buffer at \param index available for a new frame, and return the memory to load the frame into. */
+    virtual void *frameBufferToFill(int index) = 0;
+    /**
+     * Signal to the painter that a frame is loaded.
+     * @param index index of the buffer the frame was loaded into.
+     * @param frameNumber number of the frame, from the video file, or -1 if no frame could be loaded.
+     */
+    virtual void setFrameLoaded(int index, qint64 frameNumber) = 0;
+    /** Replace the buffers by \param size buffers for frames of \param frameFormat. */
+    virtual void resizeBuffers(int size, const FrameFormat &frameFormat) = 0;
+    /**
+     * Count a paint of the video.
+     * @param uploaded whether a new frame was uploaded for this paint.
+     * @param frameBytes the size of the frame that was, or would have been, uploaded.
+     */
+    void countPaint(bool uploaded, qint64 frameBytes);
+
+    FrameRing _frameRing;
+    std::shared_ptr<PipelineTimings> _pipelineTimings;
+
+private:
+    /** Request new frames to make sure the buffer is as full as possible. */
+    void requestNewFrames();
+    /** Request frames for the next \param count buffers of the ring, in one batch. */
+    void requestFrames(int count);
+
+    std::shared_ptr<FrameSlotRing> _frameSlots;
+    qint64 _memoryBudget;
+    FrameUploadStatistics _frameUploadStatistics;
+    qreal _shownEntriesPerSecond = 0;
+    FrameFormat _frameFormat;
+    int _skipFrames = 0;
+    bool _blendFrames = false;
+    int _readAheadFrames = 0;
+    int _refillFrames = -1;
+};
+
+#endif // VIDEOPAINTER_H
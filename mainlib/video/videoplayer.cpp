@@ -21,42 +21,92 @@
 #include "videoplayer.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
 #include <QtCore/QEvent>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QtDebug>
 #include <QtCore/QThread>
+#include <QtCore/QtMath>
+#include <QtCore/QTextStream>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QDesktopWidget>
 
-#include "framebuffer.h"
+#include "config/bigringsettings.h"
 #include "framecopyingvideoreader.h"
 #include "openglpainter2.h"
+#include "softwarepainter.h"
+#include "util/threadrole.h"
+#include "videopreparer.h"
 
 namespace {
 const quint32 MAX_STEP_SIZE = 5u;
+/** number of frames synthesized for every frame of the video, when frame blending is enabled */
+const int FRAME_BLENDING_SUB_FRAMES = 4;
+/** interval in which the frame ring is checked while it fills after a seek */
+const int PRELOAD_CHECK_INTERVAL_MILLISECONDS = 50;
+/**
+ * If no frame is decoded for this long during the preload, playing is started anyway. This happens near the end of a
+ * video, where there are not enough frames left to fill the ring.
+ */
+const qint64 PRELOAD_STALL_MILLISECONDS = 2000;
+/** interval in which the pipeline timings are written to the timings file */
+const int TIMINGS_WRITE_INTERVAL_SECONDS = 10;
+const qreal BYTES_PER_MEGABYTE = 1024 * 1024;
+
+/** The size in pixels of the screen \param widget is shown on. */
+QSize displaySize(const QWidget *widget)
+{
+    return QApplication::desktop()->screenGeometry(widget).size() * widget->devicePixelRatio();
+}
 }
 
-VideoPlayer::VideoPlayer(QGLWidget *paintWidget, QObject *parent) :
-    QObject(parent), _videoReader(new FrameCopyingVideoReader), _videoReaderThread(new QThread), _frameRateTimer(new QTimer(this))
+VideoPlayer::VideoPlayer(QWidget *paintWidget, QObject *parent) :
+    QObject(parent), _readAheadController(static_cast<int>(MAX_STEP_SIZE)),
+    _pipelineTimings(std::make_shared<PipelineTimings>()), _frameRateTimer(new QTimer(this)),
+    _preloadTimer(new QTimer(this))
 {
-    _painter = new OpenGLPainter2(paintWidget, this);
+    QGLWidget *glWidget = qobject_cast<QGLWidget*>(paintWidget);
+    if (glWidget) {
+        _painter = new OpenGLPainter2(glWidget, this);
+    } else {
+        _painter = new SoftwarePainter(this);
+    }
 
-    _videoReader->moveToThread(_videoReaderThread);
-    connect(_videoReaderThread, &QThread::finished, _videoReaderThread, &QThread::deleteLater);
-    connect(_videoReaderThread, &QThread::finished, _videoReader, &FrameCopyingVideoReader::deleteLater);
-    _videoReaderThread->start();
+    const BigRingSettings settings;
+    _subFramesPerFrame = frameBlendingSubFrames();
+    if (settings.videoPlaybackQuality() == VideoPlaybackQuality::DISPLAY) {
+        _maximumFrameSize = displaySize(paintWidget);
+    }
+    _painter->setFrameBufferMemoryBudget(static_cast<qint64>(settings.videoFrameBufferMemory()) * 1024 * 1024);
+    _painter->setPipelineTimings(_pipelineTimings);
+    _preloadSeconds = settings.videoPreloadSeconds();
+    _energySaving = settings.videoEnergySaving();
+    if (_energySaving) {
+        // request frames in batches from the start, the batch size follows the read ahead once the ride moves.
+        _painter->setRefillFrames(0);
+    }
+    _speedTimer.start();
+    _videoReader = startVideoReader(_maximumFrameSize, _subFramesPerFrame, _pipelineTimings);
 
     _frameRateTimer->setInterval(1000);
     connect(_frameRateTimer, &QTimer::timeout, this, &VideoPlayer::determineFrameRate);
     _frameRateTimer->start();
 
+    _preloadTimer->setInterval(PRELOAD_CHECK_INTERVAL_MILLISECONDS);
+    connect(_preloadTimer, &QTimer::timeout, this, &VideoPlayer::checkPreload);
+
     connect(_videoReader, &FrameCopyingVideoReader::videoOpened, this, &VideoPlayer::setVideoOpened);
     connect(_videoReader, &FrameCopyingVideoReader::seekReady, this, &VideoPlayer::setSeekReady);
-    connect(_videoReader, &FrameCopyingVideoReader::frameCopied, this, &VideoPlayer::setFrameLoaded);
-    connect(_painter, &OpenGLPainter2::frameNeeded, this, &VideoPlayer::setFrameNeeded);
+    connect(_painter, &VideoPainter::frameSlotsChanged, this, &VideoPlayer::setFrameSlots);
+    connect(_painter, &VideoPainter::framesNeeded, this, &VideoPlayer::setFramesNeeded);
+    connect(_painter, &VideoPainter::frameLoaded, this, &VideoPlayer::setFrameLoaded);
 
 }
 
 VideoPlayer::~VideoPlayer()
 {
-    _videoReaderThread->quit();
+    _videoReader->thread()->quit();
 }
 
 bool VideoPlayer::isReadyToPlay()
@@ -64,6 +114,11 @@ bool VideoPlayer::isReadyToPlay()
     return _loadState == LoadState::DONE;
 }
 
+void VideoPlayer::setVideoPreparer(VideoPreparer *videoPreparer)
+{
+    _videoPreparer = videoPreparer;
+}
+
 void VideoPlayer::stop()
 {
     // noop
@@ -71,17 +126,36 @@ void VideoPlayer::stop()
 
 void VideoPlayer::stepToFrame(quint32 frameNumber)
 {
+    stepToFramePosition(frameNumber);
+}
+
+void VideoPlayer::stepToFramePosition(qreal framePosition)
+{
+    const quint32 frameNumber = static_cast<quint32>(qMax(qreal(0), framePosition));
+    if (_energySaving && _loadState == LoadState::DONE && framePosition == _shownFramePosition) {
+        // the cyclist stands still or the ride is paused, so the frame on screen does not have to be painted again.
+        return;
+    }
     if (_loadState == LoadState::DONE) {
+        _painter->loadFilledFrames();
         if (frameNumber > _lastFrameLoaded) {
             qWarning("Requesting to show a frame (%ud) that is not loaded yet. last = %lld!. Step size %d", frameNumber, _lastFrameLoaded, _stepSize);
             _stepSize = MAX_STEP_SIZE;
+            _painter->setFrameRequest(_stepSize - 1, false);
             _painter->fillBuffers();
             return;
         } else {
             if (frameNumber - _currentFrameNumber > MAX_STEP_SIZE) {
                 _stepSize = MAX_STEP_SIZE;
             } else {
-                _stepSize = 1;
+                // skip frames before the decoder falls behind, if the cyclist is about to go faster than it can decode.
+                _stepSize = static_cast<quint32>(_readAheadController.stepSize());
+                // the predicted frames are the least that should be decoded ahead. With fewer, the decoder is
+                // falling behind, so skip one more frame until it has caught up.
+                const qint64 framesAhead = (_lastFrameLoaded - frameNumber) / qMax(_stepSize, 1u);
+                if (!_energySaving && framesAhead < _readAheadController.readAheadFrames()) {
+                    _stepSize = qMin(_stepSize + 1, MAX_STEP_SIZE);
+                }
             }
             if (_stepSize == 0u) {
                 return;
@@ -90,8 +164,24 @@ void VideoPlayer::stepToFrame(quint32 frameNumber)
                 qDebug() << "step size is too big:" << _stepSize << "current frame number:" << _currentFrameNumber;
             }
         }
-        _painter->showFrame(frameNumber);
+        // only blend frames when we're showing less than a frame of the video per step, as blending needs more
+        // frames in the frame buffer.
+        _blendFrames = _subFramesPerFrame > 1 && _stepSize == 1 && framePosition - _currentFramePosition < 1.0;
+        _painter->setFrameRequest(_stepSize - 1, _blendFrames);
+        // the ring is sized to the entries that are shown, as the cyclist may slow down to where frames are blended.
+        const int entriesPerFrame = (_subFramesPerFrame > 1 && _stepSize == 1) ? _subFramesPerFrame : 1;
+        _painter->setShownEntriesPerSecond(_readAheadController.peakFramesPerSecond() * entriesPerFrame / _stepSize);
+        if (_energySaving) {
+            // decode no more than the prediction, in batches, so the decoder sleeps in between. Otherwise all buffers
+            // are filled, which gives the most room when the cyclist speeds up more than predicted.
+            const int framesPerStep = _blendFrames ? _subFramesPerFrame : 1;
+            _painter->setReadAheadFrames(_readAheadController.readAheadFrames() * framesPerStep);
+            _painter->setRefillFrames(_readAheadController.refillFrames() * framesPerStep);
+        }
+        _painter->showFrame(static_cast<qint64>(framePosition * _subFramesPerFrame));
         updateCurrentFrameNumber(frameNumber);
+        _currentFramePosition = framePosition;
+        _shownFramePosition = framePosition;
         emit updateVideo();
     } else {
         qDebug() << "stepping when video not ready. Ignoring.";
@@ -99,54 +189,114 @@ void VideoPlayer::stepToFrame(quint32 frameNumber)
 }
 
 
-void VideoPlayer::loadVideo(QString uri)
+void VideoPlayer::loadVideo(const QStringList &videoFilenames)
 {
-    _videoReader->openVideoFile(uri);
+    stopPreload();
+    _readAheadController.reset();
+    _painter->cancelFrameRequests();
+    _videoFilenames = videoFilenames;
+    _pipelineTimings->reset();
+    _pendingSeeks = 0;
+    _shownFramePosition = -1;
     _stepSize = 1;
+    _preparedVideo.reset();
+    // the prepared reader can only take over while no reader fills the frame buffers.
+    if (_videoPreparer && !_painter->frameSlots()) {
+        _preparedVideo = _videoPreparer->takePreparedVideo(videoFilenames, _maximumFrameSize, _subFramesPerFrame);
+    }
+    if (_preparedVideo) {
+        adoptPreparedReader();
+        return;
+    }
+    _videoReader->openVideoFile(videoFilenames);
     updateLoadState(LoadState::VIDEO_LOADING);
 }
 
 bool VideoPlayer::seekToFrame(quint32 frameNumber)
 {
-    if (_loadState == LoadState::VIDEO_LOADED || _loadState == LoadState::DONE) {
-        _videoReader->seekToFrame(frameNumber);
-        updateLoadState(LoadState::SEEKING);
+    if (_loadState == LoadState::NONE) {
+        return false;
+    }
+    stopPreload();
+    _readAheadController.reset();
+    if (adoptPreparedFrames(frameNumber)) {
         return true;
     }
-    return false;
+    // frames from before the seek are of no use, so the reader should not spend time on them.
+    _painter->cancelFrameRequests();
+    // while the video is still loading, the seek is queued behind the open, so it is done as soon as the video is
+    // opened.
+    _videoReader->seekToFrame(frameNumber);
+    ++_pendingSeeks;
+    if (_loadState != LoadState::VIDEO_LOADING) {
+        updateLoadState(LoadState::SEEKING);
+    }
+    return true;
+}
+
+void VideoPlayer::setSpeed(float metersPerSecond)
+{
+    _readAheadController.setSpeed(metersPerSecond, _speedTimer.elapsed());
+}
+
+void VideoPlayer::setMetersPerFrame(float metersPerFrame)
+{
+    _readAheadController.setMetersPerFrame(metersPerFrame);
+}
+
+void VideoPlayer::setTimingsFilename(const QString &filename)
+{
+    _timingsFilename = filename;
 }
 
 void VideoPlayer::displayCurrentFrame(QPainter *painter, QRectF rect, Qt::AspectRatioMode aspectRatioMode)
 {
+    _painter->loadFilledFrames();
+    QElapsedTimer paintTimer;
+    paintTimer.start();
     _painter->paint(painter, rect, aspectRatioMode);
+    _pipelineTimings->record(PipelineStage::PAINT, paintTimer.nsecsElapsed());
 }
 
-void VideoPlayer::setVideoOpened(const QString &, const QSize& videoSize, const QSize &videoFrameSize, const qint64 numberOfFrames)
+void VideoPlayer::setVideoOpened(const QString &, const QSize& videoSize, const FrameFormat &frameFormat,
+                                 const qint64 numberOfFrames, const qreal frameRate)
 {
-    _painter->setVideoSize(videoSize, videoFrameSize);
-    updateLoadState(LoadState::VIDEO_LOADED);
+    _videoFrameRate = frameRate;
+    _painter->setVideoSize(videoSize, frameFormat);
+    if (_loadState == LoadState::VIDEO_LOADING) {
+        updateLoadState(LoadState::VIDEO_LOADED);
+    }
     emit videoLoaded(numberOfFrames);
 }
 
 void VideoPlayer::setSeekReady(qint64 frameNumber)
 {
-    _currentFrameNumber = frameNumber;
-    updateLoadState(LoadState::DONE);
+    if (_pendingSeeks > 0 && --_pendingSeeks > 0) {
+        // a newer seek is on its way, so this frame will not be shown.
+        return;
+    }
+    setPreloadReadAhead();
     _painter->fillBuffers();
-    QTimer::singleShot(2000, this, [this] {
-        emit seekDone();
-    });
+    startPreload(frameNumber);
+}
+
+void VideoPlayer::setFrameSlots(const std::shared_ptr<FrameSlotRing> &frameSlots)
+{
+    _videoReader->setFrameSlots(frameSlots);
 }
 
-void VideoPlayer::setFrameLoaded(int index, qint64 frameNumber, const QSize &frameSize)
+void VideoPlayer::setFramesNeeded()
 {
-    _lastFrameLoaded = frameNumber;
-    _painter->setFrameLoaded(index, frameNumber, frameSize);
+    _videoReader->readFrames();
 }
 
-void VideoPlayer::setFrameNeeded(const std::weak_ptr<FrameBuffer> &frameBuffer)
+void VideoPlayer::setFrameLoaded(qint64 frameNumber, int skipFrames, qint64 decodeNanoseconds,
+                                 qint64 copyNanoseconds)
 {
-    _videoReader->copyNextFrame(frameBuffer, _stepSize - 1);
+    // with frame blending, frameNumber is the number of a sub frame.
+    _lastFrameLoaded = frameNumber / _subFramesPerFrame;
+
+    _readAheadController.addDecodedFrame(skipFrames, decodeNanoseconds, copyNanoseconds);
 }
 
 void VideoPlayer::determineFrameRate()
@@ -154,6 +304,176 @@ void VideoPlayer::determineFrameRate()
     int numberOfFrames = _currentFrameNumber - _lastFrameNumber;
     emit frameRateChanged(qMax(numberOfFrames, 0));
     _lastFrameNumber = _currentFrameNumber;
+
+    if (numberOfFrames > 0) {
+        const FrameRingStatistics statistics = _painter->frameRingStatistics();
+        qDebug() << "frame ring size" << statistics.size << "filled" << statistics.filled
+                 << "average" << statistics.averageFilled << "minimum" << statistics.minimumFilled
+                 << "underruns" << statistics.underruns;
+    }
+    _painter->resetFrameRingStatistics();
+
+    // paints and uploads are counted per second, so the bytes are the upload bandwidth used and saved.
+    const FrameUploadStatistics uploadStatistics = _painter->frameUploadStatistics();
+    _painter->resetFrameUploadStatistics();
+    const QString timingsSummary = _pipelineTimings->summary() +
+            QString("uploads %1 of %2 paints, %3 MB/s uploaded, %4 MB/s saved\n")
+            .arg(uploadStatistics.uploads).arg(uploadStatistics.paints)
+            .arg(uploadStatistics.uploadedBytes / BYTES_PER_MEGABYTE, 0, 'f', 1)
+            .arg(uploadStatistics.savedBytes / BYTES_PER_MEGABYTE, 0, 'f', 1);
+    emit pipelineTimingsChanged(timingsSummary);
+    if (!_timingsFilename.isEmpty() && ++_secondsSinceTimingsWritten >= TIMINGS_WRITE_INTERVAL_SECONDS) {
+        _secondsSinceTimingsWritten = 0;
+        writeTimings(timingsSummary);
+    }
+}
+
+/** Append \param timingsSummary to the timings file, so the timings of a ride can be analysed afterwards. */
+void VideoPlayer::writeTimings(const QString &timingsSummary)
+{
+    QFile timingsFile(_timingsFilename);
+    if (!timingsFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning("Unable to write video pipeline timings to %s", qPrintable(_timingsFilename));
+        return;
+    }
+    QTextStream stream(&timingsFile);
+    stream << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << QFileInfo(_videoFilenames.value(0)).fileName() << "\n"
+           << timingsSummary << "\n";
+}
+
+/**
+ * Check how many frames are decoded since the seek. seekDone is emitted when the frames for the preload time are
+ * decoded, or when the ring is full if it can not hold that many frames. Frames are counted in entries of the ring,
+ * see ringEntriesFor().
+ */
+void VideoPlayer::checkPreload()
+{
+    _painter->loadFilledFrames();
+    const FrameRingStatistics statistics = _painter->frameRingStatistics();
+    // one buffer holds the frame that is shown, so the ring never holds more than size - 1 new frames.
+    const int ringCapacity = qMax(1, statistics.size - 1);
+    const int targetFrames = (_videoFrameRate > 0) ?
+                qBound(1, ringEntriesFor(_preloadSeconds), ringCapacity) : ringCapacity;
+    const int filled = qMin(statistics.filled, targetFrames);
+
+    if (filled != _preloadFilled) {
+        _preloadFilled = filled;
+        _preloadStallTimer.restart();
+        emit preloadProgress(filled * 100 / targetFrames);
+    }
+    if (filled >= targetFrames || _preloadStallTimer.hasExpired(PRELOAD_STALL_MILLISECONDS)) {
+        qDebug() << "preloaded" << statistics.filled << "frames of" << targetFrames;
+        stopPreload();
+        emit seekDone();
+    }
+}
+
+void VideoPlayer::stopPreload()
+{
+    _preloadTimer->stop();
+}
+
+/**
+ * The number of entries of the frame ring that hold \param seconds of video, with the frames that are requested now.
+ * With frame blending, every frame of the video takes an entry per sub frame, and when frames are skipped, there is
+ * an entry for every step.
+ */
+int VideoPlayer::ringEntriesFor(qreal seconds) const
+{
+    const int entriesPerFrame = _blendFrames ? _subFramesPerFrame : 1;
+    return qCeil(seconds * _videoFrameRate * entriesPerFrame / qMax(_stepSize, 1u));
+}
+
+/** With energy saving, decode the frames of the preload, and leave the rest of the ring to the read ahead of the ride. */
+void VideoPlayer::setPreloadReadAhead()
+{
+    if (_energySaving && _videoFrameRate > 0) {
+        _painter->setReadAheadFrames(ringEntriesFor(_preloadSeconds));
+    }
+}
+
+/** Start showing the video from \param frameNumber, as soon as the frames of the preload are decoded. */
+void VideoPlayer::startPreload(qint64 frameNumber)
+{
+    _currentFrameNumber = frameNumber;
+    _currentFramePosition = frameNumber;
+    _shownFramePosition = -1;
+    updateLoadState(LoadState::DONE);
+
+    _preloadFilled = -1;
+    _preloadStallTimer.start();
+    _preloadTimer->start();
+    checkPreload();
+}
+
+/** Use the reader of the prepared video, which opened the video already, instead of opening it with our own reader. */
+void VideoPlayer::adoptPreparedReader()
+{
+    disconnect(_videoReader, nullptr, this, nullptr);
+    _videoReader->thread()->quit();
+    _videoReader = _preparedVideo->videoReader;
+    _preparedVideo->videoReader = nullptr;
+    // the prepared reader records its timings in a histogram of its own, which is counted from now on.
+    _pipelineTimings = _preparedVideo->pipelineTimings;
+    _pipelineTimings->reset();
+    _painter->setPipelineTimings(_pipelineTimings);
+    connect(_videoReader, &FrameCopyingVideoReader::videoOpened, this, &VideoPlayer::setVideoOpened);
+    connect(_videoReader, &FrameCopyingVideoReader::seekReady, this, &VideoPlayer::setSeekReady);
+
+    qDebug() << "using the prepared reader for" << _videoFilenames.value(0);
+    updateLoadState(LoadState::VIDEO_LOADING);
+    const PreparedVideo &preparedVideo = *_preparedVideo;
+    setVideoOpened(preparedVideo.videoFilename, preparedVideo.videoSize, preparedVideo.frameFormat,
+                   preparedVideo.numberOfFrames, preparedVideo.frameRate);
+}
+
+/**
+ * Take over the frames the prepared reader decoded, if it seeked to \param frameNumber. The reader continues after
+ * them, so no time is spent on seeking, and the preload is done as far as the prepared frames go.
+ * @return false if there are no prepared frames from \param frameNumber, and the reader has to seek.
+ */
+bool VideoPlayer::adoptPreparedFrames(quint32 frameNumber)
+{
+    // the prepared frames are only of use for the first seek.
+    const std::unique_ptr<PreparedVideo> preparedVideo(std::move(_preparedVideo));
+    if (!preparedVideo || !preparedVideo->frameSlots || preparedVideo->seekFrameNumber != frameNumber) {
+        return false;
+    }
+    setPreloadReadAhead();
+    if (!_painter->adoptFrames(*preparedVideo->frameSlots)) {
+        return false;
+    }
+    qDebug() << "took over the prepared frames from frame" << preparedVideo->frameNumber;
+    _pendingSeeks = 0;
+    startPreload(preparedVideo->frameNumber);
+    return true;
+}
+
+int VideoPlayer::frameBlendingSubFrames()
+{
+    return BigRingSettings().videoFrameBlending() ? FRAME_BLENDING_SUB_FRAMES : 1;
+}
+
+FrameCopyingVideoReader *VideoPlayer::startVideoReader(const QSize &maximumFrameSize, int subFramesPerFrame,
+                                                       const std::shared_ptr<PipelineTimings> &pipelineTimings)
+{
+    FrameCopyingVideoReader *videoReader = new FrameCopyingVideoReader;
+    QThread *videoReaderThread = new QThread;
+
+    const BigRingSettings settings;
+    videoReader->setDecoderThreading(settings.videoDecoderThreadCount(), settings.videoDecoderThreadType());
+    videoReader->setDirectRenderingEnabled(settings.videoDirectRendering());
+    videoReader->setSpeedAdaptiveDecodingEnabled(settings.videoSpeedAdaptiveDecoding());
+    videoReader->setFrameBlending(subFramesPerFrame);
+    videoReader->setMaximumFrameSize(maximumFrameSize);
+    videoReader->setFileAccess(settings.videoFileAccess());
+    videoReader->setPipelineTimings(pipelineTimings);
+    videoReader->setThreadRole(indoorcycling::ThreadRole::RIDE_CRITICAL);
+    videoReader->moveToThread(videoReaderThread);
+    connect(videoReaderThread, &QThread::finished, videoReaderThread, &QThread::deleteLater);
+    connect(videoReaderThread, &QThread::finished, videoReader, &FrameCopyingVideoReader::deleteLater);
+    indoorcycling::startThread(videoReaderThread, indoorcycling::ThreadRole::RIDE_CRITICAL);
+    return videoReader;
 }
 
 void VideoPlayer::updateCurrentFrameNumber(const quint32 frameNumber)
@@ -23,19 +23,29 @@
 
 #include <memory>
 #include <QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPointer>
+#include <QtCore/QStringList>
 #include <QtCore/QTimer>
-#include <QtOpenGL/QGLContext>
+#include <QtWidgets/QWidget>
 
-class FrameBuffer;
-class OpenGLPainter2;
+#include "pipelinetimings.h"
+#include "readaheadcontroller.h"
+
+class FrameFormat;
+class FrameSlotRing;
+class VideoPainter;
 class FrameCopyingVideoReader;
+struct PreparedVideo;
+class VideoPreparer;
 
 /*!
  * \brief Video player for cycling videos. This is a frame based player, so clients can seek to
  * a particular frame and choose to step to a particular frame number.
  *
- * This video player will paint the frames from a video file onto a QGLWidget. A frame is displayed
- * using the displayCurrentFrame method.
+ * This video player will paint the frames from a video file onto a widget. If the widget is a QGLWidget, the frames
+ * are painted using OpenGL, otherwise they are converted and scaled on the cpu. A frame is displayed using the
+ * displayCurrentFrame method.
  */
 class VideoPlayer : public QObject
 {
@@ -45,7 +55,7 @@ public:
      * \brief construct a VideoPlayer using the \param paintWidget as the surface to paint to. Optionally,
      * set the \param parent to help disposing this element when no longer needed.
      */
-    explicit VideoPlayer(QGLWidget *paintWidget, QObject *parent = 0);
+    explicit VideoPlayer(QWidget *paintWidget, QObject *parent = 0);
 
     /*!
      * \brief destroy the videoplayer by cleaning up all internal resources.
@@ -58,6 +68,22 @@ public:
      */
     bool isReadyToPlay();
 
+    /*!
+     * take over the video \param videoPreparer prepared, when it is the first video that is loaded. The prepared
+     * reader is used instead of opening the video, and if the first seek is to the prepared frame, the frames it
+     * decoded are shown without seeking.
+     */
+    void setVideoPreparer(VideoPreparer *videoPreparer);
+
+    /*!
+     * create a reader with the video settings, that reads on a thread of its own.
+     * \param maximumFrameSize the size the frames are reduced to, see FrameCopyingVideoReader::setMaximumFrameSize.
+     * \param subFramesPerFrame the number of sub frames for frame blending, see frameBlendingSubFrames().
+     */
+    static FrameCopyingVideoReader *startVideoReader(const QSize &maximumFrameSize, int subFramesPerFrame,
+                                                     const std::shared_ptr<PipelineTimings> &pipelineTimings);
+    /*! the number of sub frames per frame of the video with the frame blending setting, 1 without frame blending. */
+    static int frameBlendingSubFrames();
 
 signals:
     /*!
@@ -66,9 +92,15 @@ signals:
      */
     void videoLoaded(qint64 totalNumberOfFrames);
     /*!
-     * \brief seekDone is emitted when a seek action is ready.
+     * \brief seekDone is emitted when a seek action is ready and enough frames are decoded to start playing. The number
+     * of seconds of video that is decoded first is set with BigRingSettings::setVideoPreloadSeconds.
      */
     void seekDone();
+    /*!
+     * \brief preloadProgress is emitted while the frames after a seek are decoded, before seekDone.
+     * \param percentage the part of the frames that is decoded, from 0 to 100.
+     */
+    void preloadProgress(int percentage);
     /*!
      * \brief updateVideo is emitted when a new frame is ready to be shown. Clients should call displayCurrentFrame after
      * this.
@@ -80,31 +112,65 @@ signals:
      * @param frameRate the frame rate in frames per second.
      */
     void frameRateChanged(int frameRate);
+    /**
+     * emitted every second with the latencies of the stages of the video pipeline.
+     * @param summary a table with a line for every stage, see PipelineTimings::summary(), followed by a line with the
+     * number of paints and frame uploads in the last second.
+     */
+    void pipelineTimingsChanged(const QString &summary);
 
 public slots:
     /*! stop the video */
     void stop();
     /*! step to a \param frameNumber. */
     void stepToFrame(quint32 frameNumber);
+    /*!
+     * step to a \param framePosition, which may lie between two frames. With frame blending, a frame that is
+     * blended from the two neighbouring frames is shown.
+     */
+    void stepToFramePosition(qreal framePosition);
 
-    /*! set the \param uri of the video file and load it. */
-    void loadVideo(QString uri);
+    /*!
+     * set the video files of the video and load them. A video that consists of several video files is played as one
+     * video. When the video is taken over from the video preparer, it is loaded already, and videoLoaded is emitted
+     * before this returns.
+     */
+    void loadVideo(const QStringList &videoFilenames);
 
-    /*! seek to a certain frame number */
+    /*!
+     * seek to a certain frame number. A seek while the video is loading is done as soon as the video is opened, so
+     * there is no need to wait for videoLoaded.
+     */
     bool seekToFrame(quint32 frameNumber);
 
+    /*! write the latencies of the stages of the video pipeline to the file \param filename every ten seconds. */
+    void setTimingsFilename(const QString &filename);
+
+    /*!
+     * set the speed of the cyclist, in meters per second. The speed and acceleration are used to decide how many
+     * frames are skipped and decoded ahead, before the frames are needed.
+     */
+    void setSpeed(float metersPerSecond);
+    /*! set the number of meters per frame of the video at the current position. */
+    void setMetersPerFrame(float metersPerFrame);
+
     void displayCurrentFrame(QPainter* painter, QRectF rect, Qt::AspectRatioMode aspectRatioMode);
 
 private slots:
-    void setVideoOpened(const QString& videoFilename, const QSize &videoSize, const QSize& frameSize, const qint64 numberOfFrames);
+    void setVideoOpened(const QString& videoFilename, const QSize &videoSize, const FrameFormat& frameFormat,
+                        const qint64 numberOfFrames, const qreal frameRate);
 
     void setSeekReady(qint64 frameNumber);
 
-    void setFrameLoaded(int index, qint64 frameNumber, const QSize& frameSize);
+    void setFrameSlots(const std::shared_ptr<FrameSlotRing> &frameSlots);
 
-    void setFrameNeeded(const std::weak_ptr<FrameBuffer> &frameBuffer);
+    void setFramesNeeded();
+
+    void setFrameLoaded(qint64 frameNumber, int skipFrames, qint64 decodeNanoseconds, qint64 copyNanoseconds);
 
     void determineFrameRate();
+
+    void checkPreload();
 private:
     enum class LoadState
     {
@@ -113,17 +179,59 @@ private:
 
     void updateCurrentFrameNumber(const quint32 frameNumber);
     void updateLoadState(const LoadState loadState);
-
-    OpenGLPainter2* _painter;
-    FrameCopyingVideoReader * const _videoReader;
-    QThread *_videoReaderThread;
+    void stopPreload();
+    int ringEntriesFor(qreal seconds) const;
+    void setPreloadReadAhead();
+    void startPreload(qint64 frameNumber);
+    void adoptPreparedReader();
+    bool adoptPreparedFrames(quint32 frameNumber);
+    void writeTimings(const QString &timingsSummary);
+
+    VideoPainter* _painter;
+    FrameCopyingVideoReader *_videoReader;
+    QStringList _videoFilenames;
+    /** maximum size of the frames the reader decodes, or an invalid size to decode at full size. */
+    QSize _maximumFrameSize;
+    QPointer<VideoPreparer> _videoPreparer;
+    /** the video taken over from the video preparer, until the first seek takes over its frames. */
+    std::unique_ptr<PreparedVideo> _preparedVideo;
 
     LoadState _loadState = LoadState::NONE;
+    /** number of seeks sent to the reader that did not report seekReady yet. Only the last one is shown. */
+    int _pendingSeeks = 0;
     quint32 _currentFrameNumber = 0u;
+    qreal _currentFramePosition = 0;
+    /** the frame position that was shown by the last step, or -1 if it has to be shown again. */
+    qreal _shownFramePosition = -1;
     quint32 _lastFrameNumber = 0u;
     qint64 _lastFrameLoaded = 0;
     quint32 _stepSize = 1;
+    /** number of sub frames per frame. With frame blending, this is more than 1 */
+    int _subFramesPerFrame = 1;
+    /** true if blended frames should be requested, because the video is played slowly */
+    bool _blendFrames = false;
+    /**
+     * true if frames are decoded in batches, and only as far ahead as needed for the preload or the predicted ride,
+     * and steps to the frame that is shown already are ignored, so nothing is decoded or painted while standing still.
+     */
+    bool _energySaving = false;
+    ReadAheadController _readAheadController;
+    /** time base for the speeds given to the _readAheadController. */
+    QElapsedTimer _speedTimer;
+    std::shared_ptr<PipelineTimings> _pipelineTimings;
+    QString _timingsFilename;
+    int _secondsSinceTimingsWritten = 0;
     QTimer *_frameRateTimer;
+
+    /** number of seconds of video that is decoded before seekDone is emitted. */
+    qreal _preloadSeconds;
+    qreal _videoFrameRate = 0;
+    /** polls the frame ring while it fills after a seek. */
+    QTimer *_preloadTimer;
+    /** number of frames that were decoded at the last check, or -1 before the first check. */
+    int _preloadFilled = -1;
+    /** time since the last frame was decoded during the preload. */
+    QElapsedTimer _preloadStallTimer;
 };
 
 #endif // VIDEOPLAYER_H
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videopreparer.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QtDebug>
+#include <QtCore/QtMath>
+
+#include "config/bigringsettings.h"
+#include "framecopyingvideoreader.h"
+#include "framering.h"
+#include "frameslotring.h"
+#include "pipelinetimings.h"
+#include "videoplayer.h"
+
+PreparedVideo::~PreparedVideo()
+{
+    if (frameSlots) {
+        frameSlots->close();
+    }
+    if (videoReader) {
+        videoReader->thread()->quit();
+    }
+}
+
+VideoPreparer::VideoPreparer(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+VideoPreparer::~VideoPreparer()
+{
+    // empty
+}
+
+void VideoPreparer::prepare(const QStringList &videoFilenames, quint32 frameNumber, const QSize &maximumFrameSize)
+{
+    const int subFramesPerFrame = VideoPlayer::frameBlendingSubFrames();
+    if (!_preparedVideo || _preparedVideo->videoFilenames != videoFilenames ||
+            _preparedVideo->maximumFrameSize != maximumFrameSize ||
+            _preparedVideo->subFramesPerFrame != subFramesPerFrame) {
+        _preparedVideo.reset(new PreparedVideo);
+        _pendingSeeks = 0;
+        _preparedVideo->videoFilenames = videoFilenames;
+        _preparedVideo->maximumFrameSize = maximumFrameSize;
+        _preparedVideo->subFramesPerFrame = subFramesPerFrame;
+        _preparedVideo->pipelineTimings = std::make_shared<PipelineTimings>();
+        _preparedVideo->videoReader = VideoPlayer::startVideoReader(maximumFrameSize, subFramesPerFrame,
+                                                                    _preparedVideo->pipelineTimings);
+        connect(_preparedVideo->videoReader, &FrameCopyingVideoReader::videoOpened,
+                this, &VideoPreparer::setVideoOpened);
+        connect(_preparedVideo->videoReader, &FrameCopyingVideoReader::seekReady, this, &VideoPreparer::setSeekReady);
+        _preparedVideo->videoReader->openVideoFile(videoFilenames);
+    } else if (_preparedVideo->seekFrameNumber == frameNumber) {
+        return;
+    }
+    // the frames decoded from another frame are of no use anymore.
+    if (_preparedVideo->frameSlots) {
+        _preparedVideo->frameSlots->close();
+        _preparedVideo->frameSlots.reset();
+    }
+    _preparedVideo->seekFrameNumber = frameNumber;
+    _preparedVideo->frameNumber = -1;
+    // while the video is still being opened, the seek is queued behind the open.
+    _preparedVideo->videoReader->seekToFrame(frameNumber);
+    ++_pendingSeeks;
+}
+
+std::unique_ptr<PreparedVideo> VideoPreparer::takePreparedVideo(const QStringList &videoFilenames,
+                                                                const QSize &maximumFrameSize, int subFramesPerFrame)
+{
+    // the prepared video is not kept, so its buffers do not take memory during the ride.
+    std::unique_ptr<PreparedVideo> preparedVideo(std::move(_preparedVideo));
+    _pendingSeeks = 0;
+    if (!preparedVideo || !preparedVideo->opened || preparedVideo->frameNumber < 0 || !preparedVideo->frameSlots ||
+            preparedVideo->videoFilenames != videoFilenames || preparedVideo->maximumFrameSize != maximumFrameSize ||
+            preparedVideo->subFramesPerFrame != subFramesPerFrame) {
+        return nullptr;
+    }
+    // the frames decoded up to now are taken over, and the reader continues after them.
+    preparedVideo->frameSlots->close();
+    disconnect(preparedVideo->videoReader, nullptr, this, nullptr);
+    return preparedVideo;
+}
+
+void VideoPreparer::setVideoOpened(const QString &videoFilename, const QSize &videoSize,
+                                   const FrameFormat &frameFormat, const qint64 numberOfFrames, const qreal frameRate)
+{
+    if (!_preparedVideo || sender() != _preparedVideo->videoReader) {
+        // a reader of a video that is not prepared anymore.
+        return;
+    }
+    _preparedVideo->opened = true;
+    _preparedVideo->videoFilename = videoFilename;
+    _preparedVideo->videoSize = videoSize;
+    _preparedVideo->frameFormat = frameFormat;
+    _preparedVideo->numberOfFrames = numberOfFrames;
+    _preparedVideo->frameRate = frameRate;
+}
+
+void VideoPreparer::setSeekReady(qint64 frameNumber)
+{
+    if (!_preparedVideo || sender() != _preparedVideo->videoReader) {
+        return;
+    }
+    if (_pendingSeeks > 0 && --_pendingSeeks > 0) {
+        // a newer seek is on its way.
+        return;
+    }
+    _preparedVideo->frameNumber = frameNumber;
+    requestFrames();
+}
+
+/**
+ * Decode the frames of the preload into buffers of our own. No more frames are decoded than the ring of a painter
+ * holds with the memory budget, so the painter can take all of them over.
+ */
+void VideoPreparer::requestFrames()
+{
+    PreparedVideo &preparedVideo = *_preparedVideo;
+    const qint64 frameBytes = preparedVideo.frameFormat.bufferSize();
+    if (!preparedVideo.opened || frameBytes <= 0) {
+        return;
+    }
+    const BigRingSettings settings;
+    const qint64 memoryBudget = static_cast<qint64>(settings.videoFrameBufferMemory()) * 1024 * 1024;
+    const int preloadFrames = qCeil(settings.videoPreloadSeconds() * preparedVideo.frameRate);
+    const int count = qBound(1, preloadFrames, FrameRing::sizeFor(memoryBudget, frameBytes, 0));
+
+    preparedVideo.frameBuffers.assign(static_cast<std::size_t>(count),
+                                      std::vector<quint8>(static_cast<std::size_t>(frameBytes)));
+    preparedVideo.frameSlots = std::make_shared<FrameSlotRing>(count);
+    for (int i = 0; i < count; ++i) {
+        preparedVideo.frameSlots->prepareRequest(i, preparedVideo.frameBuffers[i].data(), preparedVideo.frameFormat,
+                                                 0, false);
+    }
+    preparedVideo.frameSlots->requestFrames(count);
+    // the reader starts filling the slots as soon as it gets them.
+    preparedVideo.videoReader->setFrameSlots(preparedVideo.frameSlots);
+    qDebug() << "preparing" << count << "frames from frame" << preparedVideo.frameNumber;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOPREPARER_H
+#define VIDEOPREPARER_H
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+
+#include "frameformat.h"
+
+class FrameCopyingVideoReader;
+class FrameSlotRing;
+class PipelineTimings;
+
+/**
+ * A video a VideoPreparer opened, and the frames it decoded from the frame it seeked to. VideoPlayer takes it over
+ * when it plays the same video, see VideoPlayer::setVideoPreparer.
+ */
+struct PreparedVideo
+{
+    /** Stop the reader from filling the frame slots, and stop the reader if it was not taken over. */
+    ~PreparedVideo();
+
+    FrameCopyingVideoReader *videoReader = nullptr;
+    std::shared_ptr<PipelineTimings> pipelineTimings;
+    QStringList videoFilenames;
+    QSize maximumFrameSize;
+    int subFramesPerFrame = 1;
+
+    /** the arguments of FrameCopyingVideoReader::videoOpened, valid when opened is true. */
+    bool opened = false;
+    QString videoFilename;
+    QSize videoSize;
+    FrameFormat frameFormat;
+    qint64 numberOfFrames = 0;
+    qreal frameRate = 0;
+
+    /** the frame that was seeked to, and the frame the reader reported after the seek, or -1 while seeking. */
+    qint64 seekFrameNumber = -1;
+    qint64 frameNumber = -1;
+    /** the ring the frames from frameNumber are decoded through, into frameBuffers. */
+    std::shared_ptr<FrameSlotRing> frameSlots;
+    std::vector<std::vector<quint8>> frameBuffers;
+};
+
+/**
+ * Prepares playing a video from a frame, for instance from the start of the course that is highlighted in the list
+ * of videos. A FrameCopyingVideoReader of its own opens the video, seeks to the frame and decodes the frames of the
+ * preload, see BigRingSettings::videoPreloadSeconds, into buffers of its own. When a ride of the course is started,
+ * VideoPlayer takes over the reader and the decoded frames, so the ride starts without opening the video, seeking or
+ * waiting for the preload.
+ */
+class VideoPreparer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VideoPreparer(QObject *parent = 0);
+    virtual ~VideoPreparer();
+
+    /**
+     * Prepare playing \param videoFilenames from \param frameNumber. A video that was prepared before is kept open if
+     * it is the same video.
+     * @param maximumFrameSize the size frames are reduced to, see FrameCopyingVideoReader::setMaximumFrameSize.
+     */
+    void prepare(const QStringList &videoFilenames, quint32 frameNumber, const QSize &maximumFrameSize);
+    /**
+     * Take over the prepared video, if it is \param videoFilenames, opened for frames of \param maximumFrameSize with
+     * \param subFramesPerFrame sub frames, and the seek is done. The reader stops filling the frame slots, so the
+     * frames it decoded can be taken over.
+     * @return the prepared video, or nullptr if there is no prepared video that fits.
+     */
+    std::unique_ptr<PreparedVideo> takePreparedVideo(const QStringList &videoFilenames, const QSize &maximumFrameSize,
+                                                     int subFramesPerFrame);
+
+private slots:
+    void setVideoOpened(const QString &videoFilename, const QSize &videoSize, const FrameFormat &frameFormat,
+                        const qint64 numberOfFrames, const qreal frameRate);
+    void setSeekReady(qint64 frameNumber);
+
+private:
+    void requestFrames();
+
+    std::unique_ptr<PreparedVideo> _preparedVideo;
+    /** number of seeks sent to the reader that did not report seekReady yet. */
+    int _pendingSeeks = 0;
+};
+
+#endif // VIDEOPREPARER_H
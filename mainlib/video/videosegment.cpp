@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videosegment.h"
+
+#include <QtCore/QtDebug>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include "demuxer.h"
+#include "videofilesource.h"
+
+VideoSegment::VideoSegment(const QString &filename, qint64 firstFrameNumber):
+    filename(filename), firstFrameNumber(firstFrameNumber)
+{
+    // empty
+}
+
+VideoSegment::~VideoSegment()
+{
+    // the demuxer reads from the format context, so stop it before closing the format context.
+    _demuxer.reset();
+    av_frame_free(&decodedFrame);
+    if (codecContext) {
+        avcodec_close(codecContext);
+    }
+    if (formatContext) {
+        avformat_close_input(&formatContext);
+    }
+    if (ioContext) {
+        av_freep(&ioContext->buffer);
+        av_freep(&ioContext);
+    }
+}
+
+Demuxer &VideoSegment::demuxer(const std::shared_ptr<PipelineTimings> &pipelineTimings)
+{
+    if (!_demuxer) {
+        _demuxer.reset(new Demuxer(formatContext, streamIndex, pipelineTimings));
+        indoorcycling::startThread(_demuxer.get(), threadRole);
+    }
+    return *_demuxer;
+}
+
+qint64 VideoSegment::numberOfFrames() const
+{
+    if (!index.isEmpty()) {
+        return index.numberOfFrames();
+    }
+    return timestampToFrameNumber(stream->duration) - firstFrameNumber;
+}
+
+qint64 VideoSegment::endFrameNumber() const
+{
+    return firstFrameNumber + numberOfFrames();
+}
+
+qint64 VideoSegment::timestampToFrameNumber(qint64 timestamp) const
+{
+    if (!index.isEmpty()) {
+        return firstFrameNumber + index.frameNumberForTimestamp(timestamp);
+    }
+    // timestamps are often rounded to the time base, such as milliseconds, so the estimate is rounded as well.
+    return firstFrameNumber + qRound64(timestamp * av_q2d(av_mul_q(stream->time_base, stream->avg_frame_rate)));
+}
+
+qint64 VideoSegment::frameNumberToTimestamp(qint64 frameNumber) const
+{
+    if (!index.isEmpty()) {
+        return index.timestampForFrame(frameNumber - firstFrameNumber);
+    }
+    return qRound64((frameNumber - firstFrameNumber) / av_q2d(av_mul_q(stream->time_base, stream->avg_frame_rate)));
+}
+
+VideoIndex VideoSegment::buildVideoIndex(const std::atomic<bool> *cancelled)
+{
+    // the demuxer should not read packets while we're reading the whole file.
+    _demuxer.reset();
+    const bool background = (threadRole == indoorcycling::ThreadRole::BACKGROUND);
+    if (background) {
+        indoorcycling::beginBackgroundWork();
+    }
+    std::vector<VideoIndexEntry> entries;
+    AVPacket packet;
+    while (av_read_frame(formatContext, &packet) >= 0) {
+        if (cancelled && *cancelled) {
+            av_packet_unref(&packet);
+            entries.clear();
+            break;
+        }
+        if (background) {
+            indoorcycling::throttleBackgroundWork();
+        }
+        if (packet.stream_index == streamIndex) {
+            const qint64 nopts = static_cast<qint64>(AV_NOPTS_VALUE);
+            const qint64 dts = (packet.dts == nopts) ? packet.pts : packet.dts;
+            const qint64 pts = (packet.pts == nopts) ? dts : packet.pts;
+            if (pts == nopts) {
+                // without timestamps, we cannot build an index that we can trust.
+                qWarning("Packet without timestamps in %s, not using an index.", formatContext->filename);
+                av_packet_unref(&packet);
+                entries.clear();
+                break;
+            }
+            entries.push_back(VideoIndexEntry(pts, dts, packet.pos, (packet.flags & AV_PKT_FLAG_KEY) != 0));
+        }
+        av_packet_unref(&packet);
+    }
+    av_seek_frame(formatContext, streamIndex, 0, AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(codecContext);
+
+    return VideoIndex(std::move(entries));
+}
+
+bool VideoSegment::decodeFirstFrame(const std::shared_ptr<PipelineTimings> &pipelineTimings)
+{
+    if (!decodedFrame) {
+        decodedFrame = av_frame_alloc();
+    }
+    int result;
+    while ((result = avcodec_receive_frame(codecContext, decodedFrame)) == AVERROR(EAGAIN)) {
+        AVPacket* packet = demuxer(pipelineTimings).takePacket();
+        avcodec_send_packet(codecContext, packet);
+        av_packet_free(&packet);
+    }
+    if (result < 0) {
+        av_frame_free(&decodedFrame);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VIDEOSEGMENT_H
+#define VIDEOSEGMENT_H
+
+#include <atomic>
+#include <memory>
+#include <QtCore/QString>
+
+#include "pipelinetimings.h"
+#include "util/threadrole.h"
+#include "videoindex.h"
+
+class Demuxer;
+class VideoFileSource;
+struct AVCodec;
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVIOContext;
+struct AVStream;
+
+/**
+ * A single video file of a video, with the libav contexts it is demuxed and decoded with. Most videos are a single
+ * segment, but long courses are sometimes delivered as several consecutive video files, which are played as one
+ * video. Frame numbers are those of the whole video, so the first frame of the segment has number firstFrameNumber.
+ *
+ * The segment is opened by GenericVideoReader, which fills in the contexts. Closing is done by the destructor.
+ */
+struct VideoSegment
+{
+    explicit VideoSegment(const QString &filename, qint64 firstFrameNumber);
+    ~VideoSegment();
+
+    /**
+     * Get the demuxer of the segment. The demuxing thread is started the first time a packet is needed, so the
+     * format context can be used directly to build the index after opening a file.
+     */
+    Demuxer &demuxer(const std::shared_ptr<PipelineTimings> &pipelineTimings);
+    /** the number of frames in the segment. Without an index, this is estimated from the duration. */
+    qint64 numberOfFrames() const;
+    /** number of the frame after the last frame of the segment. */
+    qint64 endFrameNumber() const;
+    qint64 timestampToFrameNumber(qint64 timestamp) const;
+    qint64 frameNumberToTimestamp(qint64 frameNumber) const;
+    /**
+     * Read all packets of the video stream, without decoding them, and put their timestamps, positions and key frame
+     * flags in an index. After reading, the video file is rewound to the start. When the segment has the background
+     * thread role, reading is throttled while a ride is active.
+     * @return the index, or an empty index if there are packets without timestamps, or \param cancelled was set.
+     */
+    VideoIndex buildVideoIndex(const std::atomic<bool> *cancelled = nullptr);
+    /**
+     * Decode the first frame of the segment into decodedFrame, so playback can continue with it as soon as the
+     * previous segment ends.
+     */
+    bool decodeFirstFrame(const std::shared_ptr<PipelineTimings> &pipelineTimings);
+
+    const QString filename;
+    const qint64 firstFrameNumber;
+    /** the role of the demuxing and read ahead threads of the segment. */
+    indoorcycling::ThreadRole threadRole = indoorcycling::ThreadRole::INTERACTIVE;
+
+    AVCodec* codec = nullptr;
+    AVCodecContext* codecContext = nullptr;
+    AVFormatContext* formatContext = nullptr;
+    /** the I/O context through which libav reads from fileSource, if libav does not read the file itself. */
+    AVIOContext* ioContext = nullptr;
+    std::unique_ptr<VideoFileSource> fileSource;
+    int streamIndex = -1;
+    AVStream* stream = nullptr;
+    VideoIndex index;
+    /** frame decoded by decodeFirstFrame, which was not handed out yet, or nullptr. */
+    AVFrame* decodedFrame = nullptr;
+
+private:
+    std::unique_ptr<Demuxer> _demuxer;
+};
+
+#endif // VIDEOSEGMENT_H
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "yuvtorgbconverter.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef BIGRING_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using indoorcycling::InstructionSet;
+
+namespace
+{
+/*
+ * BT.601 coefficients, multiplied by 256:
+ * R = 1.164 * (Y - 16) + 1.596 * (V - 128)
+ * G = 1.164 * (Y - 16) - 0.391 * (U - 128) - 0.813 * (V - 128)
+ * B = 1.164 * (Y - 16) + 2.018 * (U - 128)
+ */
+const int Y_COEFFICIENT = 298;
+const int R_V_COEFFICIENT = 409;
+const int G_U_COEFFICIENT = -100;
+const int G_V_COEFFICIENT = -208;
+const int B_U_COEFFICIENT = 516;
+const int ROUNDING = 128;
+
+inline quint32 clampToByte(int value)
+{
+    return static_cast<quint32>(qBound(0, value, 255));
+}
+
+void convertRowScalar(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *rgb, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        const int luminance = Y_COEFFICIENT * (y[x] - 16);
+        const int blueDifference = u[x / 2] - 128;
+        const int redDifference = v[x / 2] - 128;
+
+        const int r = (luminance + R_V_COEFFICIENT * redDifference + ROUNDING) >> 8;
+        const int g = (luminance + G_U_COEFFICIENT * blueDifference + G_V_COEFFICIENT * redDifference + ROUNDING) >> 8;
+        const int b = (luminance + B_U_COEFFICIENT * blueDifference + ROUNDING) >> 8;
+        rgb[x] = 0xff000000u | (clampToByte(r) << 16) | (clampToByte(g) << 8) | clampToByte(b);
+    }
+}
+
+#ifdef BIGRING_X86_SIMD
+/*
+ * The SIMD kernels interleave the 16 bit luminance and color difference values, so _mm_madd_epi16 can multiply them
+ * with the coefficients and add them up in 32 bits. The rounding constant of the green component is added by pairing
+ * V - 128 with 1. The results are the same as those of the scalar version.
+ */
+__attribute__((target("sse2")))
+void convertRowSse2(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *rgb, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i maximum = _mm_set1_epi16(255);
+    const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xff00));
+    const __m128i luminanceOffset = _mm_set1_epi16(16);
+    const __m128i colorOffset = _mm_set1_epi16(128);
+    const __m128i rounding = _mm_set1_epi32(ROUNDING);
+    const __m128i redCoefficients = _mm_setr_epi16(Y_COEFFICIENT, R_V_COEFFICIENT, Y_COEFFICIENT, R_V_COEFFICIENT,
+                                                   Y_COEFFICIENT, R_V_COEFFICIENT, Y_COEFFICIENT, R_V_COEFFICIENT);
+    const __m128i greenCoefficients = _mm_setr_epi16(Y_COEFFICIENT, G_U_COEFFICIENT, Y_COEFFICIENT, G_U_COEFFICIENT,
+                                                     Y_COEFFICIENT, G_U_COEFFICIENT, Y_COEFFICIENT, G_U_COEFFICIENT);
+    const __m128i greenVCoefficients = _mm_setr_epi16(G_V_COEFFICIENT, ROUNDING, G_V_COEFFICIENT, ROUNDING,
+                                                      G_V_COEFFICIENT, ROUNDING, G_V_COEFFICIENT, ROUNDING);
+    const __m128i blueCoefficients = _mm_setr_epi16(Y_COEFFICIENT, B_U_COEFFICIENT, Y_COEFFICIENT, B_U_COEFFICIENT,
+                                                    Y_COEFFICIENT, B_U_COEFFICIENT, Y_COEFFICIENT, B_U_COEFFICIENT);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int uValues, vValues;
+        std::memcpy(&uValues, u + x / 2, sizeof(uValues));
+        std::memcpy(&vValues, v + x / 2, sizeof(vValues));
+
+        const __m128i luminance = _mm_sub_epi16(
+                    _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero), luminanceOffset);
+        // every U and V value is used for two horizontally adjacent pixels.
+        __m128i blueDifference = _mm_unpacklo_epi8(_mm_cvtsi32_si128(uValues), zero);
+        blueDifference = _mm_sub_epi16(_mm_unpacklo_epi16(blueDifference, blueDifference), colorOffset);
+        __m128i redDifference = _mm_unpacklo_epi8(_mm_cvtsi32_si128(vValues), zero);
+        redDifference = _mm_sub_epi16(_mm_unpacklo_epi16(redDifference, redDifference), colorOffset);
+
+        const __m128i yvLow = _mm_unpacklo_epi16(luminance, redDifference);
+        const __m128i yvHigh = _mm_unpackhi_epi16(luminance, redDifference);
+        const __m128i yuLow = _mm_unpacklo_epi16(luminance, blueDifference);
+        const __m128i yuHigh = _mm_unpackhi_epi16(luminance, blueDifference);
+        const __m128i v1Low = _mm_unpacklo_epi16(redDifference, one);
+        const __m128i v1High = _mm_unpackhi_epi16(redDifference, one);
+
+        __m128i r = _mm_packs_epi32(
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvLow, redCoefficients), rounding), 8),
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvHigh, redCoefficients), rounding), 8));
+        __m128i g = _mm_packs_epi32(
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLow, greenCoefficients),
+                                                 _mm_madd_epi16(v1Low, greenVCoefficients)), 8),
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHigh, greenCoefficients),
+                                                 _mm_madd_epi16(v1High, greenVCoefficients)), 8));
+        __m128i b = _mm_packs_epi32(
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLow, blueCoefficients), rounding), 8),
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHigh, blueCoefficients), rounding), 8));
+        r = _mm_min_epi16(_mm_max_epi16(r, zero), maximum);
+        g = _mm_min_epi16(_mm_max_epi16(g, zero), maximum);
+        b = _mm_min_epi16(_mm_max_epi16(b, zero), maximum);
+
+        // combine into B, G, R, A bytes, which is 0xAARRGGBB in little endian.
+        const __m128i blueGreen = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+        const __m128i redAlpha = _mm_or_si128(r, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + x), _mm_unpacklo_epi16(blueGreen, redAlpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + x + 4), _mm_unpackhi_epi16(blueGreen, redAlpha));
+    }
+    convertRowScalar(y + x, u + x / 2, v + x / 2, rgb + x, width - x);
+}
+
+__attribute__((target("avx2")))
+void convertRowAvx2(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *rgb, int width)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i maximum = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xff00));
+    const __m256i luminanceOffset = _mm256_set1_epi16(16);
+    const __m256i colorOffset = _mm256_set1_epi16(128);
+    const __m256i rounding = _mm256_set1_epi32(ROUNDING);
+    const __m256i redCoefficients = _mm256_set1_epi32((R_V_COEFFICIENT << 16) | Y_COEFFICIENT);
+    const __m256i greenCoefficients = _mm256_set1_epi32(
+                static_cast<int>((static_cast<quint32>(G_U_COEFFICIENT) << 16) | Y_COEFFICIENT));
+    const __m256i greenVCoefficients = _mm256_set1_epi32(
+                static_cast<int>((ROUNDING << 16) | (static_cast<quint32>(G_V_COEFFICIENT) & 0xffff)));
+    const __m256i blueCoefficients = _mm256_set1_epi32((B_U_COEFFICIENT << 16) | Y_COEFFICIENT);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m256i luminance = _mm256_sub_epi16(
+                    _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x))), luminanceOffset);
+        // every U and V value is used for two horizontally adjacent pixels.
+        const __m128i uValues = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+        const __m128i vValues = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+        const __m256i blueDifference = _mm256_sub_epi16(
+                    _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(uValues, uValues)), colorOffset);
+        const __m256i redDifference = _mm256_sub_epi16(
+                    _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(vValues, vValues)), colorOffset);
+
+        // unpacking works per 128 bit lane. Packing the 32 bit results back to 16 bits restores the pixel order.
+        const __m256i yvLow = _mm256_unpacklo_epi16(luminance, redDifference);
+        const __m256i yvHigh = _mm256_unpackhi_epi16(luminance, redDifference);
+        const __m256i yuLow = _mm256_unpacklo_epi16(luminance, blueDifference);
+        const __m256i yuHigh = _mm256_unpackhi_epi16(luminance, blueDifference);
+        const __m256i v1Low = _mm256_unpacklo_epi16(redDifference, one);
+        const __m256i v1High = _mm256_unpackhi_epi16(redDifference, one);
+
+        __m256i r = _mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvLow, redCoefficients), rounding), 8),
+                    _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvHigh, redCoefficients), rounding), 8));
+        __m256i g = _mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLow, greenCoefficients),
+                                                       _mm256_madd_epi16(v1Low, greenVCoefficients)), 8),
+                    _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHigh, greenCoefficients),
+                                                       _mm256_madd_epi16(v1High, greenVCoefficients)), 8));
+        __m256i b = _mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLow, blueCoefficients), rounding), 8),
+                    _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHigh, blueCoefficients), rounding), 8));
+        r = _mm256_min_epi16(_mm256_max_epi16(r, zero), maximum);
+        g = _mm256_min_epi16(_mm256_max_epi16(g, zero), maximum);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), maximum);
+
+        const __m256i blueGreen = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+        const __m256i redAlpha = _mm256_or_si256(r, alpha);
+        // low contains pixels 0-3 and 8-11, high contains pixels 4-7 and 12-15.
+        const __m256i low = _mm256_unpacklo_epi16(blueGreen, redAlpha);
+        const __m256i high = _mm256_unpackhi_epi16(blueGreen, redAlpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb + x), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb + x + 8), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    convertRowSse2(y + x, u + x / 2, v + x / 2, rgb + x, width - x);
+}
+#endif
+
+typedef void (*RowConverter)(const quint8*, const quint8*, const quint8*, quint32*, int);
+
+RowConverter rowConverter(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+#ifdef BIGRING_X86_SIMD
+    case InstructionSet::AVX2:
+        return &convertRowAvx2;
+    case InstructionSet::SSE2:
+        return &convertRowSse2;
+#endif
+    default:
+        return &convertRowScalar;
+    }
+}
+
+/** Split a line of interleaved U and V samples, as in NV12. */
+void deinterleave(const quint8 *uv, quint8 *u, quint8 *v, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        u[x] = uv[2 * x];
+        v[x] = uv[2 * x + 1];
+    }
+}
+
+/** Reduce a line of 10 bit samples, in 16 bit little endian words, to 8 bits. */
+void to8Bits(const quint8 *samples, quint8 *destination, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        const int sample = samples[2 * x] | (samples[2 * x + 1] << 8);
+        destination[x] = static_cast<quint8>(qMin(sample >> 2, 255));
+    }
+}
+}
+
+YuvToRgbConverter::YuvToRgbConverter():
+    YuvToRgbConverter(indoorcycling::bestSupportedInstructionSet())
+{
+    // empty
+}
+
+YuvToRgbConverter::YuvToRgbConverter(InstructionSet instructionSet):
+    _instructionSet(indoorcycling::isSupported(instructionSet) ? instructionSet :
+                                                                 indoorcycling::bestSupportedInstructionSet())
+{
+    // empty
+}
+
+InstructionSet YuvToRgbConverter::instructionSet() const
+{
+    return _instructionSet;
+}
+
+void YuvToRgbConverter::convert(const quint8 * const planes[3], const int lineSizes[3], int width, int height,
+                                quint8 *destination, int destinationLineSize) const
+{
+    const RowConverter convertRow = rowConverter(_instructionSet);
+    for (int row = 0; row < height; ++row) {
+        convertRow(planes[0] + row * lineSizes[0], planes[1] + (row / 2) * lineSizes[1],
+                   planes[2] + (row / 2) * lineSizes[2],
+                   reinterpret_cast<quint32*>(destination + row * destinationLineSize), width);
+    }
+}
+
+void YuvToRgbConverter::convert(const FrameFormat &frameFormat, const quint8 *frame, int width, int height,
+                                quint8 *destination, int destinationLineSize) const
+{
+    const quint8 *planes[3];
+    int lineSizes[3];
+    for (int i = 0; i < frameFormat.planes(); ++i) {
+        planes[i] = frame + frameFormat.planeOffset(i);
+        lineSizes[i] = frameFormat.lineSize(i);
+    }
+    if (frameFormat.pixelFormat() == PixelFormat::YUV420P) {
+        convert(planes, lineSizes, width, height, destination, destinationLineSize);
+        return;
+    }
+
+    const RowConverter convertRow = rowConverter(_instructionSet);
+    const bool fullHeightChroma = (frameFormat.lines(1) == frameFormat.lines(0));
+    const int chromaWidth = (width + 1) / 2;
+    std::vector<quint8> y(static_cast<std::size_t>(width));
+    std::vector<quint8> u(static_cast<std::size_t>(chromaWidth));
+    std::vector<quint8> v(static_cast<std::size_t>(chromaWidth));
+    for (int row = 0; row < height; ++row) {
+        const int chromaRow = fullHeightChroma ? row : row / 2;
+        const quint8 *yLine = planes[0] + row * lineSizes[0];
+        const quint8 *uLine = planes[1] + chromaRow * lineSizes[1];
+        const quint8 *vLine = (frameFormat.planes() > 2) ? planes[2] + chromaRow * lineSizes[2] : nullptr;
+        switch (frameFormat.pixelFormat()) {
+        case PixelFormat::NV12:
+            deinterleave(uLine, u.data(), v.data(), chromaWidth);
+            convertRow(yLine, u.data(), v.data(), reinterpret_cast<quint32*>(destination + row * destinationLineSize),
+                       width);
+            break;
+        case PixelFormat::YUV420P10:
+        case PixelFormat::YUV422P10:
+            to8Bits(yLine, y.data(), width);
+            to8Bits(uLine, u.data(), chromaWidth);
+            to8Bits(vLine, v.data(), chromaWidth);
+            convertRow(y.data(), u.data(), v.data(),
+                       reinterpret_cast<quint32*>(destination + row * destinationLineSize), width);
+            break;
+        default:
+            convertRow(yLine, uLine, vLine, reinterpret_cast<quint32*>(destination + row * destinationLineSize),
+                       width);
+            break;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef YUVTORGBCONVERTER_H
+#define YUVTORGBCONVERTER_H
+
+#include <QtCore/QtGlobal>
+
+#include "frameformat.h"
+#include "util/instructionset.h"
+
+/**
+ * Converts YUV frames to 32 bit RGB (QImage::Format_RGB32), using the same BT.601 coefficients as the fragment
+ * shader of the OpenGLPainter2. The conversion uses fixed point arithmetic, so all instruction sets give exactly
+ * the same result.
+ */
+class YuvToRgbConverter
+{
+public:
+    /** Create a YuvToRgbConverter that uses the best instruction set the cpu supports. */
+    YuvToRgbConverter();
+    /** Create a YuvToRgbConverter that uses \param instructionSet, or the best supported one if that is not supported. */
+    explicit YuvToRgbConverter(indoorcycling::InstructionSet instructionSet);
+
+    indoorcycling::InstructionSet instructionSet() const;
+
+    /**
+     * Convert a YUV420P picture of \param width by \param height pixels.
+     * @param planes pointers to the Y, U and V planes.
+     * @param lineSizes the line sizes of the Y, U and V planes, in bytes.
+     * @param destination the first line of the RGB32 picture.
+     * @param destinationLineSize the line size of the RGB32 picture, in bytes.
+     */
+    void convert(const quint8 * const planes[3], const int lineSizes[3], int width, int height,
+                 quint8 *destination, int destinationLineSize) const;
+    /**
+     * Convert a picture of \param width by \param height pixels from a frame buffer with \param frameFormat. Lines of
+     * other pixel formats than YUV420P and YUV422P are brought to 8 bit planar samples first, one line at a time.
+     * @param frame the frame buffer.
+     * @param destination the first line of the RGB32 picture.
+     * @param destinationLineSize the line size of the RGB32 picture, in bytes.
+     */
+    void convert(const FrameFormat &frameFormat, const quint8 *frame, int width, int height,
+                 quint8 *destination, int destinationLineSize) const;
+
+private:
+    indoorcycling::InstructionSet _instructionSet;
+};
+
+#endif // YUVTORGBCONVERTER_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "frameblendertest.h"
+
+#include <vector>
+
+#include <QtTest/QTest>
+
+#include "video/frameblender.h"
+
+using indoorcycling::InstructionSet;
+
+namespace {
+/** Odd size, so the SIMD implementations also have to handle the last bytes separately. */
+const std::size_t PLANE_SIZE = 1000;
+
+std::vector<quint8> createPlane(int seed)
+{
+    std::vector<quint8> plane(PLANE_SIZE);
+    for (std::size_t i = 0; i < plane.size(); ++i) {
+        plane[i] = static_cast<quint8>((i * 37 + seed * 101) % 256);
+    }
+    return plane;
+}
+}
+
+FrameBlenderTest::FrameBlenderTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void FrameBlenderTest::testMinimumAndMaximumWeight()
+{
+    const std::vector<quint8> first = createPlane(1);
+    const std::vector<quint8> second = createPlane(2);
+    std::vector<quint8> destination(PLANE_SIZE);
+
+    FrameBlender blender;
+    blender.blend(first.data(), second.data(), destination.data(), PLANE_SIZE, 0);
+    QVERIFY(destination == first);
+
+    blender.blend(first.data(), second.data(), destination.data(), PLANE_SIZE, FrameBlender::MAXIMUM_WEIGHT);
+    QVERIFY(destination == second);
+}
+
+void FrameBlenderTest::testRounding()
+{
+    const std::vector<quint8> first(PLANE_SIZE, 0);
+    const std::vector<quint8> second(PLANE_SIZE, 255);
+    std::vector<quint8> destination(PLANE_SIZE);
+
+    FrameBlender blender;
+    blender.blend(first.data(), second.data(), destination.data(), PLANE_SIZE, FrameBlender::MAXIMUM_WEIGHT / 2);
+    QCOMPARE(static_cast<int>(destination.front()), 128);
+    QCOMPARE(static_cast<int>(destination.back()), 128);
+
+    blender.blend(first.data(), second.data(), destination.data(), PLANE_SIZE, FrameBlender::MAXIMUM_WEIGHT / 4);
+    QCOMPARE(static_cast<int>(destination.front()), 64);
+}
+
+void FrameBlenderTest::testInstructionSetsGiveSameResult()
+{
+    const std::vector<quint8> first = createPlane(3);
+    const std::vector<quint8> second = createPlane(4);
+    std::vector<quint8> expected(PLANE_SIZE);
+    std::vector<quint8> actual(PLANE_SIZE);
+
+    const FrameBlender scalarBlender(InstructionSet::SCALAR);
+    for (const InstructionSet instructionSet: { InstructionSet::SSE2, InstructionSet::AVX2 }) {
+        if (!indoorcycling::isSupported(instructionSet)) {
+            continue;
+        }
+        const FrameBlender blender(instructionSet);
+        for (const int weight: { 1, 77, 128, 255 }) {
+            // use unaligned pointers, as the planes of a frame do not have to be aligned.
+            scalarBlender.blend(first.data() + 1, second.data() + 3, expected.data(), PLANE_SIZE - 3, weight);
+            blender.blend(first.data() + 1, second.data() + 3, actual.data(), PLANE_SIZE - 3, weight);
+            QVERIFY2(actual == expected, qPrintable(indoorcycling::instructionSetName(instructionSet)));
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "frameformattest.h"
+
+#include <QtTest/QTest>
+
+#include "video/frameformat.h"
+
+FrameFormatTest::FrameFormatTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void FrameFormatTest::testYuv420PLayout()
+{
+    const FrameFormat format(PixelFormat::YUV420P, QSize(1920, 1080));
+    QCOMPARE(format.planes(), 3);
+    QCOMPARE(format.lineSize(1), 960);
+    QCOMPARE(format.lines(1), 540);
+    QCOMPARE(format.planeOffset(1), 1920 * 1080);
+    QCOMPARE(format.planeOffset(2), 1920 * 1080 + 960 * 540);
+    QCOMPARE(format.bufferSize(), 1920 * 1080 * 3 / 2);
+
+    // the lines of the U and V planes are a multiple of 4 bytes long.
+    QCOMPARE(FrameFormat(PixelFormat::YUV420P, QSize(200, 100)).lineSize(1), 100);
+    QCOMPARE(FrameFormat(PixelFormat::YUV420P, QSize(204, 100)).lineSize(1), 104);
+}
+
+void FrameFormatTest::testNv12Layout()
+{
+    const FrameFormat format(PixelFormat::NV12, QSize(1920, 1080));
+    QCOMPARE(format.planes(), 2);
+    QCOMPARE(format.lineSize(1), 1920);
+    QCOMPARE(format.lines(1), 540);
+    QCOMPARE(format.samplesPerPixel(0), 1);
+    QCOMPARE(format.samplesPerPixel(1), 2);
+    QCOMPARE(format.bufferSize(), 1920 * 1080 * 3 / 2);
+}
+
+void FrameFormatTest::testTenBitYuv422PLayout()
+{
+    // the line size is in bytes, so 1920 pixels of 10 bits take 3840 bytes.
+    const FrameFormat format(PixelFormat::YUV422P10, QSize(3840, 1080));
+    QCOMPARE(format.bytesPerSample(), 2);
+    QCOMPARE(format.lineSize(1), 1920);
+    QCOMPARE(format.lines(1), 1080);
+    QCOMPARE(format.planeOffset(2), 3840 * 1080 + 1920 * 1080);
+    QCOMPARE(format.bufferSize(), 3840 * 1080 * 2);
+}
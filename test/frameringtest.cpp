@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "frameringtest.h"
+
+#include <QtTest/QTest>
+
+#include "video/framering.h"
+
+namespace {
+const qint64 MEGABYTE = 1024 * 1024;
+/** size of a frame buffer for a 1080p YUV420P frame. */
+const qint64 FULL_HD_FRAME_BYTES = 1920 * 1080 * 3 / 2;
+
+void fill(FrameRing &ring, qint64 firstFrameNumber)
+{
+    for (int i = 0; i < ring.size(); ++i) {
+        ring.setFrameLoaded(ring.takeBufferToFill(), firstFrameNumber + i);
+    }
+}
+}
+
+FrameRingTest::FrameRingTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void FrameRingTest::testSizeForMemoryBudget()
+{
+    QCOMPARE(FrameRing::sizeFor(256 * MEGABYTE, FULL_HD_FRAME_BYTES, 0), 86);
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 0), 150);
+    // the budget wins over the minimum size, but a ring needs a buffer to show and one to fill.
+    QCOMPARE(FrameRing::sizeFor(32 * MEGABYTE, FULL_HD_FRAME_BYTES, 0), 10);
+    QCOMPARE(FrameRing::sizeFor(MEGABYTE, FULL_HD_FRAME_BYTES, 0), 2);
+}
+
+void FrameRingTest::testSizeForShownEntries()
+{
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 60.5), 64);
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 57), 64);
+    // only the budget limits the ring, so blended frames at 60 frames per second get a second of read ahead.
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 60 * 4), 240);
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 5), 16);
+    QCOMPARE(FrameRing::sizeFor(64 * MEGABYTE, FULL_HD_FRAME_BYTES, 60), 21);
+}
+
+void FrameRingTest::testSizeForKeepsCurrentSize()
+{
+    // small changes of the speed keep the buffers.
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 70, 64), 64);
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 50, 64), 64);
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 120, 64), 120);
+    QCOMPARE(FrameRing::sizeFor(4096 * MEGABYTE, FULL_HD_FRAME_BYTES, 30, 64), 32);
+    // a ring that does not fit the budget is never kept.
+    QCOMPARE(FrameRing::sizeFor(64 * MEGABYTE, FULL_HD_FRAME_BYTES, 60, 24), 21);
+}
+
+void FrameRingTest::testShowFrame()
+{
+    FrameRing ring(20);
+    fill(ring, 100);
+    QVERIFY(!ring.hasBufferToFill());
+
+    QVERIFY(ring.showFrame(105));
+    QCOMPARE(ring.frameNumber(ring.shownBuffer()), qint64(105));
+    // showing the same frame again should not select another buffer.
+    QVERIFY(!ring.showFrame(105));
+    QVERIFY(ring.hasBufferToFill());
+
+    const FrameRingStatistics statistics = ring.statistics();
+    QCOMPARE(statistics.size, 20);
+    QCOMPARE(statistics.filled, 14);
+    QCOMPARE(statistics.minimumFilled, 19);
+    QCOMPARE(statistics.underruns, 0);
+}
+
+void FrameRingTest::testUnderrunsAreCounted()
+{
+    FrameRing ring(20);
+    fill(ring, 0);
+
+    QVERIFY(ring.showFrame(25));
+    QCOMPARE(ring.statistics().underruns, 1);
+
+    ring.resetStatistics();
+    QCOMPARE(ring.statistics().underruns, 0);
+}
+
+void FrameRingTest::testCancelledFramesAreNotFilled()
+{
+    FrameRing ring(8);
+    for (int i = 0; i < ring.size(); ++i) {
+        ring.takeBufferToFill();
+    }
+    for (int i = 0; i < 4; ++i) {
+        ring.setFrameLoaded(i, i);
+    }
+    // a seek forgets the loaded frames, and the frames that were still requested arrive as cancelled.
+    ring.forgetFrames();
+    for (int i = 4; i < ring.size(); ++i) {
+        ring.setFrameLoaded(i, -1);
+    }
+    QCOMPARE(ring.statistics().filled, 0);
+    QCOMPARE(ring.frameNumber(4), qint64(-1));
+
+    ring.setFrameLoaded(ring.takeBufferToFill(), 100);
+    ring.setFrameLoaded(ring.takeBufferToFill(), 101);
+    QVERIFY(!ring.showFrame(100));
+    QCOMPARE(ring.statistics().filled, 1);
+}
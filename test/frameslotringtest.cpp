@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "frameslotringtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QTest>
+
+#include "video/frameslotring.h"
+
+namespace {
+const FrameFormat FRAME_FORMAT(PixelFormat::YUV420P, QSize(64, 48));
+}
+
+FrameSlotRingTest::FrameSlotRingTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void FrameSlotRingTest::testRequestFillAndRetire()
+{
+    FrameSlotRing ring(3);
+    std::vector<int> buffers(3);
+    QVERIFY(!ring.hasFilledSlot());
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(ring.hasFreeSlot());
+        QCOMPARE(ring.nextSlotToRequest(), i);
+        ring.requestFrame(&buffers[i], FRAME_FORMAT, i, false);
+    }
+    // all slots are requested, so none are free until they are filled and retired.
+    QVERIFY(!ring.hasFreeSlot());
+
+    FrameSlot *slot = ring.slotToFill();
+    QVERIFY(slot);
+    QCOMPARE(slot->data, static_cast<void*>(&buffers[0]));
+    QVERIFY(slot->frameFormat == FRAME_FORMAT);
+    slot->frameNumber = 10;
+    ring.setSlotFilled();
+
+    QVERIFY(ring.hasFilledSlot());
+    QCOMPARE(ring.filledSlotIndex(), 0);
+    QCOMPARE(ring.filledSlot().frameNumber, qint64(10));
+    ring.retireSlot();
+    QVERIFY(!ring.hasFilledSlot());
+
+    QVERIFY(ring.hasFreeSlot());
+    QCOMPARE(ring.nextSlotToRequest(), 0);
+    QCOMPARE(ring.slotToFill()->skipFrames, 1);
+    ring.setSlotFilled();
+    QCOMPARE(ring.filledSlotIndex(), 1);
+}
+
+void FrameSlotRingTest::testReaderIsWokenUp()
+{
+    FrameSlotRing ring(4);
+    int buffer = 0;
+    // the reader starts out waiting, so the first request should wake it up, but the next not.
+    QVERIFY(ring.requestFrame(&buffer, FRAME_FORMAT, 0, false));
+    QVERIFY(!ring.requestFrame(&buffer, FRAME_FORMAT, 0, false));
+
+    // the reader should not wait while there are requests.
+    QVERIFY(!ring.waitForRequests());
+    while (ring.slotToFill()) {
+        ring.setSlotFilled();
+    }
+    QVERIFY(ring.waitForRequests());
+    QVERIFY(ring.requestFrame(&buffer, FRAME_FORMAT, 0, false));
+}
+
+void FrameSlotRingTest::testCloseStopsReader()
+{
+    FrameSlotRing ring(2);
+    int buffer = 0;
+    ring.requestFrame(&buffer, FRAME_FORMAT, 0, false);
+    ring.close();
+    QVERIFY(!ring.slotToFill());
+    QVERIFY(ring.waitForRequests());
+}
+
+void FrameSlotRingTest::testCloseWaitsForSlotBeingFilled()
+{
+    FrameSlotRing ring(2);
+    int buffer = 0;
+    ring.requestFrame(&buffer, FRAME_FORMAT, 0, false);
+    FrameSlot *slot = ring.slotToFill();
+    QVERIFY(slot);
+
+    std::atomic<bool> slotFilled(false);
+    std::thread reader([&ring, &slotFilled, slot]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        *static_cast<int*>(slot->data) = 1;
+        slotFilled = true;
+        ring.setSlotFilled();
+    });
+    // close() may only return when the reader does not write to the buffer anymore.
+    ring.close();
+    QVERIFY(slotFilled);
+    reader.join();
+    QVERIFY(!ring.slotToFill());
+}
+
+void FrameSlotRingTest::testBatchIsCancelled()
+{
+    FrameSlotRing ring(4);
+    std::vector<int> buffers(4);
+    for (int i = 0; i < 3; ++i) {
+        ring.prepareRequest(i, &buffers[i], FRAME_FORMAT, 0, false);
+    }
+    // the reader is only woken up once for the whole batch.
+    QVERIFY(ring.requestFrames(3));
+    QCOMPARE(ring.freeSlots(), 1);
+
+    // the reader filled the first frame before the batch was cancelled.
+    ring.slotToFill()->frameNumber = 1;
+    ring.setSlotFilled();
+    ring.cancelRequests();
+    QVERIFY(!ring.requestFrame(&buffers[3], FRAME_FORMAT, 0, false));
+
+    // the reader skips the cancelled requests, and goes on with the new one.
+    FrameSlot *slot = ring.slotToFill();
+    QVERIFY(slot);
+    QCOMPARE(slot->data, static_cast<void*>(&buffers[3]));
+    slot->frameNumber = 4;
+    ring.setSlotFilled();
+
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(ring.hasFilledSlot());
+        QVERIFY(ring.filledSlotCancelled());
+        ring.retireSlot();
+    }
+    QVERIFY(!ring.filledSlotCancelled());
+    QCOMPARE(ring.filledSlot().frameNumber, qint64(4));
+    ring.retireSlot();
+    QCOMPARE(ring.freeSlots(), 4);
+}
+
+void FrameSlotRingTest::testHandoffBetweenThreads()
+{
+    const qint64 numberOfFrames = 10000;
+    FrameSlotRing ring(16);
+    std::vector<qint64> buffers(16);
+
+    std::thread reader([&ring, numberOfFrames]() {
+        qint64 frameNumber = 0;
+        while (frameNumber < numberOfFrames) {
+            if (FrameSlot *slot = ring.slotToFill()) {
+                *static_cast<qint64*>(slot->data) = frameNumber;
+                slot->frameNumber = frameNumber++;
+                ring.setSlotFilled();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    qint64 expectedFrameNumber = 0;
+    bool framesInOrder = true;
+    while (expectedFrameNumber < numberOfFrames) {
+        while (ring.hasFreeSlot()) {
+            const int index = ring.nextSlotToRequest();
+            ring.requestFrame(&buffers[index], FRAME_FORMAT, 0, false);
+        }
+        while (ring.hasFilledSlot()) {
+            const FrameSlot &slot = ring.filledSlot();
+            framesInOrder &= (slot.frameNumber == expectedFrameNumber);
+            framesInOrder &= (buffers[ring.filledSlotIndex()] == expectedFrameNumber);
+            ++expectedFrameNumber;
+            ring.retireSlot();
+        }
+        std::this_thread::yield();
+    }
+    reader.join();
+    QVERIFY(framesInOrder);
+}
+
+void FrameSlotRingTest::testStartAtFirstSlot()
+{
+    FrameSlotRing ring(4, 3);
+    std::vector<int> buffers(2);
+    QCOMPARE(ring.freeSlots(), 4);
+    QCOMPARE(ring.nextSlotToRequest(), 3);
+    ring.requestFrame(&buffers[0], FRAME_FORMAT, 0, false);
+    ring.requestFrame(&buffers[1], FRAME_FORMAT, 0, false);
+    QCOMPARE(ring.nextSlotToRequest(), 1);
+
+    while (FrameSlot *slot = ring.slotToFill()) {
+        slot->frameNumber = 0;
+        ring.setSlotFilled();
+    }
+    QCOMPARE(ring.filledSlots(), 2);
+    QCOMPARE(ring.filledSlotIndex(), 3);
+    QCOMPARE(ring.filledSlot().data, static_cast<void*>(&buffers[0]));
+    ring.retireSlot();
+    QCOMPARE(ring.filledSlotIndex(), 0);
+    QCOMPARE(ring.filledSlots(), 1);
+}
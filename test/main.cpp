@@ -1,11 +1,22 @@
 #include "antmessage2test.h"
 #include "distanceentrycollectiontest.h"
+#include "frameblendertest.h"
+#include "frameformattest.h"
+#include "frameringtest.h"
+#include "frameslotringtest.h"
+#include "pipelinetimingstest.h"
 #include "profiletest.h"
+#include "proxytranscodertest.h"
+#include "readaheadcontrollertest.h"
 #include "reallifevideocachetest.h"
 #include "ridefilewritertest.h"
 #include "rollingaveragecalculatortest.h"
+#include "videofilesourcetest.h"
+#include "videoindextest.h"
+#include "videoinformationtest.h"
 #include "virtualtrainingfileparsertest.h"
 #include "virtualpowertest.h"
+#include "yuvtorgbconvertertest.h"
 
 #include <QTest>
 
@@ -27,4 +38,15 @@ int main(int, char**) {
     execTest<RealLifeVideoCacheTest>();
     execTest<DistanceEntryCollectionTest>();
     execTest<VirtualTrainingFileParserTest>();
+    execTest<VideoIndexTest>();
+    execTest<FrameBlenderTest>();
+    execTest<YuvToRgbConverterTest>();
+    execTest<FrameFormatTest>();
+    execTest<FrameRingTest>();
+    execTest<FrameSlotRingTest>();
+    execTest<ReadAheadControllerTest>();
+    execTest<PipelineTimingsTest>();
+    execTest<VideoFileSourceTest>();
+    execTest<VideoInformationTest>();
+    execTest<ProxyTranscoderTest>();
 }
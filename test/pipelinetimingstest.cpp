@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "pipelinetimingstest.h"
+
+#include <QtTest/QTest>
+
+#include "video/pipelinetimings.h"
+
+PipelineTimingsTest::PipelineTimingsTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void PipelineTimingsTest::testBucketBounds()
+{
+    // every latency should be in a bucket with a higher upper bound, and above the upper bound of the bucket before.
+    for (qint64 nanoseconds = 0; nanoseconds < 100000; nanoseconds += 7) {
+        const int index = LatencyHistogram::bucketIndex(nanoseconds);
+        QVERIFY(nanoseconds < LatencyHistogram::bucketUpperBound(index));
+        if (index > 0) {
+            QVERIFY(nanoseconds >= LatencyHistogram::bucketUpperBound(index - 1));
+        }
+    }
+    // a bucket is never wider than a quarter of the latencies in it.
+    const qint64 tenMilliseconds = 10 * 1000 * 1000;
+    QVERIFY(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(tenMilliseconds)) <= tenMilliseconds * 5 / 4);
+}
+
+void PipelineTimingsTest::testPercentiles()
+{
+    LatencyHistogram histogram;
+    QCOMPARE(histogram.percentile(0.5), Q_INT64_C(0));
+
+    // 98 fast frames of 1 ms, and 2 slow frames of 40 ms.
+    for (int i = 0; i < 98; ++i) {
+        histogram.record(1000000);
+    }
+    histogram.record(40000000);
+    histogram.record(40000000);
+
+    QCOMPARE(histogram.count(), Q_UINT64_C(100));
+    QCOMPARE(histogram.maximum(), Q_INT64_C(40000000));
+    QCOMPARE(histogram.average(), 1780000.0);
+    QVERIFY(histogram.percentile(0.5) > 1000000);
+    QVERIFY(histogram.percentile(0.5) <= 1250000);
+    QVERIFY(histogram.percentile(0.95) <= 1250000);
+    QCOMPARE(histogram.percentile(0.99), Q_INT64_C(40000001));
+}
+
+void PipelineTimingsTest::testReset()
+{
+    PipelineTimings timings;
+    timings.record(PipelineStage::DECODE, 5000000);
+    timings.record(PipelineStage::PAINT, 2000000);
+    QCOMPARE(timings.histogram(PipelineStage::DECODE).count(), Q_UINT64_C(1));
+    QCOMPARE(timings.histogram(PipelineStage::COPY).count(), Q_UINT64_C(0));
+
+    timings.reset();
+    QCOMPARE(timings.histogram(PipelineStage::DECODE).count(), Q_UINT64_C(0));
+    QCOMPARE(timings.histogram(PipelineStage::PAINT).maximum(), Q_INT64_C(0));
+}
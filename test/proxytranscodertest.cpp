@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "proxytranscodertest.h"
+
+#include <cstring>
+#include <vector>
+
+#include <QtCore/QDir>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include "importer/videoindexcache.h"
+#include "video/genericvideoreader.h"
+#include "video/proxytranscoder.h"
+
+namespace {
+const int FRAME_SIZE = 64;
+const int FRAMES_PER_SECOND = 25;
+
+/** Reads the number of frames of a video from its index, which is what the frame numbers of a ride are based on. */
+class FrameCounter : public GenericVideoReader
+{
+public:
+    qint64 numberOfFrames(const QString &videoFilename)
+    {
+        openVideoFileInternal(videoFilename);
+        if (!codecContext()) {
+            return -1;
+        }
+        loadVideoIndex(true);
+        return totalNumberOfFrames();
+    }
+};
+
+bool writeFrame(AVFormatContext *formatContext, AVStream *stream, AVCodecContext *encoderContext, AVFrame *frame)
+{
+    if (avcodec_send_frame(encoderContext, frame) < 0) {
+        return false;
+    }
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = nullptr;
+    packet.size = 0;
+    int errorNr;
+    while ((errorNr = avcodec_receive_packet(encoderContext, &packet)) == 0) {
+        av_packet_rescale_ts(&packet, encoderContext->time_base, stream->time_base);
+        packet.stream_index = stream->index;
+        if (av_interleaved_write_frame(formatContext, &packet) < 0) {
+            return false;
+        }
+    }
+    return errorNr == AVERROR(EAGAIN) || errorNr == AVERROR_EOF;
+}
+
+/**
+ * Write a Motion JPEG video to \param filename, with a frame for every timestamp in \param timestamps, in frames.
+ * Every frame has a shade of grey of its own.
+ */
+bool writeVideo(const QString &filename, const std::vector<qint64> &timestamps)
+{
+    av_register_all();
+    AVFormatContext *formatContext = nullptr;
+    if (avformat_alloc_output_context2(&formatContext, nullptr, "matroska", filename.toStdString().c_str()) < 0) {
+        return false;
+    }
+    AVCodec *encoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    AVStream *stream = avformat_new_stream(formatContext, nullptr);
+    AVCodecContext *encoderContext = encoder ? avcodec_alloc_context3(encoder) : nullptr;
+    AVFrame *frame = av_frame_alloc();
+    bool success = stream && encoderContext && frame;
+    if (success) {
+        encoderContext->width = FRAME_SIZE;
+        encoderContext->height = FRAME_SIZE;
+        encoderContext->pix_fmt = AV_PIX_FMT_YUVJ420P;
+        encoderContext->time_base = av_make_q(1, FRAMES_PER_SECOND);
+        encoderContext->framerate = av_make_q(FRAMES_PER_SECOND, 1);
+        if (formatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+            encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        success = avcodec_open2(encoderContext, encoder, nullptr) >= 0;
+    }
+    if (success) {
+        stream->time_base = encoderContext->time_base;
+        stream->avg_frame_rate = encoderContext->framerate;
+        avcodec_parameters_from_context(stream->codecpar, encoderContext);
+        frame->width = FRAME_SIZE;
+        frame->height = FRAME_SIZE;
+        frame->format = encoderContext->pix_fmt;
+        success = av_frame_get_buffer(frame, 32) >= 0 &&
+                avio_open(&formatContext->pb, filename.toStdString().c_str(), AVIO_FLAG_WRITE) >= 0 &&
+                avformat_write_header(formatContext, nullptr) >= 0;
+    }
+    for (std::size_t i = 0; success && i < timestamps.size(); ++i) {
+        success = av_frame_make_writable(frame) >= 0;
+        const int grey = static_cast<int>(16 + 8 * i);
+        std::memset(frame->data[0], grey, static_cast<std::size_t>(frame->linesize[0] * FRAME_SIZE));
+        std::memset(frame->data[1], 128, static_cast<std::size_t>(frame->linesize[1] * FRAME_SIZE / 2));
+        std::memset(frame->data[2], 128, static_cast<std::size_t>(frame->linesize[2] * FRAME_SIZE / 2));
+        frame->pts = timestamps[i];
+        success = success && writeFrame(formatContext, stream, encoderContext, frame);
+    }
+    success = success && writeFrame(formatContext, stream, encoderContext, nullptr) &&
+            av_write_trailer(formatContext) >= 0;
+
+    av_frame_free(&frame);
+    avcodec_free_context(&encoderContext);
+    if (formatContext->pb) {
+        avio_closep(&formatContext->pb);
+    }
+    avformat_free_context(formatContext);
+    return success;
+}
+
+/** Transcode \param videoFilename into a proxy, and return the number of frames of the proxy, or -1 on failure. */
+qint64 proxyNumberOfFrames(const QString &videoFilename)
+{
+    const QString proxyFilename = videoFilename + ".proxy.mkv";
+    ProxyTranscoder transcoder;
+    if (!transcoder.transcode(QStringList(videoFilename), proxyFilename, QSize())) {
+        return -1;
+    }
+    return FrameCounter().numberOfFrames(proxyFilename);
+}
+}
+
+ProxyTranscoderTest::ProxyTranscoderTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void ProxyTranscoderTest::initTestCase()
+{
+    // the indexes of the test videos should not end up in the cache of the user.
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void ProxyTranscoderTest::testProxyHasFramesOfOriginal()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString videoFilename = QDir(dir.path()).filePath("video.mkv");
+    std::vector<qint64> timestamps;
+    for (qint64 i = 0; i < 20; ++i) {
+        timestamps.push_back(i);
+    }
+    QVERIFY(writeVideo(videoFilename, timestamps));
+
+    QCOMPARE(FrameCounter().numberOfFrames(videoFilename), Q_INT64_C(20));
+    QCOMPARE(proxyNumberOfFrames(videoFilename), Q_INT64_C(20));
+}
+
+void ProxyTranscoderTest::testFrameWithDuplicateTimestampIsReplaced()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString videoFilename = QDir(dir.path()).filePath("video.mkv");
+    // the fifth frame has the timestamp of the fourth, so both get the same frame number when decoding, and the
+    // frame number of the fourth frame is never decoded.
+    const std::vector<qint64> timestamps = { 0, 1, 2, 3, 3, 5, 6, 7, 8, 9 };
+    QVERIFY(writeVideo(videoFilename, timestamps));
+
+    const qint64 numberOfFrames = FrameCounter().numberOfFrames(videoFilename);
+    QCOMPARE(numberOfFrames, Q_INT64_C(10));
+    QCOMPARE(proxyNumberOfFrames(videoFilename), numberOfFrames);
+}
+
+void ProxyTranscoderTest::testProxyIndexIsCached()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString videoFilename = QDir(dir.path()).filePath("video.mkv");
+    std::vector<qint64> timestamps;
+    for (qint64 i = 0; i < 30; ++i) {
+        timestamps.push_back(i);
+    }
+    QVERIFY(writeVideo(videoFilename, timestamps));
+    const QString proxyFilename = videoFilename + ".proxy.mkv";
+    QVERIFY(ProxyTranscoder().transcode(QStringList(videoFilename), proxyFilename, QSize()));
+
+    // the proxy is never played with frame numbers that are estimated from its millisecond timestamps.
+    std::unique_ptr<VideoIndex> index = VideoIndexCache().load(QFileInfo(proxyFilename));
+    QVERIFY(index);
+    QCOMPARE(index->numberOfFrames(), Q_INT64_C(30));
+    for (qint64 frameNumber = 0; frameNumber < 30; ++frameNumber) {
+        QCOMPARE(index->frameNumberForTimestamp(index->timestampForFrame(frameNumber)), frameNumber);
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "readaheadcontrollertest.h"
+
+#include <QtTest/QTest>
+
+#include "video/readaheadcontroller.h"
+
+namespace {
+const int MAX_STEP_SIZE = 5;
+/** interval between two simulation steps. */
+const qint64 STEP_MILLISECONDS = 100;
+}
+
+ReadAheadControllerTest::ReadAheadControllerTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void ReadAheadControllerTest::testConstantSpeed()
+{
+    ReadAheadController controller(MAX_STEP_SIZE);
+    controller.setMetersPerFrame(0.25);
+    controller.setDecodeFramesPerSecond(100);
+    for (int i = 0; i < 10; ++i) {
+        controller.setSpeed(10, i * STEP_MILLISECONDS);
+    }
+
+    QCOMPARE(controller.acceleration(), 0.0);
+    // 10 m/s for 2 seconds, with 4 frames per meter.
+    QCOMPARE(controller.predictedFrames(), 80.0);
+    QCOMPARE(controller.peakFramesPerSecond(), 40.0);
+    QCOMPARE(controller.stepSize(), 1);
+    QCOMPARE(controller.readAheadFrames(), 80);
+}
+
+void ReadAheadControllerTest::testAccelerationIncreasesStepSize()
+{
+    ReadAheadController controller(MAX_STEP_SIZE);
+    controller.setMetersPerFrame(0.25);
+    controller.setDecodeFramesPerSecond(50);
+    // accelerate by 4 m/s per second.
+    for (int i = 0; i < 20; ++i) {
+        controller.setSpeed(8 + 0.4 * i, i * STEP_MILLISECONDS);
+    }
+    QVERIFY(qAbs(controller.acceleration() - 4.0) < 0.01);
+
+    // at the current speed of 15.6 m/s, 62.4 frames per second would be needed, which the decoder could do with
+    // skipping every other frame. But the cyclist will be at 23.6 m/s in 2 seconds.
+    QVERIFY(controller.peakFramesPerSecond() > 94);
+    QCOMPARE(controller.stepSize(), 3);
+    QCOMPARE(controller.readAheadFrames(), 53);
+
+    // the step size is never higher than the maximum.
+    controller.setDecodeFramesPerSecond(5);
+    QCOMPARE(controller.stepSize(), MAX_STEP_SIZE);
+}
+
+void ReadAheadControllerTest::testDecelerationToStop()
+{
+    ReadAheadController controller(MAX_STEP_SIZE);
+    controller.setMetersPerFrame(0.5);
+    controller.setDecodeFramesPerSecond(100);
+    // brake by 5 m/s per second, down to 1.5 m/s.
+    for (int i = 0; i < 10; ++i) {
+        controller.setSpeed(6 - 0.5 * i, i * STEP_MILLISECONDS);
+    }
+    QVERIFY(controller.acceleration() < -4.5);
+
+    // the cyclist stops within a meter, so only the minimum number of frames is decoded ahead.
+    QVERIFY(controller.predictedFrames() < 1);
+    QCOMPARE(controller.peakFramesPerSecond(), 3.0);
+    QCOMPARE(controller.stepSize(), 1);
+    QCOMPARE(controller.readAheadFrames(), 8);
+
+    // after a pause, the old speeds say nothing about the acceleration anymore.
+    controller.setSpeed(1.5, 60 * 1000);
+    QCOMPARE(controller.acceleration(), 0.0);
+}
+
+void ReadAheadControllerTest::testRefillFrames()
+{
+    ReadAheadController controller(MAX_STEP_SIZE);
+    controller.setMetersPerFrame(0.25);
+    controller.setDecodeFramesPerSecond(100);
+
+    // standing still, the minimum read ahead is refilled when half of it is shown.
+    QCOMPARE(controller.readAheadFrames(), 8);
+    QCOMPARE(controller.refillFrames(), 4);
+
+    for (int i = 0; i < 10; ++i) {
+        controller.setSpeed(10, i * STEP_MILLISECONDS);
+    }
+    QCOMPARE(controller.readAheadFrames(), 80);
+    QCOMPARE(controller.refillFrames(), 40);
+}
+
+void ReadAheadControllerTest::testStepSizeConverges()
+{
+    ReadAheadController controller(MAX_STEP_SIZE);
+    controller.setMetersPerFrame(0.25);
+    for (int i = 0; i < 10; ++i) {
+        controller.setSpeed(15, i * STEP_MILLISECONDS);
+    }
+    // every frame of the video takes 20 ms to decode, so 60 frames per second need a step of 2.
+    const qint64 frameNanoseconds = 20 * 1000 * 1000;
+    for (int i = 0; i < 200; ++i) {
+        const int stepSize = controller.stepSize();
+        controller.addDecodedFrame(stepSize - 1, stepSize * frameNanoseconds, 0);
+    }
+    QVERIFY(qAbs(controller.decodeFramesPerSecond() - 50) < 0.01);
+    QCOMPARE(controller.stepSize(), 2);
+}
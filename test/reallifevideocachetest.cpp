@@ -29,6 +29,7 @@ const QFileInfo BAVELLA_PGMF_FILE = QFileInfo(":///resources/FR_Bavella.pgmf");
 QList<QFileInfo> videoFiles = { BAVELLA_VIDEO_FILE };
 }
 
+#include <QtCore/QTemporaryFile>
 #include <QtTest/QTest>
 RealLifeVideoCacheTest::RealLifeVideoCacheTest(QObject *parent) :
     QObject(parent)
@@ -82,3 +83,34 @@ void RealLifeVideoCacheTest::testSaveAndLoad()
         QCOMPARE(deserialized.slope(), original.slope());
     }
 }
+
+void RealLifeVideoCacheTest::testSaveAndLoadProbedVideoInformation()
+{
+    QTemporaryFile videoFile;
+    QVERIFY(videoFile.open());
+    videoFile.write(QByteArray(1024, 'v'));
+    videoFile.flush();
+    const QFileInfo videoFileInfo(videoFile.fileName());
+
+    QFile fTacx(":///resources/FR_Bavella.rlv");
+    RealLifeVideo tacxRlv = RlvFileParser({BAVELLA_PGMF_FILE}, videoFiles).parseRlvFile(fTacx);
+    VideoInformation videoInformation(videoFile.fileName(), 25.0f);
+    videoInformation.setProbedMetadata(50000, QSize(1280, 720), "yuv420p", videoFileInfo.size(),
+                                       videoFileInfo.lastModified());
+    tacxRlv.setVideoInformation(videoInformation);
+
+    _cache.save(fTacx, tacxRlv);
+    std::unique_ptr<RealLifeVideo> rlvPtr = _cache.load(fTacx);
+    QVERIFY(rlvPtr.get() != nullptr);
+
+    const VideoInformation &loaded = rlvPtr->videoInformation();
+    QCOMPARE(loaded.numberOfFrames(), Q_INT64_C(50000));
+    QCOMPARE(loaded.frameSize(), QSize(1280, 720));
+    QCOMPARE(loaded.pixelFormat(), QString("yuv420p"));
+    QVERIFY(loaded.isProbedFor(videoFileInfo));
+
+    // a changed video file has to be probed again.
+    videoFile.write(QByteArray(1024, 'v'));
+    videoFile.flush();
+    QVERIFY(!loaded.isProbedFor(QFileInfo(videoFile.fileName())));
+}
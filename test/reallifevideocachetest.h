@@ -32,6 +32,7 @@ public:
 
 private slots:
     void testSaveAndLoad();
+    void testSaveAndLoadProbedVideoInformation();
 private:
     RealLifeVideoCache _cache;
 };
@@ -10,10 +10,21 @@ SOURCES += \
     virtualpowertest.cpp \
     virtualtrainingfileparsertest.cpp \
     profiletest.cpp \
+    proxytranscodertest.cpp \
     rollingaveragecalculatortest.cpp \
     reallifevideocachetest.cpp \
     ridefilewritertest.cpp \
-    distanceentrycollectiontest.cpp
+    distanceentrycollectiontest.cpp \
+    frameblendertest.cpp \
+    frameformattest.cpp \
+    frameringtest.cpp \
+    frameslotringtest.cpp \
+    pipelinetimingstest.cpp \
+    readaheadcontrollertest.cpp \
+    videofilesourcetest.cpp \
+    videoindextest.cpp \
+    videoinformationtest.cpp \
+    yuvtorgbconvertertest.cpp
 
 HEADERS += \
     antmessage2test.h \
@@ -21,10 +32,21 @@ HEADERS += \
     virtualpowertest.h \
     virtualtrainingfileparsertest.h \
     profiletest.h \
+    proxytranscodertest.h \
     rollingaveragecalculatortest.h \
     reallifevideocachetest.h \
     ridefilewritertest.h \
-    distanceentrycollectiontest.h
+    distanceentrycollectiontest.h \
+    frameblendertest.h \
+    frameformattest.h \
+    frameringtest.h \
+    frameslotringtest.h \
+    pipelinetimingstest.h \
+    readaheadcontrollertest.h \
+    videofilesourcetest.h \
+    videoindextest.h \
+    videoinformationtest.h \
+    yuvtorgbconvertertest.h
 
 
 RESOURCES += \
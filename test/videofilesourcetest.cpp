@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videofilesourcetest.h"
+
+#include <vector>
+
+#include <QtTest/QTest>
+
+#include "video/throttledfile.h"
+#include "video/videofilesource.h"
+
+namespace {
+// a bit more than five blocks, so the last block is not complete.
+const qint64 FILE_SIZE = 5 * VideoFileSource::BLOCK_SIZE + 12345;
+// the size of the reads libav does with its default buffer.
+const qint64 READ_SIZE = 32 * 1024;
+// simulate a network share with a latency of 200 microseconds for every read.
+const int LATENCY_MICROSECONDS = 200;
+
+char byteAt(qint64 position)
+{
+    return static_cast<char>((position * 7 + position / 4096) & 0xff);
+}
+
+/** Read \param length bytes from \param position, and check that they're the bytes of the test file. */
+bool readAndVerify(VideoFileSource &source, qint64 position, qint64 length)
+{
+    std::vector<char> data(static_cast<std::size_t>(length));
+    if (!source.seek(position) || source.read(data.data(), length) != length) {
+        return false;
+    }
+    for (qint64 i = 0; i < length; ++i) {
+        if (data[static_cast<std::size_t>(i)] != byteAt(position + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Read the whole file in pieces of READ_SIZE, and check the contents. */
+bool readWholeFile(VideoFileSource &source)
+{
+    for (qint64 position = 0; position < FILE_SIZE; position += READ_SIZE) {
+        if (!readAndVerify(source, position, qMin(READ_SIZE, FILE_SIZE - position))) {
+            return false;
+        }
+    }
+    char byte;
+    return source.read(&byte, 1) == 0;
+}
+}
+
+VideoFileSourceTest::VideoFileSourceTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void VideoFileSourceTest::initTestCase()
+{
+    QVERIFY(_videoFile.open());
+    std::vector<char> data(static_cast<std::size_t>(FILE_SIZE));
+    for (qint64 i = 0; i < FILE_SIZE; ++i) {
+        data[static_cast<std::size_t>(i)] = byteAt(i);
+    }
+    QCOMPARE(_videoFile.write(data.data(), FILE_SIZE), FILE_SIZE);
+    QVERIFY(_videoFile.flush());
+}
+
+void VideoFileSourceTest::testDirectReadsSmallPieces()
+{
+    ThrottledFile *file = new ThrottledFile(_videoFile.fileName(), 0, LATENCY_MICROSECONDS);
+    VideoFileSource source(std::unique_ptr<QFile>(file), VideoFileAccess::DIRECT);
+    QVERIFY(source.open());
+    QCOMPARE(source.size(), FILE_SIZE);
+
+    QVERIFY(readWholeFile(source));
+    // every read of libav is a read from the file.
+    QVERIFY(file->reads() >= FILE_SIZE / READ_SIZE);
+}
+
+void VideoFileSourceTest::testReadAheadReadsLargeBlocks()
+{
+    ThrottledFile *file = new ThrottledFile(_videoFile.fileName(), 0, LATENCY_MICROSECONDS);
+    VideoFileSource source(std::unique_ptr<QFile>(file), VideoFileAccess::READ_AHEAD);
+    QVERIFY(source.open());
+    QCOMPARE(source.fileAccess(), VideoFileAccess::READ_AHEAD);
+
+    QVERIFY(readWholeFile(source));
+    // a read for every block, and one more to find the end of the last block.
+    QVERIFY(file->reads() <= FILE_SIZE / VideoFileSource::BLOCK_SIZE + 2);
+    QCOMPARE(file->bytesRead(), FILE_SIZE);
+}
+
+void VideoFileSourceTest::testReadAheadSeekAndPrefetch()
+{
+    ThrottledFile *file = new ThrottledFile(_videoFile.fileName(), 0, LATENCY_MICROSECONDS);
+    VideoFileSource source(std::unique_ptr<QFile>(file), VideoFileAccess::READ_AHEAD);
+    QVERIFY(source.open());
+
+    // a read over the boundary of two blocks.
+    QVERIFY(readAndVerify(source, 3 * VideoFileSource::BLOCK_SIZE - 100, 200));
+    // seek back, like a seek to an earlier key frame, after telling the source where the packets will be read.
+    source.prefetch(VideoFileSource::BLOCK_SIZE / 2);
+    QVERIFY(readAndVerify(source, VideoFileSource::BLOCK_SIZE / 2, READ_SIZE));
+    // the end of the file, and past the end.
+    QVERIFY(readAndVerify(source, FILE_SIZE - 10, 10));
+    char byte;
+    QCOMPARE(source.read(&byte, 1), Q_INT64_C(0));
+    QVERIFY(!source.seek(FILE_SIZE + 1));
+}
+
+void VideoFileSourceTest::testMemoryMapped()
+{
+    VideoFileSource source(std::unique_ptr<QFile>(new QFile(_videoFile.fileName())), VideoFileAccess::MEMORY_MAPPED);
+    QVERIFY(source.open());
+    QCOMPARE(source.fileAccess(), VideoFileAccess::MEMORY_MAPPED);
+
+    QVERIFY(readWholeFile(source));
+    QVERIFY(readAndVerify(source, 2 * VideoFileSource::BLOCK_SIZE - 100, 200));
+}
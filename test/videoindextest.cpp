@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "videoindextest.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QTemporaryFile>
+#include <QtTest/QTest>
+
+#include "importer/videoindexcache.h"
+
+namespace {
+/**
+ * Create an index for a video with a GOP of 6 frames and B-frames, so decoding order differs from
+ * presentation order. Frame timestamps are 10 time base units apart.
+ */
+VideoIndex createIndexWithBFrames()
+{
+    // decoding order: I0 P3 B1 B2 I6 P9 B7 B8
+    std::vector<VideoIndexEntry> entries = {
+        VideoIndexEntry(0, -10, 0, true),
+        VideoIndexEntry(30, 0, 1000, false),
+        VideoIndexEntry(10, 10, 2000, false),
+        VideoIndexEntry(20, 20, 3000, false),
+        VideoIndexEntry(60, 30, 4000, true),
+        VideoIndexEntry(90, 40, 5000, false),
+        VideoIndexEntry(70, 50, 6000, false),
+        VideoIndexEntry(80, 60, 7000, false)
+    };
+    return VideoIndex(std::move(entries));
+}
+}
+
+VideoIndexTest::VideoIndexTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void VideoIndexTest::testEmptyIndex()
+{
+    VideoIndex index;
+
+    QVERIFY(index.isEmpty());
+    QCOMPARE(index.numberOfFrames(), Q_INT64_C(0));
+    QCOMPARE(index.frameNumberForTimestamp(100), Q_INT64_C(-1));
+}
+
+void VideoIndexTest::testEntriesAreSortedInPresentationOrder()
+{
+    VideoIndex index = createIndexWithBFrames();
+
+    QCOMPARE(index.numberOfFrames(), Q_INT64_C(8));
+    for (qint64 frameNumber = 0; frameNumber < index.numberOfFrames(); ++frameNumber) {
+        QCOMPARE(index.timestampForFrame(frameNumber), frameNumber * 10);
+    }
+}
+
+void VideoIndexTest::testFrameNumberForTimestamp()
+{
+    VideoIndex index = createIndexWithBFrames();
+
+    QCOMPARE(index.frameNumberForTimestamp(0), Q_INT64_C(0));
+    QCOMPARE(index.frameNumberForTimestamp(30), Q_INT64_C(3));
+    QCOMPARE(index.frameNumberForTimestamp(35), Q_INT64_C(3));
+    QCOMPARE(index.frameNumberForTimestamp(-5), Q_INT64_C(0));
+    QCOMPARE(index.frameNumberForTimestamp(1000), Q_INT64_C(7));
+}
+
+void VideoIndexTest::testSeekToKeyFrame()
+{
+    VideoIndex index = createIndexWithBFrames();
+
+    QCOMPARE(index.keyFrameBefore(0), Q_INT64_C(0));
+    QCOMPARE(index.keyFrameBefore(5), Q_INT64_C(0));
+    QCOMPARE(index.keyFrameBefore(6), Q_INT64_C(6));
+    QCOMPARE(index.keyFrameBefore(7), Q_INT64_C(6));
+    QCOMPARE(index.keyFrameBefore(100), Q_INT64_C(6));
+
+    QCOMPARE(index.seekTimestampForFrame(4), Q_INT64_C(-10));
+    QCOMPARE(index.seekTimestampForFrame(8), Q_INT64_C(30));
+}
+
+void VideoIndexTest::testSaveAndLoad()
+{
+    QTemporaryFile videoFile;
+    QVERIFY(videoFile.open());
+    videoFile.write("not really a video");
+    videoFile.flush();
+    const QFileInfo videoFileInfo(videoFile.fileName());
+
+    VideoIndex index = createIndexWithBFrames();
+    VideoIndexCache cache;
+    cache.save(videoFileInfo, index);
+
+    std::unique_ptr<VideoIndex> loaded = cache.load(videoFileInfo);
+    QVERIFY(loaded.get() != nullptr);
+    QCOMPARE(loaded->numberOfFrames(), index.numberOfFrames());
+    for (auto i = 0u; i < index.entries().size(); ++i) {
+        QCOMPARE(loaded->entries()[i].pts(), index.entries()[i].pts());
+        QCOMPARE(loaded->entries()[i].dts(), index.entries()[i].dts());
+        QCOMPARE(loaded->entries()[i].position(), index.entries()[i].position());
+        QCOMPARE(loaded->entries()[i].isKeyFrame(), index.entries()[i].isKeyFrame());
+    }
+
+    // when the video file changes size, the cached index should not be used anymore.
+    videoFile.write("some more bytes");
+    videoFile.flush();
+    QVERIFY(cache.load(QFileInfo(videoFile.fileName())).get() == nullptr);
+}
+
+void VideoIndexTest::testSameNameInDifferentFolders()
+{
+    QTemporaryDir firstDir;
+    QTemporaryDir secondDir;
+    QVERIFY(firstDir.isValid() && secondDir.isValid());
+    QFile firstVideo(QDir(firstDir.path()).filePath("video.avi"));
+    QFile secondVideo(QDir(secondDir.path()).filePath("video.avi"));
+    // the same size, so only the path tells the videos apart.
+    for (QFile *video: { &firstVideo, &secondVideo }) {
+        QVERIFY(video->open(QIODevice::WriteOnly));
+        video->write("not really a video");
+        video->close();
+    }
+
+    VideoIndexCache cache;
+    const VideoIndex index = createIndexWithBFrames();
+    cache.save(QFileInfo(firstVideo.fileName()), index);
+    cache.save(QFileInfo(secondVideo.fileName()), VideoIndex());
+
+    std::unique_ptr<VideoIndex> loaded = cache.load(QFileInfo(firstVideo.fileName()));
+    QVERIFY(loaded.get() != nullptr);
+    QCOMPARE(loaded->numberOfFrames(), index.numberOfFrames());
+    loaded = cache.load(QFileInfo(secondVideo.fileName()));
+    QVERIFY(loaded.get() != nullptr);
+    QVERIFY(loaded->isEmpty());
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "videoinformationtest.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "model/videoinformation.h"
+
+namespace {
+void writeFile(const QString &filename)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("video");
+}
+}
+
+VideoInformationTest::VideoInformationTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void VideoInformationTest::testProxyVideoFilename()
+{
+    const QStringList videoFilenames = { "/videos/course.part1.avi", "/videos/course.part2.avi" };
+    const VideoInformation videoInformation(videoFilenames, 25.0f);
+
+    QCOMPARE(videoInformation.proxyVideoFilename(), QDir("/videos").absoluteFilePath("course.part1.proxy.mkv"));
+    QVERIFY(VideoInformation().proxyVideoFilename().isEmpty());
+}
+
+void VideoInformationTest::testHasProxy()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString videoFilename = QDir(directory.path()).absoluteFilePath("course.avi");
+    writeFile(videoFilename);
+    const VideoInformation videoInformation(videoFilename, 25.0f);
+
+    QVERIFY(!videoInformation.hasProxy());
+
+    writeFile(videoInformation.proxyVideoFilename());
+    QVERIFY(videoInformation.hasProxy());
+}
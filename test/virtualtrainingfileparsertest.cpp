@@ -3,6 +3,7 @@
 #include "importer/rlvfileparser.h"
 #include "importer/virtualtrainingfileparser.h"
 #include <QtCore/QFile>
+#include <QtCore/QTemporaryFile>
 #include <QtTest/QTest>
 
 namespace {
@@ -83,3 +84,30 @@ void VirtualTrainingFileParserTest::testCoordinates()
     const QGeoRectangle geoRectangle = rlv.geoRectangle();
     qDebug() << "geo rectangle" << geoRectangle.topLeft() << geoRectangle.bottomRight();
 }
+
+void VirtualTrainingFileParserTest::testVideoOfSeveralFiles()
+{
+    QTemporaryFile f;
+    QVERIFY(f.open());
+    f.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<virtualtraining>\n"
+            "  <name>Bavella and Dobel</name>\n"
+            "  <video-file-path>FR_Bavella.avi</video-file-path>\n"
+            "  <video-file-path>DE_Dobel.avi</video-file-path>\n"
+            "  <framerate>25</framerate>\n"
+            "</virtualtraining>\n");
+    f.close();
+
+    indoorcycling::VirtualTrainingFileParser parser(videoFiles);
+    RealLifeVideo rlv = parser.parseVirtualTrainingFile(f);
+    f.close();
+
+    QVERIFY(rlv.isValid());
+    QCOMPARE(rlv.videoFilename(), QString("/media/video/RLV/FR_Bavella.avi"));
+    QCOMPARE(rlv.videoFilenames(), QStringList({ "/media/video/RLV/FR_Bavella.avi",
+                                                 "/media/video/RLV/DE_Dobel.avi" }));
+
+    // without all of its video files, a video can not be played.
+    indoorcycling::VirtualTrainingFileParser parserWithoutDobel({ BAVELLA_VIDEO_FILE });
+    QVERIFY(!parserWithoutDobel.parseVirtualTrainingFile(f).isValid());
+}
@@ -11,6 +11,7 @@ public:
 private slots:
     void testWithBavellaFile();
     void testCoordinates();
+    void testVideoOfSeveralFiles();
 
 };
 
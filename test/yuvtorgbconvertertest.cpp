@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 Ilja Booij (ibooij@gmail.com)
+ *
+ * This file is part of Big Ring Indoor Video Cycling
+ *
+ * Big Ring Indoor Video Cycling is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * Big Ring Indoor Video Cycling  is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with Big Ring Indoor Video Cycling.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "yuvtorgbconvertertest.h"
+
+#include <vector>
+
+#include <QtTest/QTest>
+
+#include "video/yuvtorgbconverter.h"
+
+using indoorcycling::InstructionSet;
+
+namespace {
+/** Odd width, so the SIMD implementations also have to handle the last pixels of a line separately. */
+const int WIDTH = 101;
+const int HEIGHT = 6;
+const int Y_LINE_SIZE = 112;
+const int U_AND_V_LINE_SIZE = 56;
+
+quint32 convertPixel(quint8 y, quint8 u, quint8 v)
+{
+    const quint8 yPlane[2] = { y, y };
+    const quint8 * const planes[3] = { yPlane, &u, &v };
+    const int lineSizes[3] = { 2, 1, 1 };
+    quint32 rgb[2];
+    YuvToRgbConverter().convert(planes, lineSizes, 2, 1, reinterpret_cast<quint8*>(rgb), sizeof(rgb));
+    return rgb[0];
+}
+}
+
+YuvToRgbConverterTest::YuvToRgbConverterTest(QObject *parent) :
+    QObject(parent)
+{
+    // empty
+}
+
+void YuvToRgbConverterTest::testKnownColors()
+{
+    QCOMPARE(convertPixel(16, 128, 128), 0xff000000u);
+    QCOMPARE(convertPixel(235, 128, 128), 0xffffffffu);
+    QCOMPARE(convertPixel(81, 90, 240), 0xffff0000u);
+    QCOMPARE(convertPixel(145, 53, 34), 0xff00ff00u);
+    QCOMPARE(convertPixel(41, 240, 110), 0xff0000ffu);
+}
+
+void YuvToRgbConverterTest::testInstructionSetsGiveSameResult()
+{
+    std::vector<quint8> yuv(Y_LINE_SIZE * HEIGHT + 2 * U_AND_V_LINE_SIZE * HEIGHT / 2);
+    for (std::size_t i = 0; i < yuv.size(); ++i) {
+        yuv[i] = static_cast<quint8>(i * 37 % 256);
+    }
+    const quint8 * const planes[3] = {
+        yuv.data(), yuv.data() + Y_LINE_SIZE * HEIGHT,
+        yuv.data() + Y_LINE_SIZE * HEIGHT + U_AND_V_LINE_SIZE * HEIGHT / 2
+    };
+    const int lineSizes[3] = { Y_LINE_SIZE, U_AND_V_LINE_SIZE, U_AND_V_LINE_SIZE };
+    std::vector<quint32> expected(WIDTH * HEIGHT);
+    std::vector<quint32> actual(WIDTH * HEIGHT);
+
+    YuvToRgbConverter(InstructionSet::SCALAR).convert(planes, lineSizes, WIDTH, HEIGHT,
+                                                      reinterpret_cast<quint8*>(expected.data()), WIDTH * 4);
+    for (const InstructionSet instructionSet: { InstructionSet::SSE2, InstructionSet::AVX2 }) {
+        if (!indoorcycling::isSupported(instructionSet)) {
+            continue;
+        }
+        YuvToRgbConverter(instructionSet).convert(planes, lineSizes, WIDTH, HEIGHT,
+                                                  reinterpret_cast<quint8*>(actual.data()), WIDTH * 4);
+        QVERIFY2(actual == expected, qPrintable(indoorcycling::instructionSetName(instructionSet)));
+    }
+}
+
+void YuvToRgbConverterTest::testPixelFormatsGiveSameResult()
+{
+    const FrameFormat yuv420p(PixelFormat::YUV420P, QSize(Y_LINE_SIZE, HEIGHT));
+    std::vector<quint8> yuv(yuv420p.bufferSize());
+    for (std::size_t i = 0; i < yuv.size(); ++i) {
+        yuv[i] = static_cast<quint8>(i * 37 % 256);
+    }
+    const int uOffset = yuv420p.planeOffset(1);
+    const int vOffset = yuv420p.planeOffset(2);
+    const int chromaSize = vOffset - uOffset;
+
+    // the same picture in NV12, with the U and V planes interleaved.
+    const FrameFormat nv12(PixelFormat::NV12, QSize(Y_LINE_SIZE, HEIGHT));
+    std::vector<quint8> interleaved(yuv.begin(), yuv.begin() + uOffset);
+    for (int i = 0; i < chromaSize; ++i) {
+        interleaved.push_back(yuv[uOffset + i]);
+        interleaved.push_back(yuv[vOffset + i]);
+    }
+    QCOMPARE(static_cast<int>(interleaved.size()), nv12.bufferSize());
+
+    // and in 10 bits, little endian.
+    const FrameFormat yuv420p10(PixelFormat::YUV420P10, QSize(2 * Y_LINE_SIZE, HEIGHT));
+    std::vector<quint8> tenBits;
+    for (const quint8 sample: yuv) {
+        const int tenBitSample = sample << 2;
+        tenBits.push_back(static_cast<quint8>(tenBitSample & 0xff));
+        tenBits.push_back(static_cast<quint8>(tenBitSample >> 8));
+    }
+    QCOMPARE(static_cast<int>(tenBits.size()), yuv420p10.bufferSize());
+
+    const YuvToRgbConverter converter;
+    std::vector<quint32> expected(WIDTH * HEIGHT);
+    std::vector<quint32> actual(WIDTH * HEIGHT);
+    converter.convert(yuv420p, yuv.data(), WIDTH, HEIGHT, reinterpret_cast<quint8*>(expected.data()), WIDTH * 4);
+    converter.convert(nv12, interleaved.data(), WIDTH, HEIGHT, reinterpret_cast<quint8*>(actual.data()), WIDTH * 4);
+    QVERIFY(actual == expected);
+    converter.convert(yuv420p10, tenBits.data(), WIDTH, HEIGHT, reinterpret_cast<quint8*>(actual.data()), WIDTH * 4);
+    QVERIFY(actual == expected);
+}